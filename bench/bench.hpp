@@ -0,0 +1,150 @@
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simd.hpp"
+
+namespace bench {
+
+// Keep the compiler from removing a computation whose result is unused.
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Buffer sizes in samples, from L1 resident to well past the last level cache.
+inline const std::vector<std::size_t>& default_sizes() {
+    static const std::vector<std::size_t> sizes{1U << 10U, 1U << 14U, 1U << 18U, 1U << 22U};
+    return sizes;
+}
+
+struct result {
+    std::string name;
+    std::size_t size;
+    std::size_t iterations;
+    // per iteration
+    double seconds;
+    std::size_t items;
+    std::size_t bytes;
+};
+
+/**
+ * @brief Runs and reports benchmarks, Google Benchmark style.
+ *
+ * Each benchmark is repeated until a batch lasts min_time, the best of a few batches counts.
+ * Options: --json <path> writes the results for tracking across commits,
+ * --filter <text> runs only the names containing it, --min-time <seconds>.
+ */
+class suite {
+public:
+    suite(const int argc, char** argv) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            if (std::strcmp(argv[i], "--json") == 0) {
+                _json_path = argv[i + 1];
+            } else if (std::strcmp(argv[i], "--filter") == 0) {
+                _filter = argv[i + 1];
+            } else if (std::strcmp(argv[i], "--min-time") == 0) {
+                _min_time = std::stod(argv[i + 1]);
+            }
+        }
+        std::printf("%-48s %10s %12s %14s %12s\n", "benchmark", "size", "ns/iter", "M items/s", "GB/s");
+    }
+
+    suite(const suite&) = delete;
+    suite& operator=(const suite&) = delete;
+
+    ~suite() {
+        if (!_json_path.empty()) {
+            write_json();
+        }
+    }
+
+    /**
+     * @param name benchmark name, reported as name/size
+     * @param size buffer size in samples
+     * @param items items processed per call of f, usually samples
+     * @param bytes bytes read and written per call of f
+     */
+    template<typename F>
+    void run(const std::string& name, const std::size_t size, const std::size_t items, const std::size_t bytes, F&& f) {
+        if (!_filter.empty() && name.find(_filter) == std::string::npos) {
+            return;
+        }
+        std::size_t iterations = 1;
+        double elapsed = batch(f, iterations);
+        while (elapsed < _min_time && iterations < (std::size_t{1} << 30U)) {
+            const double factor = (elapsed > 0) ? std::min(10.0, 1.4 * _min_time / elapsed) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<std::size_t>(static_cast<double>(iterations) * factor));
+            elapsed = batch(f, iterations);
+        }
+        for (int32_t i = 0; i < 2; ++i) {
+            elapsed = std::min(elapsed, batch(f, iterations));
+        }
+        const result r{name, size, iterations, elapsed / static_cast<double>(iterations), items, bytes};
+        std::printf("%-48s %10zu %12.1f %14.3f %12.3f\n", r.name.c_str(), r.size, r.seconds * 1e9,
+                    static_cast<double>(r.items) / r.seconds * 1e-6, static_cast<double>(r.bytes) / r.seconds * 1e-9);
+        std::fflush(stdout);
+        _results.push_back(r);
+    }
+
+    const std::vector<result>& results() const noexcept {
+        return _results;
+    }
+
+private:
+    template<typename F>
+    static double batch(F& f, const std::size_t iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            f();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void write_json() const {
+        std::FILE* file = std::fopen(_json_path.c_str(), "w");
+        if (file == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", _json_path.c_str());
+            return;
+        }
+        char date[32]{};
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"date\": \"%s\",\n", date);
+        std::fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+        std::fprintf(file, "    \"simd_isa\": \"%s\",\n", comm::to_string(comm::active_simd_isa()));
+        std::fprintf(file, "    \"compiler\": \"%s\"\n  },\n", __VERSION__);
+        std::fprintf(file, "  \"benchmarks\": [\n");
+        for (std::size_t i = 0; i < _results.size(); ++i) {
+            const auto& r = _results[i];
+            std::fprintf(file, "    {\"name\": \"%s/%zu\", \"size\": %zu, \"iterations\": %zu, \"real_time_ns\": %.3f, "
+                               "\"items_per_second\": %.6e, \"bytes_per_second\": %.6e}%s\n",
+                         r.name.c_str(), r.size, r.size, r.iterations, r.seconds * 1e9,
+                         static_cast<double>(r.items) / r.seconds, static_cast<double>(r.bytes) / r.seconds,
+                         (i + 1 < _results.size()) ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        std::fclose(file);
+    }
+
+    std::string _json_path{};
+    std::string _filter{};
+    double _min_time{0.05};
+    std::vector<result> _results{};
+};
+
+}
+
+#endif // BENCH_BENCH_HPP
@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "convolutional.hpp"
+#include "llr.hpp"
+#include "psk.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+// K = 7 convolutional code; items are information bits, one core. Decoding runs with both metric widths.
+int main(int argc, char** argv) {
+    bench::suite suite{argc, argv};
+    constexpr std::size_t num_of_bits = 1U << 16U;
+    constexpr double snr_db = 3.0;
+    comm::random_stream stream{2022, 0};
+    const auto bits = comm::generate_uniformly_distributed_bits(num_of_bits, stream);
+    const comm::packed_bit_seq_t packed{bits};
+
+    for (const auto rate : {comm::code_rate::rate_1_2, comm::code_rate::rate_3_4}) {
+        const std::string name = std::string(" rate ") + comm::to_string(rate);
+        const std::size_t num_of_coded = comm::coded_length(num_of_bits, rate);
+        std::vector<uint64_t> coded(comm::packed_bit_seq_t::num_of_words(num_of_coded) + 1);
+        comm::convolutional_encoder encoder{rate};
+        suite.run("convolutional_encoder" + name, num_of_bits, num_of_bits, num_of_bits / 8 + num_of_coded / 8, [&]() {
+            encoder.reset();
+            bench::do_not_optimize(encoder.encode(packed.data(), num_of_bits, coded.data()));
+        });
+
+        // BPSK LLRs of the codeword, quantized as the coded pipeline does
+        const auto symbols = comm::add(comm::bpsk_modulation(comm::convolutional_encode(bits, rate)), comm::generate_awgn_noise(num_of_coded, snr_db, stream));
+        const auto soft = comm::quantize_llr<int8_t>(comm::bpsk_llr(symbols, comm::noise_variance_of(snr_db)), 4.0 * comm::noise_variance_of(snr_db));
+        comm::bit_seq_t decoded(soft.size() + comm::viterbi_decoder::default_traceback_depth);
+        const auto previous = comm::active_simd_isa();
+        for (const auto isa : {comm::simd_isa::scalar, comm::simd_isa::avx2, comm::simd_isa::avx512}) {
+            if (comm::set_simd_isa(isa) != isa) {
+                continue;
+            }
+            for (const auto metric : {comm::viterbi_metric::int8, comm::viterbi_metric::int16}) {
+                comm::viterbi_decoder decoder{rate, comm::viterbi_decoder::default_traceback_depth, metric};
+                const std::string width = (metric == comm::viterbi_metric::int8) ? " int8" : " int16";
+                suite.run("viterbi_decoder" + name + width + ", " + comm::to_string(isa), num_of_bits, num_of_bits, soft.size(), [&]() {
+                    const std::size_t n = decoder.decode(soft.data(), soft.size(), decoded.data());
+                    bench::do_not_optimize(n + decoder.finish(decoded.data() + n));
+                });
+            }
+        }
+        comm::set_simd_isa(previous);
+    }
+}
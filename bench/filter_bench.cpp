@@ -0,0 +1,39 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "psk.hpp"
+#include "pulse_shaping.hpp"
+#include "utilities.hpp"
+
+// Pulse shaping and matched filtering, polyphase against overlap-save; items are samples at the higher rate, one core.
+int main(int argc, char** argv) {
+    bench::suite suite{argc, argv};
+    constexpr std::size_t num_of_symbols = 1U << 14U;
+    constexpr double rolloff = 0.25;
+    comm::random_stream stream{2022, 0};
+    const auto symbols = comm::qpsk_modulation(comm::generate_uniformly_distributed_bits(2 * num_of_symbols, stream));
+
+    for (const std::size_t samples_per_symbol : {4, 8}) {
+        for (const std::size_t span : {8, 32}) {
+            const std::size_t num_of_samples = num_of_symbols * samples_per_symbol;
+            const std::size_t bytes = (num_of_symbols + num_of_samples) * sizeof(comm::complex_signal_t);
+            std::vector<comm::complex_signal_t> samples(num_of_samples);
+            std::vector<comm::complex_signal_t> received(num_of_symbols + 1);
+            for (const bool fft : {false, true}) {
+                const std::size_t threshold = fft ? 0 : span * samples_per_symbol + 1;
+                const std::string name = std::string(fft ? "overlap-save" : "polyphase") + " sps " + std::to_string(samples_per_symbol) + " span " + std::to_string(span);
+                comm::pulse_shaper shaper{rolloff, samples_per_symbol, span, threshold};
+                suite.run("RRC shaping, " + name, num_of_samples, num_of_samples, bytes, [&]() {
+                    shaper.process(symbols.data(), num_of_symbols, samples.data());
+                    bench::do_not_optimize(samples.data());
+                });
+                comm::matched_filter filter{rolloff, samples_per_symbol, span, threshold};
+                suite.run("RRC matched filter, " + name, num_of_samples, num_of_samples, bytes, [&]() {
+                    bench::do_not_optimize(filter.process(samples.data(), num_of_samples, received.data()));
+                });
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "packed_bits.hpp"
+#include "psk.hpp"
+#include "random.hpp"
+#include "split_signal.hpp"
+#include "utilities.hpp"
+
+// Building blocks of the simulations over buffer sizes from L1 resident to DRAM sized.
+int main(int argc, char** argv) {
+    bench::suite suite{argc, argv};
+    constexpr double snr_db = 5.0;
+    constexpr std::size_t symbol_bytes = sizeof(comm::complex_signal_t);
+    comm::random_stream stream{2022, 0};
+
+    for (const std::size_t n : bench::default_sizes()) {
+        comm::bit_seq_t bits(n);
+        comm::generate_uniformly_distributed_bits(std::begin(bits), std::end(bits), stream);
+        comm::bit_seq_t demodulated_bits(n);
+        comm::packed_bit_seq_t packed{bits};
+        comm::packed_bit_seq_t packed_demodulated{bits};
+        packed_demodulated.set(0, static_cast<comm::bit_t>(1 - bits[0]));
+        comm::complex_signal_seq_t symbols(n);
+        comm::complex_signal_seq_t noise(n);
+        comm::complex_signal_seq_t received(n);
+        comm::generate_awgn_noise(noise.data(), noise.data() + n, snr_db, stream);
+        comm::split_signal_t split_symbols(n);
+        comm::split_signal_t split_noise{noise};
+        comm::split_signal_t split_received(n);
+
+        suite.run("generate_uniformly_distributed_bits", n, n, n, [&]() {
+            comm::generate_uniformly_distributed_bits(std::begin(bits), std::end(bits), stream);
+            bench::do_not_optimize(bits.data());
+        });
+        suite.run("generate_uniformly_distributed_bits/packed", n, n, n / 8, [&]() {
+            comm::generate_uniformly_distributed_bits(packed, stream);
+            bench::do_not_optimize(packed.data());
+        });
+        suite.run("bpsk_modulation", n, n, n + n * symbol_bytes, [&]() {
+            comm::bpsk_modulation(std::cbegin(bits), std::cend(bits), std::begin(symbols));
+            bench::do_not_optimize(symbols.data());
+        });
+        suite.run("bpsk_modulation/packed", n, n, n / 8 + n * symbol_bytes, [&]() {
+            comm::bpsk_modulation(packed.data(), n, symbols.data());
+            bench::do_not_optimize(symbols.data());
+        });
+        suite.run("bpsk_modulation/packed/split", n, n, n / 8 + n * symbol_bytes, [&]() {
+            comm::bpsk_modulation(packed, split_symbols);
+            bench::do_not_optimize(split_symbols.real());
+        });
+        suite.run("bpsk_demodulation", n, n, n * symbol_bytes + n, [&]() {
+            comm::bpsk_demodulation(std::cbegin(noise), std::cend(noise), std::begin(demodulated_bits));
+            bench::do_not_optimize(demodulated_bits.data());
+        });
+        suite.run("bpsk_demodulation/split", n, n, n * symbol_bytes + n, [&]() {
+            comm::detail::bpsk_demodulation_split_kernel(split_noise.real(), split_noise.imag(), n, demodulated_bits.data(), 1.0, 0.0);
+            bench::do_not_optimize(demodulated_bits.data());
+        });
+        suite.run("bpsk_demodulation/packed", n, n, n * symbol_bytes + n / 8, [&]() {
+            comm::bpsk_demodulation(noise.data(), n, packed_demodulated.data());
+            bench::do_not_optimize(packed_demodulated.data());
+        });
+        suite.run("bpsk_demodulation/packed/split", n, n, n * symbol_bytes + n / 8, [&]() {
+            comm::bpsk_demodulation(split_noise, packed_demodulated);
+            bench::do_not_optimize(packed_demodulated.data());
+        });
+        // items are bits, n / 2 symbols
+        suite.run("qpsk_modulation", n, n, n + n / 2 * symbol_bytes, [&]() {
+            comm::qpsk_modulation(std::cbegin(bits), std::cend(bits), std::begin(symbols));
+            bench::do_not_optimize(symbols.data());
+        });
+        suite.run("qpsk_demodulation", n, n, n / 2 * symbol_bytes + n, [&]() {
+            comm::qpsk_demodulation(std::cbegin(noise), std::cbegin(noise) + static_cast<std::ptrdiff_t>(n / 2),
+                                    std::begin(demodulated_bits), std::end(demodulated_bits));
+            bench::do_not_optimize(demodulated_bits.data());
+        });
+        suite.run("qpsk_demodulation/packed", n, n, n / 2 * symbol_bytes + n / 8, [&]() {
+            comm::qpsk_demodulation(noise.data(), n / 2, packed_demodulated.data());
+            bench::do_not_optimize(packed_demodulated.data());
+        });
+        suite.run("qpsk_demodulation/packed/split", n, n, n / 2 * symbol_bytes + n / 8, [&]() {
+            comm::detail::qpsk_demodulation_words_split_kernel(split_noise.real(), split_noise.imag(), n / 2, packed_demodulated.data());
+            bench::do_not_optimize(packed_demodulated.data());
+        });
+        suite.run("generate_awgn_noise", n, n, n * symbol_bytes, [&]() {
+            comm::generate_awgn_noise(noise.data(), noise.data() + n, snr_db, stream);
+            bench::do_not_optimize(noise.data());
+        });
+        suite.run("generate_awgn_noise/split", n, n, n * symbol_bytes, [&]() {
+            comm::generate_awgn_noise(split_noise, snr_db, stream);
+            bench::do_not_optimize(split_noise.real());
+        });
+        suite.run("add", n, n, 3 * n * symbol_bytes, [&]() {
+            comm::add(std::cbegin(symbols), std::cend(symbols), std::cbegin(noise), std::begin(received));
+            bench::do_not_optimize(received.data());
+        });
+        suite.run("add_in_place", n, n, 3 * n * symbol_bytes, [&]() {
+            comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(received));
+            bench::do_not_optimize(received.data());
+        });
+        suite.run("add_in_place/split", n, n, 3 * n * symbol_bytes, [&]() {
+            comm::add_in_place(split_noise, split_received);
+            bench::do_not_optimize(split_received.real());
+        });
+        suite.run("count_error", n, n, 2 * n, [&]() {
+            bench::do_not_optimize(comm::count_error(bits, demodulated_bits));
+        });
+        suite.run("count_error/packed", n, n, 2 * n / 8, [&]() {
+            bench::do_not_optimize(comm::count_error(packed, packed_demodulated));
+        });
+    }
+}
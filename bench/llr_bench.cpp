@@ -0,0 +1,73 @@
+#include <vector>
+
+#include "bench.hpp"
+#include "constellation.hpp"
+#include "llr.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+// Soft against hard demodulation, the max-log LLRs should stay close to the hard decisions.
+int main(int argc, char** argv) {
+    bench::suite suite{argc, argv};
+    constexpr std::size_t num_of_symbols = 1U << 16U;
+    constexpr double snr_db = 10.0;
+    // bytes are the received symbols read
+    constexpr std::size_t symbol_bytes = num_of_symbols * sizeof(comm::complex_signal_t);
+    const double noise_variance = comm::noise_variance_of(snr_db);
+    comm::random_stream stream{2022, 0};
+    const auto noise = comm::generate_awgn_noise(num_of_symbols, snr_db, stream);
+
+    {
+        const auto bits = comm::generate_uniformly_distributed_bits(2 * num_of_symbols, stream);
+        const auto symbols = comm::add(comm::qpsk_modulation(bits), noise);
+        comm::bit_seq_t hard(bits.size());
+        std::vector<double> llrs(bits.size());
+        suite.run("QPSK hard decision", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+            comm::qpsk_demodulation(symbols.data(), symbols.data() + symbols.size(), hard.data(), hard.data() + hard.size());
+            bench::do_not_optimize(hard.data());
+        });
+        suite.run("QPSK LLR", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+            comm::qpsk_llr(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data());
+            bench::do_not_optimize(llrs.data());
+        });
+    }
+
+    using qam16 = comm::qam_constellation<16>;
+    const auto bits = comm::generate_uniformly_distributed_bits(qam16::bits_per_symbol * num_of_symbols, stream);
+    const auto symbols = comm::add(comm::modulate<qam16>(bits), noise);
+    comm::bit_seq_t hard(bits.size());
+    std::vector<double> llrs(bits.size());
+    std::vector<int8_t> quantized(bits.size());
+    suite.run("16-QAM hard decision", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::demodulate<qam16>(symbols.data(), symbols.data() + symbols.size(), hard.data());
+        bench::do_not_optimize(hard.data());
+    });
+    suite.run("16-QAM LLR max-log", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::llr_demodulation<qam16>(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data(), comm::llr_mode::max_log);
+        bench::do_not_optimize(llrs.data());
+    });
+    suite.run("16-QAM LLR exact", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::llr_demodulation<qam16>(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data(), comm::llr_mode::exact);
+        bench::do_not_optimize(llrs.data());
+    });
+    suite.run("16-QAM LLR max-log + int8", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::llr_demodulation<qam16>(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data(), comm::llr_mode::max_log);
+        comm::quantize_llr(llrs.data(), llrs.data() + llrs.size(), 4.0, quantized.data());
+        bench::do_not_optimize(quantized.data());
+    });
+
+    using psk8 = comm::psk_constellation<8>;
+    const auto psk_symbols = comm::add(comm::modulate<psk8>(comm::bit_seq_t(bits.begin(), bits.begin() + 3 * num_of_symbols)), noise);
+    suite.run("8-PSK hard decision", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::demodulate<psk8>(psk_symbols.data(), psk_symbols.data() + psk_symbols.size(), hard.data());
+        bench::do_not_optimize(hard.data());
+    });
+    suite.run("8-PSK LLR max-log", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::llr_demodulation<psk8>(psk_symbols.data(), psk_symbols.data() + psk_symbols.size(), noise_variance, llrs.data(), comm::llr_mode::max_log);
+        bench::do_not_optimize(llrs.data());
+    });
+    suite.run("8-PSK LLR exact", num_of_symbols, num_of_symbols, symbol_bytes, [&]() {
+        comm::llr_demodulation<psk8>(psk_symbols.data(), psk_symbols.data() + psk_symbols.size(), noise_variance, llrs.data(), comm::llr_mode::exact);
+        bench::do_not_optimize(llrs.data());
+    });
+}
@@ -0,0 +1,49 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "normal.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+// AWGN generation: the former per-sample std::normal_distribution path against the block kernels.
+int main(int argc, char** argv) {
+    bench::suite suite{argc, argv};
+    constexpr std::size_t num_of_samples = 1U << 20U;
+    constexpr std::size_t bytes = num_of_samples * sizeof(comm::complex_signal_t);
+    constexpr double snr_db = 5.0;
+    comm::complex_signal_seq_t noise(num_of_samples);
+
+    std::mt19937 generator(2022);
+    std::normal_distribution<double> distribution(0, 1);
+    const double multiplier = std::pow(10, -snr_db / 20.0) / std::sqrt(2);
+    suite.run("mt19937 + std::normal_distribution", num_of_samples, num_of_samples, bytes, [&]() {
+        std::generate(std::begin(noise), std::end(noise), [&]() {
+            const double real = distribution(generator);
+            return multiplier * comm::complex_signal_t(real, distribution(generator));
+        });
+        bench::do_not_optimize(noise.data());
+    });
+
+    comm::random_stream stream{2022, 0};
+    suite.run("random_stream + std::normal_distribution", num_of_samples, num_of_samples, bytes, [&]() {
+        std::generate(std::begin(noise), std::end(noise), [&]() {
+            const double real = distribution(stream);
+            return multiplier * comm::complex_signal_t(real, distribution(stream));
+        });
+        bench::do_not_optimize(noise.data());
+    });
+
+    const auto previous = comm::active_simd_isa();
+    for (const auto isa : {comm::simd_isa::scalar, comm::simd_isa::avx2, comm::simd_isa::avx512}) {
+        if (comm::set_simd_isa(isa) != isa) {
+            continue;
+        }
+        suite.run(std::string("generate_awgn_noise block, ") + comm::to_string(isa), num_of_samples, num_of_samples, bytes, [&]() {
+            comm::generate_awgn_noise(noise.data(), noise.data() + noise.size(), snr_db, stream);
+            bench::do_not_optimize(noise.data());
+        });
+    }
+    comm::set_simd_isa(previous);
+}
@@ -0,0 +1,327 @@
+#ifndef INCLUDE_BER_HPP
+#define INCLUDE_BER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "random.hpp"
+#include "statistics.hpp"
+#include "thread_pool.hpp"
+
+namespace comm {
+
+struct ber_point {
+    double snr_db{};
+    std::size_t num_of_bits{0};
+    std::size_t num_of_errors{0};
+
+    double ber() const {
+        return num_of_bits == 0 ? 0.0 : static_cast<double>(num_of_errors) / static_cast<double>(num_of_bits);
+    }
+
+    confidence_interval wilson(const double confidence = 0.95) const {
+        return wilson_interval(num_of_errors, num_of_bits, confidence);
+    }
+
+    confidence_interval clopper_pearson(const double confidence = 0.95) const {
+        return clopper_pearson_interval(num_of_errors, num_of_bits, confidence);
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ber_point& point) {
+    const auto wilson = point.wilson();
+    const auto clopper_pearson = point.clopper_pearson();
+    std::array<char, 192> buf{};
+    (void) std::snprintf(buf.data(), buf.size(), "%6.2f dB  BER %.4e  Wilson [%.4e, %.4e]  Clopper-Pearson [%.4e, %.4e]  %zu/%zu",
+                         point.snr_db, point.ber(), wilson.lower, wilson.upper, clopper_pearson.lower, clopper_pearson.upper,
+                         point.num_of_errors, point.num_of_bits);
+    os << buf.data();
+    return os;
+}
+
+struct ber_config {
+    std::size_t num_of_bits{1'000'000}; // per SNR point
+    std::size_t bits_per_trial{1U << 16U}; // keep it a multiple of the bits per symbol
+    std::uint64_t seed{0};
+};
+
+struct adaptive_ber_config {
+    std::size_t target_errors{100}; // a point stops once it has seen this many errors,
+    double target_relative_width{0}; // or once its Clopper-Pearson interval is this narrow relative to the BER (0: off),
+    double confidence{0.95};
+    std::size_t max_bits{1'000'000'000}; // or once it has used this many bits
+    std::size_t bits_per_trial{1U << 16U}; // keep it a multiple of the bits per symbol
+    std::size_t max_trials_per_round{1024};
+    std::uint64_t seed{0};
+};
+
+// Every trial owns one stream, so trials never share random state.
+using ber_generator_t = random_stream;
+
+namespace detail {
+    inline
+    ber_generator_t make_trial_generator(const std::uint64_t seed, const std::size_t point, const std::size_t trial) {
+        return ber_generator_t(seed, (static_cast<uint64_t>(point) << 32U) | static_cast<uint64_t>(trial));
+    }
+
+    // Adds a sweep trial's errors at every SNR to errors, whether the trial writes them there or returns them
+    template<typename SweepTrial>
+    void run_sweep_trial(SweepTrial& trial, const std::vector<double>& snr_list, const std::size_t num_of_bits, ber_generator_t& generator,
+                         std::size_t* errors) {
+        if constexpr (std::is_invocable_v<SweepTrial&, const std::vector<double>&, std::size_t, ber_generator_t&, std::size_t*>) {
+            trial(snr_list, num_of_bits, generator, errors);
+        } else {
+            const auto trial_errors = trial(snr_list, num_of_bits, generator);
+            std::transform(std::cbegin(trial_errors), std::cend(trial_errors), errors, errors, std::plus<>{});
+        }
+    }
+
+    // The stopping rule of the adaptive simulations
+    inline
+    bool is_done(const adaptive_ber_config& config, const ber_point& point) {
+        if (point.num_of_bits >= config.max_bits || point.num_of_errors >= config.target_errors) {
+            return true;
+        }
+        return config.target_relative_width > 0 && point.num_of_errors > 0 &&
+               point.clopper_pearson(config.confidence).width() <= config.target_relative_width * point.ber();
+    }
+
+    /*
+        The rounds of the adaptive simulations. Each round runs trials on every point that
+        is_done(point) leaves running, twice as many as the point has run so far and at most
+        config.max_trials_per_round; trial t of point p draws from the stream of (seed, p, t).
+        add(point, num_of_bits, outcome) folds the Outcome of each trial into its point, in
+        trial order once the round is over, so the points never depend on the pool.
+    */
+    template<typename Outcome, typename Trial, typename IsDone, typename Add>
+    void run_adaptive_rounds(thread_pool& pool, const std::vector<double>& snr_list, const adaptive_ber_config& config,
+                             Trial& trial, IsDone is_done, Add add) {
+        const std::size_t bits_per_trial = std::max<std::size_t>(config.bits_per_trial, 1);
+        const std::size_t max_trials = (config.max_bits + bits_per_trial - 1) / bits_per_trial;
+
+        std::vector<std::size_t> num_of_trials(snr_list.size(), 0);
+        std::vector<std::pair<std::size_t, std::size_t>> tasks{}; // (point, trial)
+        std::vector<std::pair<std::size_t, Outcome>> outcomes{}; // (bits, outcome)
+        for (;;) {
+            tasks.clear();
+            for (std::size_t point = 0; point < snr_list.size(); ++point) {
+                if (is_done(point)) {
+                    continue;
+                }
+                const std::size_t first = num_of_trials[point];
+                const std::size_t count = std::min({std::max<std::size_t>(first, 1), std::max<std::size_t>(config.max_trials_per_round, 1), max_trials - first});
+                for (std::size_t trial_index = first; trial_index < first + count; ++trial_index) {
+                    tasks.emplace_back(point, trial_index);
+                }
+                num_of_trials[point] += count;
+            }
+            if (tasks.empty()) {
+                break;
+            }
+
+            outcomes.assign(tasks.size(), {});
+            pool.parallel_for(tasks.size(), [&](const std::size_t index) {
+                const auto [point, trial_index] = tasks[index];
+                const std::size_t num_of_bits = std::min(bits_per_trial, config.max_bits - trial_index * bits_per_trial);
+                auto generator = make_trial_generator(config.seed, point, trial_index);
+                outcomes[index] = {num_of_bits, trial(snr_list[point], num_of_bits, generator)};
+            });
+            for (std::size_t index = 0; index < tasks.size(); ++index) {
+                add(tasks[index].first, outcomes[index].first, outcomes[index].second);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Monte Carlo BER of every SNR point on a thread pool.
+ *
+ * Each point is split into trials of config.bits_per_trial bits. Trial t of point p
+ * draws from its own random stream derived from (seed, p, t), so the error counts depend
+ * only on the seed, never on the number of threads or the order trials run in.
+ *
+ * @tparam Trial callable as std::size_t(double snr_db, std::size_t num_of_bits, ber_generator_t& generator),
+ *         returning the number of bit errors of one trial
+ */
+template<typename Trial>
+std::vector<ber_point> simulate_ber(thread_pool& pool, const std::vector<double>& snr_list, const ber_config& config, Trial trial) {
+    const std::size_t bits_per_trial = std::max<std::size_t>(config.bits_per_trial, 1);
+    const std::size_t trials_per_point = (config.num_of_bits + bits_per_trial - 1) / bits_per_trial;
+    std::vector<std::size_t> errors(snr_list.size() * trials_per_point, 0);
+
+    pool.parallel_for(errors.size(), [&](const std::size_t index) {
+        const std::size_t point = index / trials_per_point;
+        const std::size_t trial_index = index % trials_per_point;
+        const std::size_t first_bit = trial_index * bits_per_trial;
+        const std::size_t num_of_bits = std::min(bits_per_trial, config.num_of_bits - first_bit);
+        auto generator = detail::make_trial_generator(config.seed, point, trial_index);
+        errors[index] = trial(snr_list[point], num_of_bits, generator);
+    });
+
+    std::vector<ber_point> result(snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        const auto first = std::next(std::cbegin(errors), static_cast<std::ptrdiff_t>(point * trials_per_point));
+        result[point].snr_db = snr_list[point];
+        result[point].num_of_bits = config.num_of_bits;
+        result[point].num_of_errors = std::accumulate(first, std::next(first, static_cast<std::ptrdiff_t>(trials_per_point)), std::size_t{0});
+    }
+    return result;
+}
+
+template<typename Trial>
+std::vector<ber_point> simulate_ber(const std::vector<double>& snr_list, const ber_config& config, Trial trial) {
+    thread_pool pool{};
+    return simulate_ber(pool, snr_list, config, trial);
+}
+
+/**
+ * @brief Monte Carlo BER of every SNR point on common random numbers.
+ *
+ * Trial t draws the bits and the noise once from the stream of trial t of point 0 and
+ * evaluates every point on them, e.g. with the sweep version of ber_pipeline::run, so a
+ * sweep pays the random numbers of one point and its curve is smooth: the points differ
+ * by the SNR alone, not by the noise they happened to draw.
+ *
+ * @tparam SweepTrial callable as void(const std::vector<double>& snr_list, std::size_t num_of_bits, ber_generator_t& generator,
+ *         std::size_t* errors), adding the number of bit errors at every SNR of one trial to errors, which allocates
+ *         nothing per trial; or as std::vector<std::size_t>(snr_list, num_of_bits, generator), returning them
+ */
+template<typename SweepTrial>
+std::vector<ber_point> simulate_ber_sweep(thread_pool& pool, const std::vector<double>& snr_list, const ber_config& config, SweepTrial trial) {
+    const std::size_t bits_per_trial = std::max<std::size_t>(config.bits_per_trial, 1);
+    const std::size_t num_of_trials = (config.num_of_bits + bits_per_trial - 1) / bits_per_trial;
+    // the errors of trial t at point p in errors[t * snr_list.size() + p]
+    std::vector<std::size_t> errors(num_of_trials * snr_list.size(), 0);
+
+    pool.parallel_for(num_of_trials, [&](const std::size_t trial_index) {
+        const std::size_t num_of_bits = std::min(bits_per_trial, config.num_of_bits - trial_index * bits_per_trial);
+        auto generator = detail::make_trial_generator(config.seed, 0, trial_index);
+        detail::run_sweep_trial(trial, snr_list, num_of_bits, generator, errors.data() + trial_index * snr_list.size());
+    });
+
+    std::vector<ber_point> result(snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        result[point].snr_db = snr_list[point];
+        result[point].num_of_bits = config.num_of_bits;
+        for (std::size_t trial_index = 0; trial_index < num_of_trials; ++trial_index) {
+            result[point].num_of_errors += errors[trial_index * snr_list.size() + point];
+        }
+    }
+    return result;
+}
+
+template<typename SweepTrial>
+std::vector<ber_point> simulate_ber_sweep(const std::vector<double>& snr_list, const ber_config& config, SweepTrial trial) {
+    thread_pool pool{};
+    return simulate_ber_sweep(pool, snr_list, config, trial);
+}
+
+/**
+ * @brief Monte Carlo BER that spends the bits where they are needed.
+ *
+ * Runs rounds of trials on every SNR point that has not met its stopping rule yet:
+ * config.target_errors errors, a narrow enough confidence interval, or config.max_bits
+ * bits. A point doubles its trials each round, up to config.max_trials_per_round.
+ * Trial t of point p uses the same stream as in simulate_ber and the rounds do not
+ * depend on the pool, so the result is reproducible from the seed as well.
+ *
+ * @tparam Trial same as for simulate_ber
+ */
+template<typename Trial>
+std::vector<ber_point> simulate_ber_adaptive(thread_pool& pool, const std::vector<double>& snr_list, const adaptive_ber_config& config, Trial trial) {
+    std::vector<ber_point> result(snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        result[point].snr_db = snr_list[point];
+    }
+    detail::run_adaptive_rounds<std::size_t>(pool, snr_list, config, trial, [&](const std::size_t point) {
+        return detail::is_done(config, result[point]);
+    }, [&](const std::size_t point, const std::size_t num_of_bits, const std::size_t errors) {
+        result[point].num_of_bits += num_of_bits;
+        result[point].num_of_errors += errors;
+    });
+    return result;
+}
+
+template<typename Trial>
+std::vector<ber_point> simulate_ber_adaptive(const std::vector<double>& snr_list, const adaptive_ber_config& config, Trial trial) {
+    thread_pool pool{};
+    return simulate_ber_adaptive(pool, snr_list, config, trial);
+}
+
+/**
+ * @brief simulate_ber_adaptive on common random numbers.
+ *
+ * Rounds of trials run on the points that have not met their stopping rule yet, trial t
+ * of every point on the stream of trial t of point 0 as in simulate_ber_sweep. A point
+ * that stops keeps the bits of the trials it ran, so every point has seen a prefix of
+ * the same random numbers and the low SNR points drop out of the sweep early.
+ *
+ * @tparam SweepTrial same as for simulate_ber_sweep, called with the points still running
+ */
+template<typename SweepTrial>
+std::vector<ber_point> simulate_ber_adaptive_sweep(thread_pool& pool, const std::vector<double>& snr_list, const adaptive_ber_config& config, SweepTrial trial) {
+    const std::size_t bits_per_trial = std::max<std::size_t>(config.bits_per_trial, 1);
+    const std::size_t max_trials = (config.max_bits + bits_per_trial - 1) / bits_per_trial;
+
+    std::vector<ber_point> result(snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        result[point].snr_db = snr_list[point];
+    }
+
+    std::size_t num_of_trials{0};
+    std::vector<std::size_t> active{};
+    std::vector<double> active_snr_list{};
+    // the errors of the trial index of a round at active point i in outcomes[index * active.size() + i]
+    std::vector<std::size_t> outcomes{};
+    for (;;) {
+        active.clear();
+        active_snr_list.clear();
+        for (std::size_t point = 0; point < snr_list.size(); ++point) {
+            if (!detail::is_done(config, result[point])) {
+                active.push_back(point);
+                active_snr_list.push_back(snr_list[point]);
+            }
+        }
+        if (active.empty() || num_of_trials >= max_trials) {
+            break;
+        }
+
+        const std::size_t first = num_of_trials;
+        const std::size_t count = std::min({std::max<std::size_t>(first, 1), std::max<std::size_t>(config.max_trials_per_round, 1), max_trials - first});
+        outcomes.assign(count * active.size(), 0);
+        pool.parallel_for(count, [&](const std::size_t index) {
+            const std::size_t trial_index = first + index;
+            const std::size_t num_of_bits = std::min(bits_per_trial, config.max_bits - trial_index * bits_per_trial);
+            auto generator = detail::make_trial_generator(config.seed, 0, trial_index);
+            detail::run_sweep_trial(trial, active_snr_list, num_of_bits, generator, outcomes.data() + index * active.size());
+        });
+        for (std::size_t index = 0; index < count; ++index) {
+            const std::size_t num_of_bits = std::min(bits_per_trial, config.max_bits - (first + index) * bits_per_trial);
+            for (std::size_t i = 0; i < active.size(); ++i) {
+                result[active[i]].num_of_bits += num_of_bits;
+                result[active[i]].num_of_errors += outcomes[index * active.size() + i];
+            }
+        }
+        num_of_trials += count;
+    }
+    return result;
+}
+
+template<typename SweepTrial>
+std::vector<ber_point> simulate_ber_adaptive_sweep(const std::vector<double>& snr_list, const adaptive_ber_config& config, SweepTrial trial) {
+    thread_pool pool{};
+    return simulate_ber_adaptive_sweep(pool, snr_list, config, trial);
+}
+
+}
+
+#endif // INCLUDE_BER_HPP
@@ -0,0 +1,413 @@
+#ifndef INCLUDE_CHANNEL_HPP
+#define INCLUDE_CHANNEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+#include "fir.hpp"
+#include "normal.hpp"
+#include "random.hpp"
+#include "utilities.hpp"
+
+namespace comm {
+
+/*
+    A channel stage transforms a chunk of samples in place,
+
+        void process(complex_signal_t* samples, std::size_t n, random_stream& generator);
+
+    and keeps what it needs between chunks (fading time, filter history, phase), so a long
+    signal goes through in pieces with the same result as in one call. reset() starts a new
+    realization, drawn from the generator on the next process(). A stage belongs to one
+    thread: give every trial its own, e.g. by building the channel inside the trial.
+*/
+
+namespace detail {
+    constexpr double two_pi = 6.28318530717958647693;
+
+    // Plain complex product; std::complex's operator* pays for the C99 Annex G NaN recovery.
+    inline complex_signal_t multiply(const complex_signal_t& a, const complex_signal_t& b) {
+        return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+    }
+
+    inline double uniform_phase(random_stream& generator) {
+        return two_pi * to_unit_interval(generator());
+    }
+}
+
+/**
+ * @brief Additive white Gaussian noise, the same samples as generate_awgn_noise followed by add.
+ */
+class awgn_stage {
+public:
+    explicit awgn_stage(const double snr_db) : _snr_db(snr_db) {
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream& generator) {
+        std::array<complex_signal_t, 512> noise{};
+        for (std::size_t done = 0; done < n; done += noise.size()) {
+            const std::size_t m = std::min(noise.size(), n - done);
+            generate_awgn_noise(noise.data(), noise.data() + m, _snr_db, generator);
+            for (std::size_t i = 0; i < m; ++i) {
+                samples[done + i] += noise[i];
+            }
+        }
+    }
+
+    void reset() {
+    }
+
+private:
+    double _snr_db;
+};
+
+/**
+ * @brief Block fading: one complex gain per coherence_length samples, independent across blocks.
+ *
+ * The gain is sqrt(K / (K + 1)) + sqrt(1 / (K + 1)) * CN(0, 1), Rayleigh for K = 0 and
+ * Rician otherwise, so its mean power is one.
+ */
+class block_fading_stage {
+public:
+    explicit block_fading_stage(const std::size_t coherence_length, const double rician_k = 0.0)
+        : _coherence_length(coherence_length),
+          _line_of_sight(std::sqrt(rician_k / (rician_k + 1))),
+          _scattered(std::sqrt(1 / (rician_k + 1))) {
+        if (coherence_length == 0 || rician_k < 0) {
+            throw std::invalid_argument("block fading needs a positive coherence length and a non-negative K factor");
+        }
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream& generator) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (_position == 0) {
+                complex_signal_t scattered{};
+                generate_normal(generator, &scattered, &scattered + 1, std::sqrt(0.5));
+                _gain = _line_of_sight + _scattered * scattered;
+            }
+            samples[i] = detail::multiply(samples[i], _gain);
+            _position = (_position + 1) % _coherence_length;
+        }
+    }
+
+    void reset() {
+        _position = 0;
+    }
+
+    // Gain of the last sample processed, for receivers with perfect channel knowledge
+    complex_signal_t gain() const noexcept {
+        return _gain;
+    }
+
+private:
+    std::size_t _coherence_length;
+    double _line_of_sight;
+    double _scattered;
+    std::size_t _position{0};
+    complex_signal_t _gain{};
+};
+
+/**
+ * @brief Time-varying flat fading from a sum of sinusoids with the Jakes Doppler spectrum.
+ *
+ * h(t) = sqrt(K / (K + 1)) e^{j(w_d t cos(a_0) + p_0)} + sqrt(1 / (K + 1) / M) sum_m e^{j(w_d t cos(a_m) + p_m)}
+ * with M arrival angles a_m = (2 pi m + u) / M evenly spread around a random offset u, random
+ * phases p_m and w_d = 2 pi normalized_doppler (the maximum Doppler shift times the sample
+ * period). The autocorrelation is close to J0(w_d tau) and the mean power is one; K = 0 is
+ * Rayleigh fading, K > 0 Rician with its line of sight arriving at los_angle.
+ *
+ * The sinusoids advance by one complex multiplication per sample and are recomputed from
+ * the absolute sample index every block of samples, so the rounding never accumulates.
+ */
+class sos_fading_stage {
+public:
+    static constexpr std::size_t default_num_of_sinusoids = 16;
+
+    explicit sos_fading_stage(const double normalized_doppler, const double rician_k = 0.0,
+                              const std::size_t num_of_sinusoids = default_num_of_sinusoids, const double los_angle = 0.0)
+        : _omega(detail::two_pi * normalized_doppler),
+          _los_angle(los_angle),
+          _line_of_sight(std::sqrt(rician_k / (rician_k + 1))),
+          _scattered(std::sqrt(1 / (rician_k + 1) / static_cast<double>(num_of_sinusoids))),
+          _frequencies(num_of_sinusoids),
+          _phases(num_of_sinusoids),
+          _phasors(num_of_sinusoids),
+          _steps(num_of_sinusoids) {
+        if (num_of_sinusoids == 0 || rician_k < 0) {
+            throw std::invalid_argument("fading needs at least one sinusoid and a non-negative K factor");
+        }
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream& generator) {
+        if (!_drawn) {
+            _draw(generator);
+        }
+        constexpr std::size_t block = 1024;
+        for (std::size_t done = 0; done < n; done += block) {
+            const std::size_t m = std::min(block, n - done);
+            _start_block();
+            for (std::size_t i = 0; i < m; ++i) {
+                complex_signal_t scattered{};
+                for (std::size_t k = 0; k < _phasors.size(); ++k) {
+                    scattered += _phasors[k];
+                    _phasors[k] = detail::multiply(_phasors[k], _steps[k]);
+                }
+                _gain = _line_of_sight * _los_phasor + _scattered * scattered;
+                _los_phasor = detail::multiply(_los_phasor, _los_step);
+                samples[done + i] = detail::multiply(samples[done + i], _gain);
+            }
+            _time += m;
+        }
+    }
+
+    void reset() {
+        _drawn = false;
+        _time = 0;
+    }
+
+    // Gain of the last sample processed, for receivers with perfect channel knowledge
+    complex_signal_t gain() const noexcept {
+        return _gain;
+    }
+
+private:
+    void _draw(random_stream& generator) {
+        const double offset = detail::uniform_phase(generator);
+        const auto num_of_sinusoids = static_cast<double>(_frequencies.size());
+        for (std::size_t k = 0; k < _frequencies.size(); ++k) {
+            _frequencies[k] = _omega * std::cos((detail::two_pi * static_cast<double>(k) + offset) / num_of_sinusoids);
+            _phases[k] = detail::uniform_phase(generator);
+        }
+        _los_phase = detail::uniform_phase(generator);
+        _drawn = true;
+    }
+
+    void _start_block() {
+        const auto t = static_cast<double>(_time);
+        for (std::size_t k = 0; k < _phasors.size(); ++k) {
+            _phasors[k] = std::polar(1.0, std::remainder(_frequencies[k] * t + _phases[k], detail::two_pi));
+            _steps[k] = std::polar(1.0, _frequencies[k]);
+        }
+        const double los_frequency = _omega * std::cos(_los_angle);
+        _los_phasor = std::polar(1.0, std::remainder(los_frequency * t + _los_phase, detail::two_pi));
+        _los_step = std::polar(1.0, los_frequency);
+    }
+
+    double _omega;
+    double _los_angle;
+    double _line_of_sight;
+    double _scattered;
+    std::vector<double> _frequencies;
+    std::vector<double> _phases;
+    std::vector<complex_signal_t> _phasors;
+    std::vector<complex_signal_t> _steps;
+    double _los_phase{0.0};
+    complex_signal_t _los_phasor{};
+    complex_signal_t _los_step{};
+    complex_signal_t _gain{};
+    uint64_t _time{0};
+    bool _drawn{false};
+};
+
+/**
+ * @brief Tapped delay line, y[i] = sum_k taps[k] x[i - k], with the history carried across chunks.
+ *
+ * Up to fft_threshold taps the sum is computed directly. Longer channels go through an
+ * overlap_save_filter: FFTs of 4 * taps rounded up to a power of two from the shared plan
+ * cache, each giving fft_size - taps + 1 outputs, so the cost per sample grows with
+ * log(taps) instead of taps.
+ */
+class multipath_stage {
+public:
+    static constexpr std::size_t default_fft_threshold = 32;
+
+    explicit multipath_stage(std::vector<complex_signal_t> taps, const std::size_t fft_threshold = default_fft_threshold)
+        : _taps(std::move(taps)) {
+        if (_taps.empty()) {
+            throw std::invalid_argument("multipath needs at least one tap");
+        }
+        _history.assign(_taps.size() - 1, complex_signal_t{});
+        if (_taps.size() > fft_threshold) {
+            _overlap_save.emplace(_taps);
+        }
+    }
+
+    const std::vector<complex_signal_t>& taps() const noexcept {
+        return _taps;
+    }
+
+    // Zero with the direct form
+    std::size_t fft_size() const noexcept {
+        return _overlap_save ? _overlap_save->fft_size() : 0;
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream&) {
+        if (_overlap_save) {
+            _overlap_save->process(samples, n);
+        } else {
+            _process_direct(samples, n);
+        }
+    }
+
+    void reset() {
+        std::fill(std::begin(_history), std::end(_history), complex_signal_t{});
+        if (_overlap_save) {
+            _overlap_save->reset();
+        }
+    }
+
+private:
+    void _process_direct(complex_signal_t* samples, const std::size_t n) {
+        const std::size_t memory = _history.size();
+        _line.resize(memory + n);
+        std::copy(std::cbegin(_history), std::cend(_history), std::begin(_line));
+        std::copy(samples, samples + n, std::begin(_line) + static_cast<std::ptrdiff_t>(memory));
+        for (std::size_t i = 0; i < n; ++i) {
+            const complex_signal_t* newest = _line.data() + memory + i;
+            complex_signal_t sum{};
+            for (std::size_t k = 0; k < _taps.size(); ++k) {
+                sum += detail::multiply(_taps[k], *(newest - k));
+            }
+            samples[i] = sum;
+        }
+        std::copy(std::cend(_line) - static_cast<std::ptrdiff_t>(memory), std::cend(_line), std::begin(_history));
+    }
+
+    std::vector<complex_signal_t> _taps;
+    std::vector<complex_signal_t> _history{};
+    std::vector<complex_signal_t> _line{};
+    std::optional<overlap_save_filter> _overlap_save{};
+};
+
+/**
+ * @brief Carrier frequency offset, sample i rotated by 2 pi normalized_offset i + initial_phase.
+ *
+ * normalized_offset is the offset times the sample period, in cycles per sample.
+ */
+class cfo_stage {
+public:
+    explicit cfo_stage(const double normalized_offset, const double initial_phase = 0.0)
+        : _offset(normalized_offset), _initial_phase(initial_phase) {
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream&) {
+        constexpr std::size_t block = 1024;
+        const complex_signal_t step = std::polar(1.0, detail::two_pi * _offset);
+        for (std::size_t done = 0; done < n; done += block) {
+            const std::size_t m = std::min(block, n - done);
+            // the fractional cycles at the block start, exact however long the signal
+            const double cycles = _offset * static_cast<double>(_time) - std::floor(_offset * static_cast<double>(_time));
+            complex_signal_t phasor = std::polar(1.0, detail::two_pi * cycles + _initial_phase);
+            for (std::size_t i = 0; i < m; ++i) {
+                samples[done + i] = detail::multiply(samples[done + i], phasor);
+                phasor = detail::multiply(phasor, step);
+            }
+            _time += m;
+        }
+    }
+
+    void reset() {
+        _time = 0;
+    }
+
+private:
+    double _offset;
+    double _initial_phase;
+    uint64_t _time{0};
+};
+
+/**
+ * @brief Wiener phase noise: the phase is a random walk with N(0, 2 pi linewidth) steps.
+ *
+ * linewidth is the 3 dB linewidth of the oscillator times the sample period.
+ */
+class phase_noise_stage {
+public:
+    explicit phase_noise_stage(const double linewidth) : _step_deviation(std::sqrt(detail::two_pi * linewidth)) {
+        if (linewidth < 0) {
+            throw std::invalid_argument("phase noise needs a non-negative linewidth");
+        }
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream& generator) {
+        std::array<double, 512> steps{};
+        for (std::size_t done = 0; done < n; done += steps.size()) {
+            const std::size_t m = std::min(steps.size(), n - done);
+            generate_normal(generator, steps.data(), steps.data() + m, _step_deviation);
+            for (std::size_t i = 0; i < m; ++i) {
+                _phase += steps[i];
+                samples[done + i] = detail::multiply(samples[done + i], std::polar(1.0, _phase));
+            }
+            _phase = std::remainder(_phase, detail::two_pi);
+        }
+    }
+
+    void reset() {
+        _phase = 0.0;
+    }
+
+    // Phase of the last sample processed
+    double phase() const noexcept {
+        return _phase;
+    }
+
+private:
+    double _step_deviation;
+    double _phase{0.0};
+};
+
+/**
+ * @brief Channel stages applied in order, chunk_size samples at a time.
+ *
+ * Every stage runs on a chunk while it is still in cache before the next chunk is touched.
+ * The random draws depend on the chunking, which is fixed, so a trial is reproducible from
+ * its generator alone.
+ */
+template<typename... Stages>
+class channel {
+public:
+    static constexpr std::size_t chunk_size = 2048;
+
+    explicit channel(Stages... stages) : _stages(std::move(stages)...) {
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n, random_stream& generator) {
+        for (std::size_t done = 0; done < n; done += chunk_size) {
+            const std::size_t m = std::min(chunk_size, n - done);
+            std::apply([&](auto&... stage) { (stage.process(samples + done, m, generator), ...); }, _stages);
+        }
+    }
+
+    void process(complex_signal_seq_t& signal, random_stream& generator) {
+        process(signal.data(), signal.size(), generator);
+    }
+
+    void reset() {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, _stages);
+    }
+
+    template<std::size_t I>
+    auto& stage() noexcept {
+        return std::get<I>(_stages);
+    }
+
+private:
+    std::tuple<Stages...> _stages;
+};
+
+template<typename... Stages>
+channel<Stages...> make_channel(Stages... stages) {
+    return channel<Stages...>{std::move(stages)...};
+}
+
+}
+
+#endif // INCLUDE_CHANNEL_HPP
@@ -0,0 +1,260 @@
+#ifndef INCLUDE_CONSTELLATION_HPP
+#define INCLUDE_CONSTELLATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "definitions.h"
+#include "packed_bits.hpp"
+
+namespace comm {
+
+namespace detail {
+    constexpr bool is_power_of_two(const std::size_t m) {
+        return m != 0 && (m & (m - 1)) == 0;
+    }
+
+    constexpr std::size_t log2(std::size_t m) {
+        std::size_t k = 0;
+        while (m > 1) {
+            m >>= 1U;
+            ++k;
+        }
+        return k;
+    }
+
+    constexpr uint32_t gray_code(const uint32_t i) {
+        return i ^ (i >> 1U);
+    }
+
+    constexpr double constexpr_sqrt(const double x) {
+        double root = (x > 1) ? x : 1.0;
+        for (int32_t i = 0; i < 64; ++i) {
+            root = 0.5 * (root + x / root);
+        }
+        return root;
+    }
+
+    // sin and cos of x in [0, 2 pi], reduced to |r| <= pi/4 around a multiple of pi/2
+    constexpr std::array<double, 2> constexpr_sincos(const double x) {
+        constexpr double half_pi = 1.57079632679489661923;
+        const auto quadrant = static_cast<int32_t>(x / half_pi + 0.5);
+        const double r = x - quadrant * half_pi;
+        double s = 0;
+        double c = 0;
+        double term_s = r;
+        double term_c = 1;
+        for (int32_t n = 1; n <= 21; n += 2) {
+            s += term_s;
+            c += term_c;
+            term_s *= -r * r / ((n + 1) * (n + 2));
+            term_c *= -r * r / (n * (n + 1));
+        }
+        switch (quadrant % 4) {
+            case 0:
+                return {s, c};
+            case 1:
+                return {c, -s};
+            case 2:
+                return {-s, -c};
+            default:
+                return {-c, s};
+        }
+    }
+
+    // The k bits of symbol i starting at bit i * k, which may straddle two words
+    inline uint32_t read_label(const uint64_t* words, const std::size_t position, const std::size_t k) {
+        const std::size_t word = position / packed_bit_seq_t::bits_per_word;
+        const std::size_t shift = position % packed_bit_seq_t::bits_per_word;
+        uint64_t value = words[word] >> shift;
+        if (shift + k > packed_bit_seq_t::bits_per_word) {
+            value |= words[word + 1] << (packed_bit_seq_t::bits_per_word - shift);
+        }
+        return static_cast<uint32_t>(value & ((uint64_t{1} << k) - 1));
+    }
+
+    inline void write_label(uint64_t* words, const std::size_t position, const std::size_t k, const uint64_t label) {
+        const std::size_t word = position / packed_bit_seq_t::bits_per_word;
+        const std::size_t shift = position % packed_bit_seq_t::bits_per_word;
+        words[word] |= label << shift;
+        if (shift + k > packed_bit_seq_t::bits_per_word) {
+            words[word + 1] |= label >> (packed_bit_seq_t::bits_per_word - shift);
+        }
+    }
+}
+
+/*
+    Constellations with unit average energy and Gray labels, built at compile time.
+    The bits of a symbol form its label least significant bit first, points[label] is
+    the symbol of a label and decide() gives the label of the decision region a
+    received symbol falls in.
+*/
+
+/**
+ * @brief M-PSK, point k at angle 2 pi k / M + pi / M with label gray(k).
+ *
+ * psk_constellation<2> is bpsk_modulation, 0 -> -1 and 1 -> 1, and psk_constellation<4> is qpsk_modulation.
+ */
+template<std::size_t M>
+struct psk_constellation {
+    static_assert(M >= 2 && detail::is_power_of_two(M), "M must be a power of two");
+
+    static constexpr std::size_t order = M;
+    static constexpr std::size_t bits_per_symbol = detail::log2(M);
+
+    static constexpr std::array<complex_signal_t, M> points = []() {
+        constexpr double pi = 3.14159265358979323846;
+        std::array<complex_signal_t, M> p{};
+        for (uint32_t k = 0; k < M; ++k) {
+            const double angle = (M == 2) ? pi * (k + 1) : pi * (2 * k + 1) / M;
+            const auto sincos = detail::constexpr_sincos(angle);
+            p[detail::gray_code(k)] = complex_signal_t(sincos[1], sincos[0]);
+        }
+        return p;
+    }();
+
+    static constexpr std::array<uint32_t, M> labels = []() {
+        std::array<uint32_t, M> l{};
+        for (uint32_t k = 0; k < M; ++k) {
+            l[k] = detail::gray_code(k);
+        }
+        return l;
+    }();
+
+    // Slices the phase into M sectors, one atan2 whatever M is.
+    static uint32_t decide(const complex_signal_t& symbol) {
+        constexpr double pi = 3.14159265358979323846;
+        // sector k spans [2 pi k / M, 2 pi (k + 1) / M) once rotated so that point 0 sits in the middle of sector 0
+        const double rotation = (M == 2) ? -pi / 2 : 0;
+        double t = (std::atan2(symbol.imag(), symbol.real()) + rotation) * (M / (2 * pi));
+        t = (t < 0) ? t + M : t;
+        const auto k = (t >= 0 && t < M) ? static_cast<std::size_t>(t) : 0;
+        return labels[k];
+    }
+};
+
+/**
+ * @brief Square M-QAM, the product of two Gray labelled sqrt(M)-PAM axes.
+ *
+ * The low half of the label picks the in-phase level and the high half the quadrature one;
+ * level i of an axis is (sqrt(M) - 1 - 2 i) * scale with label gray(i), so qam_constellation<4> is qpsk_modulation.
+ */
+template<std::size_t M>
+struct qam_constellation {
+    static_assert(M >= 4 && detail::is_power_of_two(M) && detail::log2(M) % 2 == 0, "M must be an even power of two");
+
+    static constexpr std::size_t order = M;
+    static constexpr std::size_t bits_per_symbol = detail::log2(M);
+    static constexpr std::size_t bits_per_axis = bits_per_symbol / 2;
+    static constexpr std::size_t levels_per_axis = std::size_t{1} << bits_per_axis;
+    // Average energy of the odd integer grid is 2 (M - 1) / 3
+    static constexpr double scale = detail::constexpr_sqrt(3.0 / (2.0 * (M - 1)));
+
+    static constexpr std::array<double, levels_per_axis> axis_levels = []() {
+        std::array<double, levels_per_axis> a{};
+        for (uint32_t i = 0; i < levels_per_axis; ++i) {
+            a[detail::gray_code(i)] = (static_cast<double>(levels_per_axis) - 1 - 2 * i) * scale;
+        }
+        return a;
+    }();
+
+    static constexpr std::array<uint32_t, levels_per_axis> axis_labels = []() {
+        std::array<uint32_t, levels_per_axis> l{};
+        for (uint32_t i = 0; i < levels_per_axis; ++i) {
+            l[i] = detail::gray_code(i);
+        }
+        return l;
+    }();
+
+    static constexpr std::array<complex_signal_t, M> points = []() {
+        std::array<complex_signal_t, M> p{};
+        for (uint32_t label = 0; label < M; ++label) {
+            p[label] = complex_signal_t(axis_levels[label & (levels_per_axis - 1)], axis_levels[label >> bits_per_axis]);
+        }
+        return p;
+    }();
+
+    // Label of the nearest level on one axis, the boundaries lie halfway between levels.
+    static uint32_t decide_axis(const double x) {
+        const double t = ((levels_per_axis - 1) - x / scale) / 2 + 0.5;
+        const auto i = (t >= 1) ? ((t < levels_per_axis) ? static_cast<std::size_t>(t) : levels_per_axis - 1) : 0;
+        return axis_labels[i];
+    }
+
+    // Slices each axis on its own, cost independent of M.
+    static uint32_t decide(const complex_signal_t& symbol) {
+        return decide_axis(symbol.real()) | (decide_axis(symbol.imag()) << bits_per_axis);
+    }
+};
+
+/**
+ * @brief Map bits to symbols of a constellation, bits_per_symbol bits per symbol.
+ *
+ * @tparam Constellation psk_constellation<M> or qam_constellation<M>
+ */
+template<typename Constellation>
+void modulate(const bit_t* input_begin, const bit_t* input_end, complex_signal_t* output_begin) {
+    constexpr std::size_t k = Constellation::bits_per_symbol;
+    assert((input_end - input_begin) % k == 0);
+    for (; input_begin != input_end; input_begin += k, ++output_begin) {
+        uint32_t label = 0;
+        for (std::size_t j = 0; j < k; ++j) {
+            label |= static_cast<uint32_t>(input_begin[j] & 1U) << j;
+        }
+        *output_begin = Constellation::points[label];
+    }
+}
+
+template<typename Constellation>
+void demodulate(const complex_signal_t* input_begin, const complex_signal_t* input_end, bit_t* output_begin) {
+    constexpr std::size_t k = Constellation::bits_per_symbol;
+    for (; input_begin != input_end; ++input_begin, output_begin += k) {
+        const uint32_t label = Constellation::decide(*input_begin);
+        for (std::size_t j = 0; j < k; ++j) {
+            output_begin[j] = static_cast<bit_t>((label >> j) & 1U);
+        }
+    }
+}
+
+// Packed bit versions, the demodulator writes whole words and leaves the unused bits of the last one zero.
+
+template<typename Constellation>
+void modulate(const uint64_t* words, const std::size_t num_of_bits, complex_signal_t* symbols) {
+    constexpr std::size_t k = Constellation::bits_per_symbol;
+    assert(num_of_bits % k == 0);
+    for (std::size_t i = 0; i < num_of_bits / k; ++i) {
+        symbols[i] = Constellation::points[detail::read_label(words, i * k, k)];
+    }
+}
+
+template<typename Constellation>
+void demodulate(const complex_signal_t* symbols, const std::size_t num_of_symbols, uint64_t* words) {
+    constexpr std::size_t k = Constellation::bits_per_symbol;
+    std::fill(words, words + packed_bit_seq_t::num_of_words(num_of_symbols * k), uint64_t{0});
+    for (std::size_t i = 0; i < num_of_symbols; ++i) {
+        detail::write_label(words, i * k, k, Constellation::decide(symbols[i]));
+    }
+}
+
+template<typename Constellation>
+complex_signal_seq_t modulate(const bit_seq_t& bit_seq) {
+    assert(bit_seq.size() % Constellation::bits_per_symbol == 0);
+    complex_signal_seq_t symbols(bit_seq.size() / Constellation::bits_per_symbol);
+    modulate<Constellation>(bit_seq.data(), bit_seq.data() + bit_seq.size(), symbols.data());
+    return symbols;
+}
+
+template<typename Constellation>
+bit_seq_t demodulate(const complex_signal_seq_t& symbols) {
+    bit_seq_t bit_seq(symbols.size() * Constellation::bits_per_symbol);
+    demodulate<Constellation>(symbols.data(), symbols.data() + symbols.size(), bit_seq.data());
+    return bit_seq;
+}
+
+}
+
+#endif // INCLUDE_CONSTELLATION_HPP
@@ -0,0 +1,855 @@
+#ifndef INCLUDE_CONVOLUTIONAL_HPP
+#define INCLUDE_CONVOLUTIONAL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "definitions.h"
+#include "packed_bits.hpp"
+#include "sample.hpp"
+#include "simd.hpp"
+
+namespace comm {
+
+/*
+    The K = 7 rate 1/2 convolutional code of 802.11 and DVB, generators 0171 and 0133 in
+    octal, punctured to rates 2/3 and 3/4 with the 802.11 patterns. Coded bits alternate
+    between the two generators, punctured bits are left out.
+
+    convolutional_encoder works on packed words, 64 input bits per step of XORs and shifts.
+    viterbi_decoder takes soft values, LLRs quantized to int8_t by quantize_llr and positive
+    for 0, the punctured ones left out as sent, and runs the 64 add-compare-select butterflies
+    of a step in uint8 lanes, two AVX2 registers or one AVX-512 register, or optionally in
+    int16 lanes, twice as many registers. Both keep their state between calls, so a codeword
+    goes through in chunks of any size.
+*/
+
+enum class code_rate {
+    rate_1_2,
+    rate_2_3,
+    rate_3_4,
+};
+
+inline const char* to_string(const code_rate rate) {
+    switch (rate) {
+        case code_rate::rate_1_2:
+            return "1/2";
+        case code_rate::rate_2_3:
+            return "2/3";
+        default:
+            return "3/4";
+    }
+}
+
+inline double code_rate_value(const code_rate rate) {
+    switch (rate) {
+        case code_rate::rate_1_2:
+            return 1.0 / 2;
+        case code_rate::rate_2_3:
+            return 2.0 / 3;
+        default:
+            return 3.0 / 4;
+    }
+}
+
+namespace detail {
+    constexpr std::size_t conv_constraint_length = 7;
+    // the K - 1 zeros that end a codeword in the zero state
+    constexpr std::size_t conv_tail = conv_constraint_length - 1;
+    constexpr std::size_t conv_num_of_states = 64;
+    // bit 6 - j of a generator taps the input j steps back
+    constexpr std::array<unsigned, 2> conv_generators{0171, 0133};
+
+    // keep[2 * step + output] over period steps
+    struct puncture_pattern {
+        std::size_t period;
+        std::array<bool, 6> keep;
+        std::size_t kept;
+    };
+
+    inline const puncture_pattern& puncturing(const code_rate rate) {
+        static const puncture_pattern rate_1_2{1, {true, true}, 2};
+        static const puncture_pattern rate_2_3{2, {true, true, true, false}, 3};
+        static const puncture_pattern rate_3_4{3, {true, true, true, false, false, true}, 4};
+        switch (rate) {
+            case code_rate::rate_1_2:
+                return rate_1_2;
+            case code_rate::rate_2_3:
+                return rate_2_3;
+            default:
+                return rate_3_4;
+        }
+    }
+
+    inline uint64_t low_bits(const std::size_t n) {
+        return (n >= 64) ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+    }
+
+    // Bit i of the low 32 to bit 2 i
+    inline uint64_t spread_bits(uint64_t x) {
+        x &= 0xFFFFFFFFULL;
+        x = (x | (x << 16U)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8U)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4U)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2U)) & 0x3333333333333333ULL;
+        x = (x | (x << 1U)) & 0x5555555555555555ULL;
+        return x;
+    }
+
+    // Writes the count low bits of value at bit offset; the bits after them in the word are cleared
+    inline void write_bits(uint64_t* words, const std::size_t offset, const uint64_t value, const std::size_t count) {
+        if (count == 0) {
+            return;
+        }
+        const std::size_t word = offset / 64;
+        const std::size_t shift = offset % 64;
+        words[word] = (words[word] & low_bits(shift)) | (value << shift);
+        if (shift + count > 64) {
+            words[word + 1] = value >> (64 - shift);
+        }
+    }
+
+    inline int conv_parity(const unsigned x) {
+        return __builtin_parity(x);
+    }
+
+    // Sign of the branch metric of butterfly j, the transition from state 2 j on input 0, per generator
+    inline const std::array<std::array<int16_t, 32>, 2>& conv_branch_signs() {
+        static const auto signs = []() {
+            std::array<std::array<int16_t, 32>, 2> table{};
+            for (unsigned j = 0; j < 32; ++j) {
+                for (std::size_t g = 0; g < 2; ++g) {
+                    table[g][j] = static_cast<int16_t>(conv_parity((2 * j) & conv_generators[g]) ? -1 : 1);
+                }
+            }
+            return table;
+        }();
+        return signs;
+    }
+
+    /*
+        The kernels read a step as four int16, {L0, L1, L0, 0}: the 32-bit broadcasts of
+        {L0, L1} and {L1, L0} put the soft value of generator 0 in the even lanes of one and
+        the odd lanes of the other, so the branch metrics are two sign changes and an add.
+    */
+    constexpr std::size_t viterbi_step_stride = 4;
+
+    inline void write_viterbi_step(int16_t* step, const int8_t l0, const int8_t l1) {
+        step[0] = l0;
+        step[1] = l1;
+        step[2] = l0;
+        step[3] = 0;
+    }
+
+    // The signs of butterfly j for the {L0, L1} and the {L1, L0} broadcasts
+    inline const std::array<std::array<int16_t, 32>, 2>& conv_lane_signs() {
+        static const auto signs = []() {
+            const auto& branch = conv_branch_signs();
+            std::array<std::array<int16_t, 32>, 2> table{};
+            for (std::size_t j = 0; j < 32; ++j) {
+                table[0][j] = branch[j % 2][j];
+                table[1][j] = branch[1 - j % 2][j];
+            }
+            return table;
+        }();
+        return signs;
+    }
+
+    // Path metrics are brought back to state 0 this often and at the end of a call, well before int16 could saturate
+    constexpr std::size_t viterbi_renormalization = 32;
+
+    /*
+        One trellis step per soft pair: state t = j, j + 32 comes from 2 j or 2 j + 1, the
+        branches from 2 j + 1 and into j + 32 carrying the complement of the outputs of 2 j on 0.
+        Bit t of the decision word is set when the odd predecessor survived.
+    */
+    inline void viterbi_acs_scalar(int16_t* metrics, const int16_t* soft, const std::size_t steps, uint64_t* decisions) {
+        const auto& signs = conv_branch_signs();
+        std::array<int16_t, conv_num_of_states> next{};
+        for (std::size_t k = 0; k < steps; ++k) {
+            const int16_t* step = soft + viterbi_step_stride * k;
+            uint64_t decision{0};
+            for (std::size_t j = 0; j < 32; ++j) {
+                const int m = signs[0][j] * step[0] + signs[1][j] * step[1];
+                const int16_t even = metrics[2 * j];
+                const int16_t odd = metrics[2 * j + 1];
+                const int16_t low0 = saturate_int16(even + m);
+                const int16_t low1 = saturate_int16(odd - m);
+                const int16_t high0 = saturate_int16(even - m);
+                const int16_t high1 = saturate_int16(odd + m);
+                next[j] = std::max(low0, low1);
+                next[j + 32] = std::max(high0, high1);
+                decision |= static_cast<uint64_t>(low1 > low0) << j;
+                decision |= static_cast<uint64_t>(high1 > high0) << (j + 32);
+            }
+            std::copy(std::cbegin(next), std::cend(next), metrics);
+            if (k % viterbi_renormalization == viterbi_renormalization - 1 || k + 1 == steps) {
+                const int16_t base = metrics[0];
+                for (std::size_t t = 0; t < conv_num_of_states; ++t) {
+                    metrics[t] = saturate_int16(metrics[t] - base);
+                }
+            }
+            decisions[k] = decision;
+        }
+    }
+
+    // {step[offset], step[offset + 1]} as one 32-bit lane
+    inline int32_t viterbi_pair(const int16_t* step, const std::size_t offset) {
+        int32_t pair{};
+        std::memcpy(&pair, step + offset, sizeof(pair));
+        return pair;
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void viterbi_acs_avx2(int16_t* metrics, const int16_t* soft, const std::size_t steps, uint64_t* decisions) {
+        const auto& signs = conv_lane_signs();
+        const __m256i sign00 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(signs[0].data()));
+        const __m256i sign01 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(signs[0].data() + 16));
+        const __m256i sign10 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(signs[1].data()));
+        const __m256i sign11 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(signs[1].data() + 16));
+        // per 128-bit lane the even int16 to the low half, the odd to the high half
+        const __m256i split = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+                                               0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+        __m256i m0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics));
+        __m256i m1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics + 16));
+        __m256i m2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics + 32));
+        __m256i m3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics + 48));
+        for (std::size_t k = 0; k < steps; ++k) {
+            // states 0..31 to evens and odds of butterflies 0..15, 16..31 likewise
+            const __m256i a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(m0, split), 0xD8);
+            const __m256i b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(m1, split), 0xD8);
+            const __m256i c = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(m2, split), 0xD8);
+            const __m256i d = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(m3, split), 0xD8);
+            const __m256i even0 = _mm256_permute2x128_si256(a, b, 0x20);
+            const __m256i odd0 = _mm256_permute2x128_si256(a, b, 0x31);
+            const __m256i even1 = _mm256_permute2x128_si256(c, d, 0x20);
+            const __m256i odd1 = _mm256_permute2x128_si256(c, d, 0x31);
+
+            const int16_t* step = soft + viterbi_step_stride * k;
+            const __m256i straight = _mm256_set1_epi32(viterbi_pair(step, 0));
+            const __m256i swapped = _mm256_set1_epi32(viterbi_pair(step, 1));
+            const __m256i branch0 = _mm256_add_epi16(_mm256_sign_epi16(straight, sign00), _mm256_sign_epi16(swapped, sign10));
+            const __m256i branch1 = _mm256_add_epi16(_mm256_sign_epi16(straight, sign01), _mm256_sign_epi16(swapped, sign11));
+
+            const __m256i low00 = _mm256_adds_epi16(even0, branch0);
+            const __m256i low01 = _mm256_subs_epi16(odd0, branch0);
+            const __m256i low10 = _mm256_adds_epi16(even1, branch1);
+            const __m256i low11 = _mm256_subs_epi16(odd1, branch1);
+            const __m256i high00 = _mm256_subs_epi16(even0, branch0);
+            const __m256i high01 = _mm256_adds_epi16(odd0, branch0);
+            const __m256i high10 = _mm256_subs_epi16(even1, branch1);
+            const __m256i high11 = _mm256_adds_epi16(odd1, branch1);
+            m0 = _mm256_max_epi16(low00, low01);
+            m1 = _mm256_max_epi16(low10, low11);
+            m2 = _mm256_max_epi16(high00, high01);
+            m3 = _mm256_max_epi16(high10, high11);
+
+            // the comparisons to one bit per state, in state order after the lane-wise pack
+            const __m256i low = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpgt_epi16(low01, low00), _mm256_cmpgt_epi16(low11, low10)), 0xD8);
+            const __m256i high = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpgt_epi16(high01, high00), _mm256_cmpgt_epi16(high11, high10)), 0xD8);
+            decisions[k] = static_cast<uint32_t>(_mm256_movemask_epi8(low)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32U);
+
+            if (k % viterbi_renormalization == viterbi_renormalization - 1 || k + 1 == steps) {
+                const __m256i base = _mm256_broadcastw_epi16(_mm256_castsi256_si128(m0));
+                m0 = _mm256_subs_epi16(m0, base);
+                m1 = _mm256_subs_epi16(m1, base);
+                m2 = _mm256_subs_epi16(m2, base);
+                m3 = _mm256_subs_epi16(m3, base);
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics), m0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics + 16), m1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics + 32), m2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics + 48), m3);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void viterbi_acs_avx512(int16_t* metrics, const int16_t* soft, const std::size_t steps, uint64_t* decisions) {
+        const auto& signs = conv_lane_signs();
+        __mmask32 negate_straight{0};
+        __mmask32 negate_swapped{0};
+        alignas(64) std::array<int16_t, 32> even_index{};
+        alignas(64) std::array<int16_t, 32> odd_index{};
+        for (unsigned j = 0; j < 32; ++j) {
+            negate_straight |= static_cast<__mmask32>(signs[0][j] < 0) << j;
+            negate_swapped |= static_cast<__mmask32>(signs[1][j] < 0) << j;
+            even_index[j] = static_cast<int16_t>(2 * j);
+            odd_index[j] = static_cast<int16_t>(2 * j + 1);
+        }
+        const __m512i evens = _mm512_load_si512(even_index.data());
+        const __m512i odds = _mm512_load_si512(odd_index.data());
+        const __m512i zero = _mm512_setzero_si512();
+        __m512i low = _mm512_loadu_si512(metrics);
+        __m512i high = _mm512_loadu_si512(metrics + 32);
+        for (std::size_t k = 0; k < steps; ++k) {
+            const __m512i even = _mm512_permutex2var_epi16(low, evens, high);
+            const __m512i odd = _mm512_permutex2var_epi16(low, odds, high);
+            const int16_t* step = soft + viterbi_step_stride * k;
+            const __m512i straight = _mm512_set1_epi32(viterbi_pair(step, 0));
+            const __m512i swapped = _mm512_set1_epi32(viterbi_pair(step, 1));
+            const __m512i branch = _mm512_add_epi16(_mm512_mask_sub_epi16(straight, negate_straight, zero, straight),
+                                                    _mm512_mask_sub_epi16(swapped, negate_swapped, zero, swapped));
+
+            const __m512i low0 = _mm512_adds_epi16(even, branch);
+            const __m512i low1 = _mm512_subs_epi16(odd, branch);
+            const __m512i high0 = _mm512_subs_epi16(even, branch);
+            const __m512i high1 = _mm512_adds_epi16(odd, branch);
+            low = _mm512_max_epi16(low0, low1);
+            high = _mm512_max_epi16(high0, high1);
+            decisions[k] = static_cast<uint64_t>(_mm512_cmpgt_epi16_mask(low1, low0)) | (static_cast<uint64_t>(_mm512_cmpgt_epi16_mask(high1, high0)) << 32U);
+
+            if (k % viterbi_renormalization == viterbi_renormalization - 1 || k + 1 == steps) {
+                const __m512i base = _mm512_broadcastw_epi16(_mm512_castsi512_si128(low));
+                low = _mm512_subs_epi16(low, base);
+                high = _mm512_subs_epi16(high, base);
+            }
+        }
+        _mm512_storeu_si512(metrics, low);
+        _mm512_storeu_si512(metrics + 32, high);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    inline void viterbi_acs(int16_t* metrics, const int16_t* soft, const std::size_t steps, uint64_t* decisions) {
+#if COMM_SIMD_X86
+        switch (active_simd_isa()) {
+            case simd_isa::avx512:
+                viterbi_acs_avx512(metrics, soft, steps, decisions);
+                return;
+            case simd_isa::avx2:
+                viterbi_acs_avx2(metrics, soft, steps, decisions);
+                return;
+            default:
+                break;
+        }
+#endif
+        viterbi_acs_scalar(metrics, soft, steps, decisions);
+    }
+
+    /*
+        The uint8 kernels minimize costs instead: a soft value v, cut to +-viterbi_soft_max,
+        costs viterbi_soft_max - v for a 0 and viterbi_soft_max + v for a 1, so a step is the
+        four costs of a branch, one per sign pattern of its outputs, and the costs of the
+        complementary branches add up to viterbi_full_cost. The path metrics drop by
+        viterbi_byte_renormalization a step after those going into the previous step all
+        reached twice that, so that they still cover it, or at the end of the call, which
+        keeps the condition off the critical path of the kernels. The best path costs at
+        most 14 a step, the smaller of two complementary branches, so the best metric stays
+        below 48 + 2 * 14 and, every state being six steps from it, the worst below
+        76 + 6 * 28: only the unreachable states of the start saturate, at 255.
+    */
+    constexpr int viterbi_soft_max = 7;
+    constexpr int viterbi_full_cost = 4 * viterbi_soft_max;
+    constexpr uint8_t viterbi_byte_renormalization = 24;
+
+    // The soft value of a uint8 step, the LLR / 3 rounded and saturated to 4 bits
+    constexpr int viterbi_soft(const int8_t llr) {
+        // (llr + 1) / 3 rounded down, by a division of positive numbers
+        return std::clamp((llr + 385) / 3 - 128, -viterbi_soft_max, viterbi_soft_max);
+    }
+
+    // Per soft value, its share of the four costs of a step as output 0 and as output 1, byte p for costs[p]
+    constexpr std::array<std::array<uint32_t, 256>, 2> viterbi_cost_shares = []() {
+        std::array<std::array<uint32_t, 256>, 2> table{};
+        for (int llr = -128; llr < 128; ++llr) {
+            const int v = viterbi_soft(static_cast<int8_t>(llr));
+            const auto zero = static_cast<uint32_t>(viterbi_soft_max - v);
+            const auto one = static_cast<uint32_t>(viterbi_soft_max + v);
+            const auto i = static_cast<uint8_t>(llr);
+            table[0][i] = zero | (one << 8U) | (zero << 16U) | (one << 24U);
+            table[1][i] = zero | (zero << 8U) | (one << 16U) | (one << 24U);
+        }
+        return table;
+    }();
+
+    // costs[p] of the outputs whose signs are p & 1 and p & 2, set for a 1; the shares add up without carries
+    inline void write_viterbi_costs(uint8_t* costs, const int8_t l0, const int8_t l1) {
+        const uint32_t word = viterbi_cost_shares[0][static_cast<uint8_t>(l0)] + viterbi_cost_shares[1][static_cast<uint8_t>(l1)];
+        std::memcpy(costs, &word, sizeof(word));
+    }
+
+    // The cost index of the branch from the even predecessor into state t, whose odd branch is 3 minus it
+    inline const std::array<uint8_t, conv_num_of_states>& conv_cost_patterns() {
+        static const auto patterns = []() {
+            const auto& branch = conv_branch_signs();
+            std::array<uint8_t, conv_num_of_states> table{};
+            for (std::size_t j = 0; j < 32; ++j) {
+                table[j] = static_cast<uint8_t>((branch[0][j] < 0) | ((branch[1][j] < 0) << 1U));
+                table[j + 32] = static_cast<uint8_t>(3 - table[j]);
+            }
+            return table;
+        }();
+        return patterns;
+    }
+
+    inline void viterbi_acs_scalar(uint8_t* metrics, const uint8_t* costs, const std::size_t steps, uint64_t* decisions) {
+        const auto& patterns = conv_cost_patterns();
+        std::array<uint8_t, conv_num_of_states> next{};
+        int drop{0};
+        for (std::size_t k = 0; k < steps; ++k) {
+            const uint8_t* step = costs + viterbi_step_stride * k;
+            const bool renormalize = *std::min_element(metrics, metrics + conv_num_of_states) >= 2 * viterbi_byte_renormalization;
+            uint64_t decision{0};
+            for (std::size_t t = 0; t < conv_num_of_states; ++t) {
+                const std::size_t j = t % 32;
+                const int even = std::min(metrics[2 * j] + step[patterns[t]], 255);
+                const int odd = std::min(metrics[2 * j + 1] + step[3 - patterns[t]], 255);
+                next[t] = static_cast<uint8_t>(std::min(even, odd) - drop);
+                decision |= static_cast<uint64_t>(odd < even) << t;
+            }
+            std::copy(std::cbegin(next), std::cend(next), metrics);
+            drop = renormalize ? viterbi_byte_renormalization : 0;
+            decisions[k] = decision;
+        }
+        // the drop decided last is covered already
+        for (std::size_t t = 0; t < conv_num_of_states; ++t) {
+            metrics[t] = static_cast<uint8_t>(metrics[t] - drop);
+        }
+    }
+
+    // The four costs of a step as one 32-bit lane
+    inline int32_t viterbi_costs(const uint8_t* step) {
+        int32_t costs{};
+        std::memcpy(&costs, step, sizeof(costs));
+        return costs;
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void viterbi_acs_avx2(uint8_t* metrics, const uint8_t* costs, const std::size_t steps, uint64_t* decisions) {
+        const __m256i patterns = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(conv_cost_patterns().data()));
+        // per 128-bit lane the even states to the low 8 bytes, the odd to the high 8
+        const __m256i split = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                                               0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        const __m256i full = _mm256_set1_epi8(static_cast<char>(viterbi_full_cost));
+        const __m256i threshold = _mm256_set1_epi8(static_cast<char>(2 * viterbi_byte_renormalization));
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(metrics + 32));
+        __m256i drop = _mm256_setzero_si256();
+        for (std::size_t k = 0; k < steps; ++k) {
+            const __m256i below = _mm256_or_si256(_mm256_subs_epu8(threshold, low), _mm256_subs_epu8(threshold, high));
+            const __m256i next_drop = _mm256_set1_epi8(static_cast<char>(viterbi_byte_renormalization * _mm256_testz_si256(below, below)));
+            // the 32 even and the 32 odd predecessors
+            const __m256i a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(low, split), 0xD8);
+            const __m256i b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(high, split), 0xD8);
+            const __m256i even = _mm256_permute2x128_si256(a, b, 0x20);
+            const __m256i odd = _mm256_permute2x128_si256(a, b, 0x31);
+
+            const __m256i cost = _mm256_shuffle_epi8(_mm256_set1_epi32(viterbi_costs(costs + viterbi_step_stride * k)), patterns);
+            const __m256i complement = _mm256_sub_epi8(full, cost);
+            const __m256i low0 = _mm256_adds_epu8(even, cost);
+            const __m256i low1 = _mm256_adds_epu8(odd, complement);
+            const __m256i high0 = _mm256_adds_epu8(even, complement);
+            const __m256i high1 = _mm256_adds_epu8(odd, cost);
+            const __m256i low_min = _mm256_min_epu8(low0, low1);
+            const __m256i high_min = _mm256_min_epu8(high0, high1);
+            // set where the even predecessor survived, ties included
+            const auto low_even = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low_min, low0)));
+            const auto high_even = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high_min, high0)));
+            decisions[k] = ~(low_even | (static_cast<uint64_t>(high_even) << 32U));
+            low = _mm256_sub_epi8(low_min, drop);
+            high = _mm256_sub_epi8(high_min, drop);
+            drop = next_drop;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics), _mm256_sub_epi8(low, drop));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(metrics + 32), _mm256_sub_epi8(high, drop));
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void viterbi_acs_avx512(uint8_t* metrics, const uint8_t* costs, const std::size_t steps, uint64_t* decisions) {
+        const __m512i patterns = _mm512_loadu_si512(conv_cost_patterns().data());
+        // per 128-bit lane the even states to the low 8 bytes, the odd to the high 8
+        const auto even_bytes = static_cast<int64_t>(0x0E0C0A0806040200);
+        const auto odd_bytes = static_cast<int64_t>(0x0F0D0B0907050301);
+        const __m512i split = _mm512_set_epi64(odd_bytes, even_bytes, odd_bytes, even_bytes, odd_bytes, even_bytes, odd_bytes, even_bytes);
+        // the even and the odd 8-byte groups, twice over
+        const __m512i evens = _mm512_set_epi64(6, 4, 2, 0, 6, 4, 2, 0);
+        const __m512i odds = _mm512_set_epi64(7, 5, 3, 1, 7, 5, 3, 1);
+        const __m512i full = _mm512_set1_epi8(static_cast<char>(viterbi_full_cost));
+        const __m512i threshold = _mm512_set1_epi8(static_cast<char>(2 * viterbi_byte_renormalization));
+        __m512i m = _mm512_loadu_si512(metrics);
+        __m512i drop = _mm512_setzero_si512();
+        for (std::size_t k = 0; k < steps; ++k) {
+            const bool renormalize = _mm512_cmplt_epu8_mask(m, threshold) == 0;
+            const __m512i next_drop = _mm512_set1_epi8(static_cast<char>(viterbi_byte_renormalization * renormalize));
+            const __m512i grouped = _mm512_shuffle_epi8(m, split);
+            const __m512i even = _mm512_permutexvar_epi64(evens, grouped);
+            const __m512i odd = _mm512_permutexvar_epi64(odds, grouped);
+
+            const __m512i cost = _mm512_shuffle_epi8(_mm512_set1_epi32(viterbi_costs(costs + viterbi_step_stride * k)), patterns);
+            const __m512i from_even = _mm512_adds_epu8(even, cost);
+            const __m512i from_odd = _mm512_adds_epu8(odd, _mm512_sub_epi8(full, cost));
+            m = _mm512_sub_epi8(_mm512_min_epu8(from_even, from_odd), drop);
+            decisions[k] = _mm512_cmplt_epu8_mask(from_odd, from_even);
+            drop = next_drop;
+        }
+        _mm512_storeu_si512(metrics, _mm512_sub_epi8(m, drop));
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    inline void viterbi_acs(uint8_t* metrics, const uint8_t* costs, const std::size_t steps, uint64_t* decisions) {
+#if COMM_SIMD_X86
+        switch (active_simd_isa()) {
+            case simd_isa::avx512:
+                viterbi_acs_avx512(metrics, costs, steps, decisions);
+                return;
+            case simd_isa::avx2:
+                viterbi_acs_avx2(metrics, costs, steps, decisions);
+                return;
+            default:
+                break;
+        }
+#endif
+        viterbi_acs_scalar(metrics, costs, steps, decisions);
+    }
+}
+
+// Coded bits of num_of_bits information bits and the tail
+inline std::size_t coded_length(const std::size_t num_of_bits, const code_rate rate) {
+    const auto& pattern = detail::puncturing(rate);
+    const std::size_t steps = num_of_bits + detail::conv_tail;
+    std::size_t length = steps / pattern.period * pattern.kept;
+    for (std::size_t step = 0; step < steps % pattern.period; ++step) {
+        length += pattern.keep[2 * step] + pattern.keep[2 * step + 1];
+    }
+    return length;
+}
+
+/**
+ * @brief Convolutional encoder on packed bits, 64 at a time.
+ *
+ * Each generator output of a word is the XOR of the word shifted by the taps of the
+ * generator, the bits of the previous words shifted in; the two outputs are then
+ * interleaved and punctured. Every call but the last of a codeword takes a multiple of
+ * 64 bits; terminate() ends the codeword with the tail to the zero state.
+ */
+class convolutional_encoder {
+public:
+    explicit convolutional_encoder(const code_rate rate = code_rate::rate_1_2) : _rate(rate), _pattern(detail::puncturing(rate)) {
+    }
+
+    code_rate rate() const noexcept {
+        return _rate;
+    }
+
+    // Writes the coded bits of num_of_bits packed bits to coded from bit offset on and returns their number.
+    std::size_t encode(const uint64_t* words, const std::size_t num_of_bits, uint64_t* coded, std::size_t offset = 0) {
+        const std::size_t start = offset;
+        for (std::size_t done = 0; done < num_of_bits; done += 64) {
+            const std::size_t m = std::min<std::size_t>(64, num_of_bits - done);
+            const uint64_t word = words[done / 64] & detail::low_bits(m);
+            std::array<uint64_t, 2> outputs{};
+            for (std::size_t g = 0; g < 2; ++g) {
+                for (std::size_t j = 0; j < detail::conv_constraint_length; ++j) {
+                    if ((detail::conv_generators[g] >> (6 - j)) & 1U) {
+                        outputs[g] ^= (j == 0) ? word : (word << j) | (_history >> (64 - j));
+                    }
+                }
+                outputs[g] &= detail::low_bits(m);
+            }
+            _history = (m == 64) ? word : (word << (64 - m)) | (_history >> m);
+            offset = _write(outputs, m, coded, offset);
+        }
+        return offset - start;
+    }
+
+    // The tail of the codeword, from bit offset on; the encoder is then ready for the next codeword.
+    std::size_t terminate(uint64_t* coded, const std::size_t offset = 0) {
+        const uint64_t zero{0};
+        const std::size_t n = encode(&zero, detail::conv_tail, coded, offset);
+        reset();
+        return n;
+    }
+
+    void reset() {
+        _history = 0;
+        _step = 0;
+    }
+
+private:
+    std::size_t _write(const std::array<uint64_t, 2>& outputs, const std::size_t m, uint64_t* coded, std::size_t offset) {
+        if (_pattern.period == 1) {
+            const uint64_t low = detail::spread_bits(outputs[0]) | (detail::spread_bits(outputs[1]) << 1U);
+            const uint64_t high = detail::spread_bits(outputs[0] >> 32U) | (detail::spread_bits(outputs[1] >> 32U) << 1U);
+            detail::write_bits(coded, offset, low, std::min<std::size_t>(2 * m, 64));
+            detail::write_bits(coded, offset + 64, high, (2 * m > 64) ? 2 * m - 64 : 0);
+            return offset + 2 * m;
+        }
+        uint64_t buffer{0};
+        std::size_t buffered{0};
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t g = 0; g < 2; ++g) {
+                if (_pattern.keep[2 * _step + g]) {
+                    buffer |= ((outputs[g] >> i) & 1U) << buffered;
+                    if (++buffered == 64) {
+                        detail::write_bits(coded, offset, buffer, 64);
+                        offset += 64;
+                        buffer = 0;
+                        buffered = 0;
+                    }
+                }
+            }
+            _step = (_step + 1 == _pattern.period) ? 0 : _step + 1;
+        }
+        detail::write_bits(coded, offset, buffer, buffered);
+        return offset + buffered;
+    }
+
+    code_rate _rate;
+    detail::puncture_pattern _pattern;
+    // the latest input bits, the newest in bit 63
+    uint64_t _history{0};
+    // in the puncturing period
+    std::size_t _step{0};
+};
+
+// Width of the path metrics of viterbi_decoder; int8 runs twice the states per register of int16
+enum class viterbi_metric {
+    int8,
+    int16,
+};
+
+/**
+ * @brief Viterbi decoder with a sliding-window traceback, for streaming.
+ *
+ * The decisions of the steps go to a window; once it holds twice traceback_depth steps,
+ * the path of the best state is traced back and all but the latest traceback_depth
+ * decisions become bits. finish() traces the rest back from the zero state the tail
+ * leaves the encoder in. Five constraint lengths are enough for rate 1/2, the punctured
+ * rates need more, hence the default of 96.
+ *
+ * The int8 metrics see the soft values divided by 3, at most 7 in magnitude, which costs
+ * a few hundredths of a dB against the full int8 soft values of the int16 metrics.
+ */
+class viterbi_decoder {
+public:
+    static constexpr std::size_t default_traceback_depth = 96;
+    static constexpr std::size_t max_traceback_depth = 256;
+
+    explicit viterbi_decoder(const code_rate rate = code_rate::rate_1_2, const std::size_t traceback_depth = default_traceback_depth,
+                             const viterbi_metric metric = viterbi_metric::int8)
+        : _rate(rate), _pattern(detail::puncturing(rate)), _traceback_depth(traceback_depth), _metric(metric) {
+        if (traceback_depth < detail::conv_tail || traceback_depth > max_traceback_depth) {
+            throw std::invalid_argument("the traceback must be at least as deep as the tail of the code and at most max_traceback_depth");
+        }
+        for (std::size_t position = 0, k = 0; position < 2 * _pattern.period; ++position) {
+            _sources[position] = _pattern.keep[position] ? k++ : _sources.size();
+        }
+        reset();
+    }
+
+    code_rate rate() const noexcept {
+        return _rate;
+    }
+
+    std::size_t traceback_depth() const noexcept {
+        return _traceback_depth;
+    }
+
+    viterbi_metric metric() const noexcept {
+        return _metric;
+    }
+
+    // Writes the bits decided after n more soft values, at most n + traceback_depth(), and returns their number.
+    std::size_t decode(const int8_t* soft, const std::size_t n, bit_t* bits) {
+        std::size_t num_of_bits = 0;
+        for (std::size_t used = 0; used < n;) {
+            // fewer than 2 traceback_depth() decisions are pending here, a slice more fits the window
+            std::size_t steps{0};
+            std::ptrdiff_t best{0};
+            if (_metric == viterbi_metric::int8) {
+                uint8_t* costs = _costs.data();
+                steps = _depuncture(soft + used, n - used, used, [costs](const std::size_t k, const int8_t l0, const int8_t l1) {
+                    detail::write_viterbi_costs(costs + detail::viterbi_step_stride * k, l0, l1);
+                });
+                detail::viterbi_acs(_byte_metrics.data(), _costs.data(), steps, _decisions.data() + _num_of_decisions);
+                best = std::distance(std::cbegin(_byte_metrics), std::min_element(std::cbegin(_byte_metrics), std::cend(_byte_metrics)));
+            } else {
+                int16_t* out = _steps.data();
+                steps = _depuncture(soft + used, n - used, used, [out](const std::size_t k, const int8_t l0, const int8_t l1) {
+                    detail::write_viterbi_step(out + detail::viterbi_step_stride * k, l0, l1);
+                });
+                detail::viterbi_acs(_metrics.data(), _steps.data(), steps, _decisions.data() + _num_of_decisions);
+                best = std::distance(std::cbegin(_metrics), std::max_element(std::cbegin(_metrics), std::cend(_metrics)));
+            }
+            _num_of_decisions += steps;
+            if (_num_of_decisions >= 2 * _traceback_depth) {
+                num_of_bits += _traceback(static_cast<std::size_t>(best), _num_of_decisions - _traceback_depth, bits + num_of_bits);
+            }
+        }
+        return num_of_bits;
+    }
+
+    // decode() on hard decisions, each bit a soft value of magnitude 3, a unit of the int8 metrics
+    std::size_t decode_hard(const bit_t* coded, const std::size_t n, bit_t* bits) {
+        std::size_t num_of_bits = 0;
+        std::array<int8_t, 512> soft{};
+        for (std::size_t done = 0; done < n; done += soft.size()) {
+            const std::size_t chunk = std::min(soft.size(), n - done);
+            for (std::size_t i = 0; i < chunk; ++i) {
+                soft[i] = static_cast<int8_t>(3 - 6 * (coded[done + i] & 1U));
+            }
+            num_of_bits += decode(soft.data(), chunk, bits + num_of_bits);
+        }
+        return num_of_bits;
+    }
+
+    // Writes the bits left at the end of a terminated codeword, the tail left out, and starts over.
+    std::size_t finish(bit_t* bits) {
+        const std::size_t pending = _num_of_decisions;
+        const std::size_t num_of_bits = _traceback(0, (pending > detail::conv_tail) ? pending - detail::conv_tail : 0, bits);
+        reset();
+        return num_of_bits;
+    }
+
+    void reset() {
+        // the encoder starts in the zero state
+        std::fill(std::begin(_metrics), std::end(_metrics), int16_t{-4096});
+        _metrics[0] = 0;
+        _byte_metrics.fill(uint8_t{255});
+        _byte_metrics[0] = 0;
+        _num_of_decisions = 0;
+        _step = 0;
+        _output = 0;
+    }
+
+private:
+    // Steps per kernel call, their decisions stay in the L1 cache
+    static constexpr std::size_t _slice = 2048;
+
+    // Soft values to write(k, l0, l1) of the steps, zeros where the pattern punctured, up to a slice; returns the steps completed
+    template<typename Write>
+    std::size_t _depuncture(const int8_t* soft, const std::size_t n, std::size_t& used, const Write& write) {
+        std::size_t steps = 0;
+        std::size_t i = 0;
+        if (_step == 0 && _output == 0) {
+            // whole periods at a time
+            const std::size_t num_of_periods = std::min(n / _pattern.kept, _slice / _pattern.period);
+            if (_pattern.period == 1) {
+                for (std::size_t k = 0; k < num_of_periods; ++k) {
+                    write(k, soft[2 * k], soft[2 * k + 1]);
+                }
+            } else {
+                // locals, which the writes of the int8 costs cannot alias
+                const auto sources = _sources;
+                const std::size_t period = _pattern.period;
+                const std::size_t kept = _pattern.kept;
+                for (std::size_t k = 0, out = 0; k < num_of_periods; ++k) {
+                    std::array<int8_t, 7> values{};
+                    std::copy_n(soft + k * kept, kept, std::begin(values));
+                    for (std::size_t step = 0; step < period; ++step, ++out) {
+                        write(out, values[sources[2 * step]], values[sources[2 * step + 1]]);
+                    }
+                }
+            }
+            i = num_of_periods * _pattern.kept;
+            steps = num_of_periods * _pattern.period;
+        }
+        for (; i < n && steps < _slice; ++i) {
+            _pair[_output] = soft[i];
+            steps += _advance(steps, write);
+        }
+        used += i;
+        return steps;
+    }
+
+    // To the next position the pattern sent, zeros in the others; a completed step is written as step k first
+    template<typename Write>
+    bool _advance(const std::size_t k, const Write& write) {
+        while (++_output < 2) {
+            if (_pattern.keep[2 * _step + _output]) {
+                return false;
+            }
+            _pair[_output] = 0;
+        }
+        write(k, _pair[0], _pair[1]);
+        _output = 0;
+        _step = (_step + 1 == _pattern.period) ? 0 : _step + 1;
+        if (!_pattern.keep[2 * _step]) {
+            _pair[0] = 0;
+            _output = 1;
+        }
+        return true;
+    }
+
+    // Follows the decisions back from state at the latest step and writes the bits of the oldest num_of_bits steps
+    std::size_t _traceback(std::size_t state, const std::size_t num_of_bits, bit_t* bits) {
+        const auto previous = [this](const std::size_t k, const std::size_t state) {
+            return ((state << 1U) & (detail::conv_num_of_states - 1)) | ((_decisions[k] >> state) & 1U);
+        };
+        std::size_t k = _num_of_decisions;
+        for (; k > num_of_bits; --k) {
+            state = previous(k - 1, state);
+        }
+        for (; k-- > 0;) {
+            bits[k] = static_cast<bit_t>(state >> 5U);
+            state = previous(k, state);
+        }
+        std::copy(std::cbegin(_decisions) + static_cast<std::ptrdiff_t>(num_of_bits), std::cbegin(_decisions) + static_cast<std::ptrdiff_t>(_num_of_decisions),
+                  std::begin(_decisions));
+        _num_of_decisions -= num_of_bits;
+        return num_of_bits;
+    }
+
+    code_rate _rate;
+    detail::puncture_pattern _pattern;
+    std::size_t _traceback_depth;
+    viterbi_metric _metric;
+    alignas(64) std::array<int16_t, detail::conv_num_of_states> _metrics{};
+    // the smallest costs into the states of the int8 metrics
+    alignas(64) std::array<uint8_t, detail::conv_num_of_states> _byte_metrics{};
+    // one word per step not yet decided, the oldest first; fixed, so that decoding never allocates
+    std::array<uint64_t, 2 * max_traceback_depth + _slice> _decisions{};
+    std::size_t _num_of_decisions{0};
+    // the soft values of a slice as the kernels read them, the punctured ones as zeros
+    alignas(64) std::array<int16_t, detail::viterbi_step_stride * _slice> _steps{};
+    // the four branch costs of each step of a slice for the int8 metrics
+    alignas(64) std::array<uint8_t, detail::viterbi_step_stride * _slice> _costs{};
+    // per position of a period, its soft value among those sent, 6 (a zero) where punctured
+    std::array<std::size_t, 6> _sources{};
+    std::array<int8_t, 2> _pair{};
+    std::size_t _step{0};
+    std::size_t _output{0};
+};
+
+// A terminated codeword of the bits
+inline bit_seq_t convolutional_encode(const bit_seq_t& bits, const code_rate rate = code_rate::rate_1_2) {
+    const packed_bit_seq_t packed{bits};
+    const std::size_t length = coded_length(bits.size(), rate);
+    std::vector<uint64_t> words(packed_bit_seq_t::num_of_words(length) + 1);
+    convolutional_encoder encoder{rate};
+    const std::size_t n = encoder.encode(packed.data(), bits.size(), words.data());
+    encoder.terminate(words.data(), n);
+    bit_seq_t result(length);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<bit_t>((words[i / 64] >> (i % 64)) & 1U);
+    }
+    return result;
+}
+
+// The bits of a terminated codeword from its soft values
+inline bit_seq_t viterbi_decode(const std::vector<int8_t>& soft, const code_rate rate = code_rate::rate_1_2,
+                                const viterbi_metric metric = viterbi_metric::int8) {
+    viterbi_decoder decoder{rate, viterbi_decoder::default_traceback_depth, metric};
+    bit_seq_t bits(soft.size() + decoder.traceback_depth());
+    std::size_t n = decoder.decode(soft.data(), soft.size(), bits.data());
+    n += decoder.finish(bits.data() + n);
+    bits.resize(n);
+    return bits;
+}
+
+}
+
+#endif // INCLUDE_CONVOLUTIONAL_HPP
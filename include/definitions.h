@@ -2,7 +2,9 @@
 #define INCLUDE_DEFINITIONS_H
 
 #include <complex>
+#include <cstddef>
 #include <cstdint>
+#include <new>
 #include <vector>
 #ifdef FFTW_COMPLEX_TYPE
 #include <fftw3.h>
@@ -18,17 +20,53 @@ namespace comm {
     using bit_t = uint8_t;
     using bit_seq_t = std::vector<bit_t>;
 
-#ifndef FFTW_COMPLEX_TYPE
     using complex_signal_t = std::complex<double>;
+
+#ifndef FFTW_COMPLEX_TYPE
     using complex_signal_seq_t = std::vector<complex_signal_t>;
 
 #else
-    using complex_signal_t = fftw_complex;
+    /*
+        Signal buffers come from fftw_malloc, SIMD aligned the way FFTW plans expect, so PSK
+        mappers, the noise adder and the FFT stages all work on the same storage.
+        complex_signal_t stays std::complex<double>, which has the layout of fftw_complex.
+    */
+    template<typename T>
+    struct fftw_allocator {
+        using value_type = T;
+
+        fftw_allocator() noexcept = default;
+
+        template<typename U>
+        fftw_allocator(const fftw_allocator<U>&) noexcept {}
+
+        T* allocate(const std::size_t n) {
+            auto* p = static_cast<T*>(fftw_malloc(n * sizeof(T)));
+            if (p == nullptr && n != 0) {
+                throw std::bad_alloc{};
+            }
+            return p;
+        }
 
-    complex_signal_t operator+(const complex_signal_t& val1, const complex_signal_t& val1) {
-        return complex_signal_t{val1[0] + val2[0], val1[1] + val2[1]};
+        void deallocate(T* p, std::size_t) noexcept {
+            fftw_free(p);
+        }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const fftw_allocator<T>&, const fftw_allocator<U>&) noexcept {
+        return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const fftw_allocator<T>&, const fftw_allocator<U>&) noexcept {
+        return false;
     }
 
+    using complex_signal_seq_t = std::vector<complex_signal_t, fftw_allocator<complex_signal_t>>;
+
+    static_assert(sizeof(complex_signal_t) == sizeof(fftw_complex), "std::complex<double> must match fftw_complex");
+
 #endif
 
 
@@ -0,0 +1,262 @@
+#ifndef INCLUDE_FFT_HPP
+#define INCLUDE_FFT_HPP
+
+#include <fftw3.h>
+
+#include <algorithm>
+#include <cctype>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "definitions.h"
+#include "simd.hpp"
+
+#if COMM_SIMD_X86
+#include <cpuid.h>
+#endif
+
+namespace comm {
+
+/*
+    std::complex<double> and fftw_complex share their layout, so signal buffers are
+    handed to FFTW with a reinterpret_cast and no copy.
+*/
+inline fftw_complex* as_fftw(complex_signal_t* signal) {
+    return reinterpret_cast<fftw_complex*>(signal);
+}
+
+enum class fft_direction {
+    forward = FFTW_FORWARD,
+    backward = FFTW_BACKWARD,
+};
+
+namespace detail {
+    struct fftw_deleter {
+        void operator()(void* p) const noexcept {
+            fftw_free(p);
+        }
+    };
+
+    // Vendor, family, model and stepping; wisdom measured on one CPU is no good on another.
+    inline std::string cpu_signature() {
+#if COMM_SIMD_X86
+        unsigned int eax{};
+        unsigned int ebx{};
+        unsigned int ecx{};
+        unsigned int edx{};
+        if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) != 0) {
+            char vendor[13]{};
+            std::memcpy(vendor, &ebx, 4);
+            std::memcpy(vendor + 4, &edx, 4);
+            std::memcpy(vendor + 8, &ecx, 4);
+            __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+            const unsigned int family = ((eax >> 8U) & 0xFU) + ((eax >> 20U) & 0xFFU);
+            const unsigned int model = ((eax >> 4U) & 0xFU) | ((eax >> 12U) & 0xF0U);
+            return std::string(vendor) + "-" + std::to_string(family) + "-" + std::to_string(model) + "-" + std::to_string(eax & 0xFU);
+        }
+#endif
+        return "generic";
+    }
+}
+
+// SIMD-aligned complex buffer from fftw_malloc, which is what FFTW plans for.
+using fftw_buffer = std::unique_ptr<complex_signal_t[], detail::fftw_deleter>;
+
+inline fftw_buffer make_fftw_buffer(const std::size_t n) {
+    auto* p = static_cast<complex_signal_t*>(fftw_malloc(sizeof(complex_signal_t) * n));
+    if (p == nullptr && n != 0) {
+        throw std::bad_alloc{};
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        new (p + i) complex_signal_t{};
+    }
+    return fftw_buffer{p};
+}
+
+struct fft_plan_config {
+    // Where wisdom files go, none when empty. Defaults to $COMM_FFTW_WISDOM_DIR.
+    std::string wisdom_directory{};
+    // FFTW_MEASURE, FFTW_PATIENT or FFTW_EXHAUSTIVE
+    unsigned flags{FFTW_MEASURE};
+    // Seconds the planner may spend per plan, negative for no limit
+    double time_limit{-1.0};
+};
+
+/**
+ * @brief Process-wide cache of in-place FFTW plans for batches of equally sized transforms.
+ *
+ * Plans are measured once per (size, batch, direction) on a scratch buffer and then run on
+ * any other fftw_malloc'd buffer with fftw_execute_dft, so transforms pay neither planning
+ * nor allocation after the first use. Threads share the plans: executing is thread safe and
+ * the planner is made so with fftw_make_planner_thread_safe, which needs -lfftw3_threads.
+ *
+ * With a wisdom directory the plans share one wisdom file per CPU and FFTW version. A plan
+ * imports it and plans from it alone when it can; otherwise it is measured, and the file is
+ * merged with the process's wisdom and rewritten, so only the first run on a machine pays
+ * for each measured plan.
+ */
+class fft_plan_cache {
+public:
+    static fft_plan_cache& instance() {
+        static fft_plan_cache cache{};
+        return cache;
+    }
+
+    fft_plan_cache(const fft_plan_cache&) = delete;
+    fft_plan_cache& operator=(const fft_plan_cache&) = delete;
+
+    ~fft_plan_cache() {
+        for (const auto& entry : _plans) {
+            fftw_destroy_plan(entry.second);
+        }
+    }
+
+    // Applies to the plans made from now on.
+    void configure(const fft_plan_config& config) {
+        const std::lock_guard<std::mutex> lock{_mutex};
+        _config = config;
+        fftw_set_timelimit(config.time_limit);
+    }
+
+    fft_plan_config config() const {
+        const std::lock_guard<std::mutex> lock{_mutex};
+        return _config;
+    }
+
+    /**
+     * @param size transform length
+     * @param batch number of transforms, contiguous one after the other
+     */
+    fftw_plan get(const std::size_t size, const std::size_t batch, const fft_direction direction) {
+        const key_type key{size, batch, direction};
+        fft_plan_config config{};
+        {
+            const std::lock_guard<std::mutex> lock{_mutex};
+            const auto found = _plans.find(key);
+            if (found != _plans.end()) {
+                return found->second;
+            }
+            config = _config;
+        }
+
+        fftw_plan plan = _make_plan(key, config);
+        const std::lock_guard<std::mutex> lock{_mutex};
+        const auto [it, inserted] = _plans.emplace(key, plan);
+        if (!inserted) {
+            // another thread planned it meanwhile
+            fftw_destroy_plan(plan);
+        }
+        return it->second;
+    }
+
+    // Plans both directions of every size ahead of the first transform, e.g. at startup.
+    void prewarm(const std::vector<std::size_t>& sizes, const std::size_t batch = 1) {
+        for (const auto size : sizes) {
+            get(size, batch, fft_direction::forward);
+            get(size, batch, fft_direction::backward);
+        }
+    }
+
+    std::size_t size() const {
+        const std::lock_guard<std::mutex> lock{_mutex};
+        return _plans.size();
+    }
+
+    // Wisdom file of this CPU and FFTW version, empty without a wisdom directory
+    static std::string wisdom_path(const fft_plan_config& config) {
+        if (config.wisdom_directory.empty()) {
+            return {};
+        }
+        std::string version{fftw_version};
+        std::replace_if(std::begin(version), std::end(version), [](const char c) {
+            return !std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.';
+        }, '_');
+        const std::string name = "fftw-" + detail::cpu_signature() + "-" + version + ".wisdom";
+        return (std::filesystem::path(config.wisdom_directory) / name).string();
+    }
+
+private:
+    using key_type = std::tuple<std::size_t, std::size_t, fft_direction>;
+
+    fft_plan_cache() {
+        fftw_make_planner_thread_safe();
+        if (const char* directory = std::getenv("COMM_FFTW_WISDOM_DIR")) {
+            _config.wisdom_directory = directory;
+        }
+    }
+
+    fftw_plan _make_plan(const key_type& key, const fft_plan_config& config) {
+        const auto [size, batch, direction] = key;
+        const std::string path = wisdom_path(config);
+
+        // FFTW_MEASURE overwrites the arrays it plans on
+        auto scratch = make_fftw_buffer(size * batch);
+        const auto plan_with = [&](const unsigned flags) {
+            const int n[] = {static_cast<int>(size)};
+            const auto distance = static_cast<int>(size);
+            return fftw_plan_many_dft(1, n, static_cast<int>(batch),
+                                      as_fftw(scratch.get()), nullptr, 1, distance,
+                                      as_fftw(scratch.get()), nullptr, 1, distance,
+                                      static_cast<int>(direction), flags);
+        };
+
+        fftw_plan plan = nullptr;
+        if (!path.empty()) {
+            const std::lock_guard<std::mutex> lock{_wisdom_mutex};
+            if (fftw_import_wisdom_from_filename(path.c_str()) != 0) {
+                plan = plan_with(config.flags | FFTW_WISDOM_ONLY);
+            }
+        }
+        if (plan != nullptr) {
+            return plan;
+        }
+        plan = plan_with(config.flags);
+        if (plan == nullptr) {
+            throw std::runtime_error("FFTW could not create the plan");
+        }
+        if (!path.empty()) {
+            const std::lock_guard<std::mutex> lock{_wisdom_mutex};
+            std::error_code error{};
+            std::filesystem::create_directories(config.wisdom_directory, error);
+            // keeps what other processes wrote since the import
+            fftw_import_wisdom_from_filename(path.c_str());
+            if (fftw_export_wisdom_to_filename(path.c_str()) == 0) {
+                std::fprintf(stderr, "could not write FFTW wisdom to %s\n", path.c_str());
+            }
+        }
+        return plan;
+    }
+
+    mutable std::mutex _mutex{};
+    std::mutex _wisdom_mutex{};
+    fft_plan_config _config{};
+    std::map<key_type, fftw_plan> _plans{};
+};
+
+/**
+ * @brief Unnormalized in-place transforms of batch consecutive blocks of size samples.
+ *
+ * data must come from fftw_malloc (e.g. make_fftw_buffer, or complex_signal_seq_t built with
+ * FFTW_COMPLEX_TYPE) so its alignment matches the plan's.
+ */
+inline void fft_in_place(complex_signal_t* data, const std::size_t size, const std::size_t batch, const fft_direction direction) {
+    fftw_plan plan = fft_plan_cache::instance().get(size, batch, direction);
+    fftw_execute_dft(plan, as_fftw(data), as_fftw(data));
+}
+
+}
+
+#endif // INCLUDE_FFT_HPP
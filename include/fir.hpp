@@ -0,0 +1,284 @@
+#ifndef INCLUDE_FIR_HPP
+#define INCLUDE_FIR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "definitions.h"
+#include "fft.hpp"
+#include "psk_kernels.hpp"
+#include "simd.hpp"
+
+namespace comm {
+
+/*
+    FIR filters on complex samples that keep their history between calls, so a long signal
+    filtered chunk by chunk gives the same result as in one call.
+
+    overlap_save_filter convolves in place through FFTs; polyphase_interpolator and
+    polyphase_decimator change the rate with real taps, computing only the outputs kept, as
+    dot products of the taps with the input window.
+*/
+
+namespace detail {
+    // Each tap twice, {h0, h0, h1, h1, ...}, to multiply interleaved samples lane by lane
+    inline std::vector<double> duplicate_taps(const std::vector<double>& taps) {
+        std::vector<double> duplicated(2 * taps.size());
+        for (std::size_t k = 0; k < taps.size(); ++k) {
+            duplicated[2 * k] = taps[k];
+            duplicated[2 * k + 1] = taps[k];
+        }
+        return duplicated;
+    }
+
+    // sum taps[k] * x[k] over n samples, taps duplicated
+    inline complex_signal_t real_taps_dot_scalar(const double* taps, const complex_signal_t* x, const std::size_t n) {
+        const double* in = as_doubles(x);
+        double real{0.0};
+        double imag{0.0};
+        for (std::size_t i = 0; i < 2 * n; i += 2) {
+            real += taps[i] * in[i];
+            imag += taps[i + 1] * in[i + 1];
+        }
+        return {real, imag};
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    complex_signal_t real_taps_dot_avx2(const double* taps, const complex_signal_t* x, const std::size_t n) {
+        const double* in = as_doubles(x);
+        // two accumulators of two samples each hide the latency of the additions
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        std::size_t i = 0;
+        for (; i + 8 <= 2 * n; i += 8) {
+            sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(taps + i), _mm256_loadu_pd(in + i)));
+            sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(taps + i + 4), _mm256_loadu_pd(in + i + 4)));
+        }
+        const __m256d sum = _mm256_add_pd(sum0, sum1);
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+        const complex_signal_t tail = real_taps_dot_scalar(taps + i, x + i / 2, n - i / 2);
+        return {_mm_cvtsd_f64(pair) + tail.real(), _mm_cvtsd_f64(_mm_unpackhi_pd(pair, pair)) + tail.imag()};
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    complex_signal_t real_taps_dot_avx512(const double* taps, const complex_signal_t* x, const std::size_t n) {
+        const double* in = as_doubles(x);
+        __m512d sum0 = _mm512_setzero_pd();
+        __m512d sum1 = _mm512_setzero_pd();
+        std::size_t i = 0;
+        for (; i + 16 <= 2 * n; i += 16) {
+            sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(_mm512_loadu_pd(taps + i), _mm512_loadu_pd(in + i)));
+            sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(_mm512_loadu_pd(taps + i + 8), _mm512_loadu_pd(in + i + 8)));
+        }
+        // through memory: GCC 12 flags the 256-bit extract's placeholder as uninitialized at -O3
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, _mm512_add_pd(sum0, sum1));
+        const complex_signal_t tail = real_taps_dot_avx2(taps + i, x + i / 2, n - i / 2);
+        return {(lanes[0] + lanes[2]) + (lanes[4] + lanes[6]) + tail.real(), (lanes[1] + lanes[3]) + (lanes[5] + lanes[7]) + tail.imag()};
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    using real_taps_dot_t = complex_signal_t (*)(const double*, const complex_signal_t*, std::size_t);
+
+    // The widest kernel the CPU supports, looked up once per call of a filter
+    inline real_taps_dot_t real_taps_dot_kernel() {
+#if COMM_SIMD_X86
+        switch (active_simd_isa()) {
+            case simd_isa::avx512:
+                return real_taps_dot_avx512;
+            case simd_isa::avx2:
+                return real_taps_dot_avx2;
+            default:
+                break;
+        }
+#endif
+        return real_taps_dot_scalar;
+    }
+}
+
+/**
+ * @brief Linear convolution with complex taps by overlap-save, in place.
+ *
+ * The FFT size is the power of two at least four times the number of taps, so each
+ * transform pair yields three quarters or more of its size in outputs.
+ */
+class overlap_save_filter {
+public:
+    explicit overlap_save_filter(const std::vector<complex_signal_t>& taps) {
+        if (taps.empty()) {
+            throw std::invalid_argument("a filter needs at least one tap");
+        }
+        _history.assign(taps.size() - 1, complex_signal_t{});
+        _fft_size = 1;
+        while (_fft_size < 4 * taps.size()) {
+            _fft_size *= 2;
+        }
+        _buffer = make_fftw_buffer(_fft_size);
+        _spectrum = make_fftw_buffer(_fft_size);
+        const double scale = 1 / static_cast<double>(_fft_size);
+        for (std::size_t k = 0; k < taps.size(); ++k) {
+            _spectrum[k] = taps[k] * scale;
+        }
+        fft_in_place(_spectrum.get(), _fft_size, 1, fft_direction::forward);
+    }
+
+    std::size_t fft_size() const noexcept {
+        return _fft_size;
+    }
+
+    void process(complex_signal_t* samples, const std::size_t n) {
+        const std::size_t memory = _history.size();
+        const std::size_t block = _fft_size - memory;
+        complex_signal_t* buffer = _buffer.get();
+        for (std::size_t done = 0; done < n; done += block) {
+            const std::size_t m = std::min(block, n - done);
+            std::copy(std::cbegin(_history), std::cend(_history), buffer);
+            std::copy(samples + done, samples + done + m, buffer + memory);
+            std::fill(buffer + memory + m, buffer + _fft_size, complex_signal_t{});
+            // the outputs overwrite the inputs, so the next block's history is taken now
+            std::copy(buffer + m, buffer + m + memory, std::begin(_history));
+
+            fft_in_place(buffer, _fft_size, 1, fft_direction::forward);
+            for (std::size_t k = 0; k < _fft_size; ++k) {
+                const complex_signal_t a = buffer[k];
+                const complex_signal_t b = _spectrum[k];
+                buffer[k] = {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+            }
+            fft_in_place(buffer, _fft_size, 1, fft_direction::backward);
+            // the first memory outputs wrapped around the circular convolution
+            std::copy(buffer + memory, buffer + memory + m, samples + done);
+        }
+    }
+
+    void reset() {
+        std::fill(std::begin(_history), std::end(_history), complex_signal_t{});
+    }
+
+private:
+    std::vector<complex_signal_t> _history{};
+    std::size_t _fft_size{0};
+    fftw_buffer _buffer{};
+    fftw_buffer _spectrum{};
+};
+
+/**
+ * @brief Upsampling by factor and filtering with real taps, as factor short filters.
+ *
+ * Output n * factor + p is the dot product of the taps p, p + factor, p + 2 factor, ...
+ * with the latest inputs, so the zeros of the upsampled signal are never multiplied.
+ */
+class polyphase_interpolator {
+public:
+    polyphase_interpolator(const std::vector<double>& taps, const std::size_t factor) : _factor(factor) {
+        if (taps.empty() || factor == 0) {
+            throw std::invalid_argument("an interpolator needs taps and a positive factor");
+        }
+        _phase_length = (taps.size() + factor - 1) / factor;
+        // each phase oldest input first, matching the order of the input window
+        std::vector<double> phase(_phase_length);
+        for (std::size_t p = 0; p < factor; ++p) {
+            for (std::size_t k = 0; k < _phase_length; ++k) {
+                const std::size_t tap = k * factor + p;
+                phase[_phase_length - 1 - k] = (tap < taps.size()) ? taps[tap] : 0.0;
+            }
+            const auto duplicated = detail::duplicate_taps(phase);
+            _phases.insert(std::end(_phases), std::cbegin(duplicated), std::cend(duplicated));
+        }
+        _line.assign(_phase_length - 1, complex_signal_t{});
+    }
+
+    std::size_t factor() const noexcept {
+        return _factor;
+    }
+
+    // n inputs give n * factor outputs
+    void process(const complex_signal_t* input, const std::size_t n, complex_signal_t* output) {
+        const std::size_t memory = _phase_length - 1;
+        _line.resize(memory + n);
+        std::copy(input, input + n, std::begin(_line) + static_cast<std::ptrdiff_t>(memory));
+        const auto dot = detail::real_taps_dot_kernel();
+        for (std::size_t i = 0; i < n; ++i) {
+            const complex_signal_t* window = _line.data() + i;
+            for (std::size_t p = 0; p < _factor; ++p) {
+                output[i * _factor + p] = dot(_phases.data() + 2 * p * _phase_length, window, _phase_length);
+            }
+        }
+        std::copy(std::cend(_line) - static_cast<std::ptrdiff_t>(memory), std::cend(_line), std::begin(_line));
+        _line.resize(memory);
+    }
+
+    void reset() {
+        std::fill(std::begin(_line), std::end(_line), complex_signal_t{});
+    }
+
+private:
+    std::size_t _factor;
+    std::size_t _phase_length{0};
+    std::vector<double> _phases{};
+    std::vector<complex_signal_t> _line{};
+};
+
+/**
+ * @brief Filtering with real taps and keeping every factor-th output.
+ *
+ * The filtered signal is y[j] = sum taps[k] x[j - k]; the outputs kept are
+ * y[delay], y[delay + factor], ..., the others are never computed.
+ */
+class polyphase_decimator {
+public:
+    polyphase_decimator(const std::vector<double>& taps, const std::size_t factor, const std::size_t delay = 0)
+        : _factor(factor), _num_of_taps(taps.size()), _delay(delay) {
+        if (taps.empty() || factor == 0) {
+            throw std::invalid_argument("a decimator needs taps and a positive factor");
+        }
+        std::vector<double> reversed(std::crbegin(taps), std::crend(taps));
+        _taps = detail::duplicate_taps(reversed);
+        reset();
+    }
+
+    std::size_t factor() const noexcept {
+        return _factor;
+    }
+
+    // Writes the outputs kept among the next n, at most n / factor + 1, and returns their number.
+    std::size_t process(const complex_signal_t* input, const std::size_t n, complex_signal_t* output) {
+        const std::size_t memory = _num_of_taps - 1;
+        _line.resize(memory + n);
+        std::copy(input, input + n, std::begin(_line) + static_cast<std::ptrdiff_t>(memory));
+        const auto dot = detail::real_taps_dot_kernel();
+        std::size_t num_of_outputs = 0;
+        std::size_t i = _next;
+        for (; i < n; i += _factor) {
+            output[num_of_outputs++] = dot(_taps.data(), _line.data() + i, _num_of_taps);
+        }
+        _next = i - n;
+        std::copy(std::cend(_line) - static_cast<std::ptrdiff_t>(memory), std::cend(_line), std::begin(_line));
+        _line.resize(memory);
+        return num_of_outputs;
+    }
+
+    void reset() {
+        _line.assign(_num_of_taps - 1, complex_signal_t{});
+        _next = _delay;
+    }
+
+private:
+    std::size_t _factor;
+    std::size_t _num_of_taps;
+    std::size_t _delay;
+    std::vector<double> _taps{};
+    std::vector<complex_signal_t> _line{};
+    // index in the next input of the next output kept
+    std::size_t _next{0};
+};
+
+}
+
+#endif // INCLUDE_FIR_HPP
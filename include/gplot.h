@@ -1,12 +1,27 @@
 #ifndef INCLUDE_GPLOT_HPP
 #define INCLUDE_GPLOT_HPP
 
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
+#include <cstdlib>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
-#include <sstream>
-#include <map>
 
+#include <unistd.h>
+
+#include "result_sink.hpp"
+
+/*
+    Plots (x, y) series with gnuplot. The points stream to a float64 file from a background
+    thread as they are added and gnuplot reads the files on plot(), so the data is never
+    formatted as text nor held twice in memory.
+
+    Without gnuplot on the PATH, or with COMM_HEADLESS set, the series are written as CSV
+    files to COMM_PLOT_DIR (default: the working directory) instead.
+*/
 class gplot {
 public:
     enum class type {
@@ -17,20 +32,13 @@ public:
     gplot() : gplot(type::normal) {
     }
 
-    explicit gplot(type t) {
-        if (_gplot == nullptr) {
-            fprintf(stderr, "Failed to run Gnuplot\n");
-            return;
+    explicit gplot(type t) : _type(t) {
+        if (std::getenv("COMM_HEADLESS") == nullptr && _has_gnuplot()) {
+            _gplot = popen("gnuplot --persist", "w");
         }
-        switch (t) {
-            case type::normal:
-                _command.append(_normal);
-                break;
-            case type::semilogy:
-                _command.append(_semilogy);
-                break;
-            default:
-                break;
+        if (_gplot == nullptr) {
+            const char* directory = std::getenv("COMM_PLOT_DIR");
+            _directory = (directory != nullptr) ? directory : ".";
         }
     }
 
@@ -40,87 +48,132 @@ public:
     gplot& operator=(gplot&&) = delete;
 
     ~gplot() {
+        for (auto& s : _series) {
+            s.sink->close();
+        }
         if (_gplot) {
+            // gnuplot has read the files once it exits
             pclose(_gplot);
+            for (const auto& s : _series) {
+                std::remove(s.sink->path().c_str());
+            }
         }
     }
 
-    template<typename T, typename U>
-    bool add_2D_data(const std::string& title, const std::vector<std::pair<T, U>>& data) {
-        if (_gplot == nullptr) {
-            return false;
-        }
+    bool headless() const noexcept {
+        return _gplot == nullptr;
+    }
 
-        if (!_stream.empty()) {
-            _stream[title] << "e\n"; // 34.1.7 Special-filenames, http://www.gnuplot.info/docs_4.2/gnuplot.html#x1-13200034.1.7
+    // A series to append points to as they are produced, plotted by the next plot()
+    comm::series_sink& add_series(const std::string& title) {
+        std::string path{};
+        if (headless()) {
+            path = _directory + "/" + _file_name(title) + comm::file_extension(comm::sink_format::csv);
+        } else {
+            const char* directory = std::getenv("TMPDIR");
+            path = std::string((directory != nullptr) ? directory : "/tmp") + "/gplot-XXXXXX";
+            const int fd = mkstemp(path.data());
+            if (fd >= 0) {
+                ::close(fd);
+            }
         }
-        return _write_to_file(_stream[title], data) == result::success;
+        _series.push_back({title, std::make_unique<comm::series_sink>(path, headless() ? comm::sink_format::csv : comm::sink_format::binary)});
+        return *_series.back().sink;
+    }
+
+    template<typename T, typename U>
+    bool add_2D_data(const std::string& title, const std::vector<std::pair<T, U>>& data) {
+        auto& sink = add_series(title);
+        sink.append(data);
+        return sink.good();
     }
 
     bool plot() {
-        if (_gplot == nullptr) {
+        if (_series.size() == _plotted) {
             return false;
         }
-        if (_stream.empty()) {
-            return false;
+        bool ok = true;
+        for (std::size_t i = _plotted; i < _series.size(); ++i) {
+            ok = _series[i].sink->close() && ok;
         }
-        int32_t counter = 0;
-        for (const auto& [title, _] : _stream) {
-            if (counter > 0) {
-                _command += ',';
+        if (headless()) {
+            for (std::size_t i = _plotted; i < _series.size(); ++i) {
+                fprintf(stderr, "No gnuplot, \"%s\" is in %s\n", _series[i].title.c_str(), _series[i].sink->path().c_str());
             }
-            _command += " '-' with lines title \"" + title + "\"";
-            ++counter;
+            _plotted = _series.size();
+            return ok;
         }
-        _command += '\n';
-        for (const auto& [_, data] : _stream) {
-            _command += data.str();
+
+        std::string command = (_type == type::semilogy) ? _semilogy : _normal;
+        for (std::size_t i = _plotted; i < _series.size(); ++i) {
+            command += (i > _plotted) ? ", '" : " '";
+            command += _series[i].sink->path() + "' binary format='%float64%float64' with lines title " + _quoted(_series[i].title);
         }
-        fprintf(_gplot, "%s\n", _command.c_str());
-        // retrieve command for related type
-        _stream.clear();
-        return true;
+        fprintf(_gplot, "%s\n", command.c_str());
+        fflush(_gplot);
+        _plotted = _series.size();
+        return ok;
     }
 
 private:
-    enum class result {
-        success,
-        failure
+    struct series {
+        std::string title;
+        std::unique_ptr<comm::series_sink> sink;
     };
 
-    template<typename T, typename U>
-    static inline
-    result _write_to_file(std::ostream& ostream, const std::vector<std::pair<T, U>>& data, const char* delimiter = "\n") {
-        constexpr std::size_t maximum_line_size = 1024;
-        std::array<char, maximum_line_size> buf;
-        for (const auto& elem : data) {
-            std::streamsize size = 0;
-            if constexpr (std::is_same_v<T, U> && std::is_same_v<T, double>) {
-                size = std::snprintf(buf.data(), buf.size(), "%f,%f%s", elem.first, elem.second, delimiter);
-            } else {
-                size = std::snprintf(buf.data(), buf.size(), "%d,%d%s", elem.first, elem.second, delimiter);
+    // gnuplot on the PATH, looked up once per program without a shell
+    static bool _has_gnuplot() {
+        static const bool found = []() {
+            const char* path = std::getenv("PATH");
+            const std::string directories = (path != nullptr) ? path : "";
+            for (std::size_t begin = 0; begin <= directories.size();) {
+                const std::size_t end = std::min(directories.find(':', begin), directories.size());
+                const std::string directory = (end > begin) ? directories.substr(begin, end - begin) : std::string(".");
+                if (access((directory + "/gnuplot").c_str(), X_OK) == 0) {
+                    return true;
+                }
+                begin = end + 1;
             }
-            ostream.write(buf.data(), size);
-            if (!ostream.good()) {
-                return result::failure;
+            return false;
+        }();
+        return found;
+    }
+
+    static std::string _file_name(const std::string& title) {
+        std::string name{title};
+        for (auto& c : name) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.') {
+                c = '_';
             }
         }
-        return result::success;
+        return name;
     }
 
-    static constexpr auto _normal = "\nset datafile separator ','\n"
-                                      "set grid\n"
-                                      "plot";
+    // A gnuplot double-quoted string, with the characters it treats as escapes or terminators escaped
+    static std::string _quoted(const std::string& text) {
+        std::string quoted{"\""};
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += (c == '\n') ? std::string("\\n") : std::string(1, c);
+        }
+        return quoted + "\"";
+    }
+
+    static constexpr auto _normal = "\nset grid\n"
+                                    "plot";
 
-    static constexpr auto _semilogy = "\nset datafile separator ','\n"
-                                      "set format y \"10^{%L}\"\n"
+    static constexpr auto _semilogy = "\nset format y \"10^{%L}\"\n"
                                       "set logscale y\n"
                                       "set grid\n"
                                       "plot";
 
-    FILE* _gplot{popen("gnuplot --persist", "w")};
-    std::string _command{};
-    std::map<std::string, std::stringstream, std::less<>> _stream{};
+    type _type;
+    FILE* _gplot{nullptr};
+    std::string _directory{};
+    std::vector<series> _series{};
+    std::size_t _plotted{0};
 };
 
 #endif // INCLUDE_GPLOT_HPP
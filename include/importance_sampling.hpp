@@ -0,0 +1,278 @@
+#ifndef INCLUDE_IMPORTANCE_SAMPLING_HPP
+#define INCLUDE_IMPORTANCE_SAMPLING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ber.hpp"
+#include "definitions.h"
+#include "normal.hpp"
+#include "packed_bits.hpp"
+#include "pipeline.hpp"
+#include "profile.hpp"
+#include "random.hpp"
+#include "statistics.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
+
+namespace comm {
+
+// Likelihood-ratio weighted bit errors of an importance sampling run
+struct weighted_errors {
+    std::size_t num_of_errors{0}; // errors seen under the biased noise, unweighted
+    double weight_sum{0};
+    double weight_square_sum{0};
+
+    weighted_errors& operator+=(const weighted_errors& other) {
+        num_of_errors += other.num_of_errors;
+        weight_sum += other.weight_sum;
+        weight_square_sum += other.weight_square_sum;
+        return *this;
+    }
+};
+
+struct weighted_ber_point {
+    double snr_db{};
+    std::size_t num_of_bits{0};
+    weighted_errors errors{};
+
+    // Unbiased estimate of the BER under the true noise
+    double ber() const {
+        return num_of_bits == 0 ? 0.0 : errors.weight_sum / static_cast<double>(num_of_bits);
+    }
+
+    // Variance of ber(), from the spread of the weights
+    double variance() const {
+        if (num_of_bits < 2) {
+            return 0.0;
+        }
+        const auto n = static_cast<double>(num_of_bits);
+        return std::max(errors.weight_square_sum / n - ber() * ber(), 0.0) / (n - 1);
+    }
+
+    double standard_error() const {
+        return std::sqrt(variance());
+    }
+
+    double relative_error() const {
+        return ber() == 0 ? 0.0 : standard_error() / ber();
+    }
+
+    // Normal approximation, fine once a few hundred errors are in
+    confidence_interval interval(const double confidence = 0.95) const {
+        const double z = normal_quantile(0.5 + confidence / 2);
+        return {std::max(ber() - z * standard_error(), 0.0), ber() + z * standard_error()};
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const weighted_ber_point& point) {
+    const auto interval = point.interval();
+    std::array<char, 192> buf{};
+    (void) std::snprintf(buf.data(), buf.size(), "%6.2f dB  BER %.4e  95%% [%.4e, %.4e]  relative error %.3f  %zu/%zu",
+                         point.snr_db, point.ber(), interval.lower, interval.upper, point.relative_error(),
+                         point.errors.num_of_errors, point.num_of_bits);
+    os << buf.data();
+    return os;
+}
+
+struct importance_sampling_config {
+    // The noise mean moves by -mean_shift times the symbol, 1 puts it on the decision boundary
+    double mean_shift{1.0};
+    // The noise standard deviation is multiplied by this
+    double noise_scale{1.0};
+};
+
+/**
+ * @brief bits -> modulation -> biased AWGN -> demodulation -> weighted error count.
+ *
+ * The noise of symbol s is drawn with mean -mean_shift * s and noise_scale times the
+ * standard deviation, so errors that are rare under the true noise happen in about half
+ * of the symbols. Every error is weighted by the likelihood ratio p(n) / q(n) of its noise
+ * in the dimension that decides the bit: both for BPSK, the real part for the first bit of
+ * a QPSK symbol and the imaginary part for the second. The weighted count divided by the
+ * bits is an unbiased BER estimate. With the mean on the boundary, the bits it needs for
+ * a given relative error grow about linearly with the distance to the boundary in standard
+ * deviations, where plain Monte Carlo needs them to grow as 1 / BER.
+ *
+ * The buffers come from a workspace as those of ber_pipeline.
+ *
+ * @tparam Modem bpsk_modem or qpsk_modem, the same modulate/demodulate as ber_pipeline
+ */
+template<typename Modem>
+class importance_sampling_pipeline {
+    static_assert(std::is_same_v<Modem, bpsk_modem> || std::is_same_v<Modem, qpsk_modem>,
+                  "importance sampling needs to know which dimension decides each bit");
+
+public:
+    static constexpr std::size_t default_block_size = 2048;
+
+    explicit importance_sampling_pipeline(Modem modem = Modem{}, const importance_sampling_config& config = {},
+                                          const std::size_t block_size = default_block_size, workspace& buffers = thread_workspace())
+        : _modem(modem),
+          _config(config),
+          _block_size(std::max<std::size_t>(block_size / _bits_per_block_unit * _bits_per_block_unit, _bits_per_block_unit)),
+          _scope(buffers),
+          _bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _demodulated_bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _symbols(buffers.allocate<complex_signal_t>(_block_size / Modem::bits_per_symbol)),
+          _noise(buffers.allocate<complex_signal_t>(_block_size / Modem::bits_per_symbol)),
+          _log_weights(buffers.allocate<log_weight_pair>(_block_size / Modem::bits_per_symbol)) {
+    }
+
+    std::size_t block_size() const noexcept {
+        return _block_size;
+    }
+
+    // num_of_bits must be a multiple of the bits per symbol
+    weighted_errors run(const std::size_t num_of_bits, const double snr_db, random_stream& generator) {
+        assert(num_of_bits % Modem::bits_per_symbol == 0);
+        COMM_PROFILE_POINT(snr_db);
+        // per dimension, as generate_awgn_noise
+        const double deviation = std::pow(10, -snr_db / 20.0) / std::sqrt(2);
+        weighted_errors result{};
+        for (std::size_t done = 0; done < num_of_bits; done += _block_size) {
+            result += _run_block(std::min(_block_size, num_of_bits - done), deviation, generator);
+        }
+        return result;
+    }
+
+private:
+    static constexpr std::size_t _bits_per_block_unit = packed_bit_seq_t::bits_per_word * Modem::bits_per_symbol;
+
+    // Of the noise in each dimension of a symbol
+    struct log_weight_pair {
+        double real;
+        double imag;
+    };
+
+    weighted_errors _run_block(const std::size_t num_of_bits, const double deviation, random_stream& generator) {
+        const std::size_t num_of_words = packed_bit_seq_t::num_of_words(num_of_bits);
+        const std::size_t num_of_symbols = num_of_bits / Modem::bits_per_symbol;
+        {
+            COMM_PROFILE_STAGE(bits, num_of_bits);
+            generator.generate(_bits, _bits + num_of_words);
+            if (num_of_bits % packed_bit_seq_t::bits_per_word != 0) {
+                _bits[num_of_words - 1] &= (uint64_t{1} << (num_of_bits % packed_bit_seq_t::bits_per_word)) - 1;
+            }
+        }
+        {
+            COMM_PROFILE_STAGE(modulation, num_of_symbols);
+            _modem.modulate(_bits, num_of_bits, _symbols);
+        }
+        {
+            COMM_PROFILE_STAGE(noise, num_of_symbols);
+            generate_normal(generator, _noise, _noise + num_of_symbols);
+        }
+
+        // n = deviation * noise_scale * z + mu, log p(n) / q(n) = log(noise_scale) - n^2 / (2 deviation^2) + z^2 / 2
+        const double scale = deviation * _config.noise_scale;
+        const double log_scale = std::log(_config.noise_scale);
+        const double inverse_variance = 1 / (2 * deviation * deviation);
+        const auto log_weight = [&](const double z, const double n) {
+            return log_scale - n * n * inverse_variance + z * z / 2;
+        };
+        {
+            COMM_PROFILE_STAGE(channel, num_of_symbols);
+            for (std::size_t i = 0; i < num_of_symbols; ++i) {
+                const complex_signal_t z = _noise[i];
+                const double noise_real = scale * z.real() - _config.mean_shift * _symbols[i].real();
+                const double noise_imag = scale * z.imag() - _config.mean_shift * _symbols[i].imag();
+                _log_weights[i] = {log_weight(z.real(), noise_real), log_weight(z.imag(), noise_imag)};
+                _symbols[i] += complex_signal_t(noise_real, noise_imag);
+            }
+        }
+        {
+            COMM_PROFILE_STAGE(demodulation, num_of_symbols);
+            _modem.demodulate(_symbols, num_of_symbols, _demodulated_bits);
+        }
+
+        COMM_PROFILE_STAGE(count_errors, num_of_bits);
+        weighted_errors result{};
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            for (uint64_t errors = _bits[w] ^ _demodulated_bits[w]; errors != 0; errors &= errors - 1) {
+                const std::size_t bit = w * packed_bit_seq_t::bits_per_word + static_cast<std::size_t>(__builtin_ctzll(errors));
+                const auto& log_weights = _log_weights[bit / Modem::bits_per_symbol];
+                double log_w{};
+                if constexpr (Modem::bits_per_symbol == 1) {
+                    log_w = log_weights.real + log_weights.imag;
+                } else {
+                    log_w = (bit % 2 == 0) ? log_weights.real : log_weights.imag;
+                }
+                const double weight = std::exp(log_w);
+                ++result.num_of_errors;
+                result.weight_sum += weight;
+                result.weight_square_sum += weight * weight;
+            }
+        }
+        return result;
+    }
+
+    Modem _modem;
+    importance_sampling_config _config;
+    std::size_t _block_size;
+    workspace::scope _scope;
+    uint64_t* _bits;
+    uint64_t* _demodulated_bits;
+    complex_signal_t* _symbols;
+    complex_signal_t* _noise;
+    log_weight_pair* _log_weights;
+};
+
+namespace detail {
+    // Enough errors and, when asked for, a narrow enough interval relative to the BER
+    inline
+    bool is_done(const adaptive_ber_config& config, const weighted_ber_point& point) {
+        if (point.num_of_bits >= config.max_bits) {
+            return true;
+        }
+        if (point.errors.num_of_errors < config.target_errors) {
+            return false;
+        }
+        return config.target_relative_width <= 0 || point.interval(config.confidence).width() <= config.target_relative_width * point.ber();
+    }
+}
+
+/**
+ * @brief Importance sampling BER of every SNR point, in rounds as simulate_ber_adaptive.
+ *
+ * A point stops once it has config.target_errors (biased) errors and, with
+ * config.target_relative_width set, a confidence interval that narrow relative to its BER,
+ * or once it has used config.max_bits bits. Under importance sampling about half the bits
+ * are errors, so the interval width is the rule that matters. Trial t of point p uses the
+ * same stream as in simulate_ber, so the result depends on the seed alone.
+ *
+ * @tparam Trial callable as weighted_errors(double snr_db, std::size_t num_of_bits, ber_generator_t& generator),
+ *         e.g. importance_sampling_pipeline::run
+ */
+template<typename Trial>
+std::vector<weighted_ber_point> simulate_ber_importance(thread_pool& pool, const std::vector<double>& snr_list, const adaptive_ber_config& config, Trial trial) {
+    std::vector<weighted_ber_point> result(snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        result[point].snr_db = snr_list[point];
+    }
+    detail::run_adaptive_rounds<weighted_errors>(pool, snr_list, config, trial, [&](const std::size_t point) {
+        return detail::is_done(config, result[point]);
+    }, [&](const std::size_t point, const std::size_t num_of_bits, const weighted_errors& errors) {
+        result[point].num_of_bits += num_of_bits;
+        result[point].errors += errors;
+    });
+    return result;
+}
+
+template<typename Trial>
+std::vector<weighted_ber_point> simulate_ber_importance(const std::vector<double>& snr_list, const adaptive_ber_config& config, Trial trial) {
+    thread_pool pool{};
+    return simulate_ber_importance(pool, snr_list, config, trial);
+}
+
+}
+
+#endif // INCLUDE_IMPORTANCE_SAMPLING_HPP
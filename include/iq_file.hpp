@@ -0,0 +1,358 @@
+#ifndef INCLUDE_IQ_FILE_HPP
+#define INCLUDE_IQ_FILE_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "definitions.h"
+#include "sample.hpp"
+
+/*
+    I/Q captures as SigMF recordings: <base>.sigmf-data holds the raw interleaved samples,
+    <base>.sigmf-meta the JSON metadata. complex_signal_t is cf64_le, complex_float_t cf32_le
+    and complex_int16_t ci16_le, in its Q3.12 scale.
+
+    Readers and writers map the data file, so the kernels of psk.hpp and utilities.hpp run
+    on the capture itself through data() with no copy in between.
+*/
+
+namespace comm {
+
+struct iq_metadata {
+    double sample_rate{1.0};
+    // of the first capture segment, in Hz
+    double frequency{0.0};
+    std::string description{};
+};
+
+namespace detail {
+    template<typename Sample>
+    constexpr const char* sigmf_datatype() {
+        static_assert(is_sample_v<Sample>, "complex_signal_t, complex_float_t or complex_int16_t");
+        if constexpr (std::is_same_v<Sample, complex_signal_t>) {
+            return "cf64_le";
+        } else if constexpr (std::is_same_v<Sample, complex_float_t>) {
+            return "cf32_le";
+        } else {
+            return "ci16_le";
+        }
+    }
+
+    inline std::system_error io_error(const std::string& what) {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+    // The raw text after "key": in a flat SigMF metadata file, up to the next , } or ]; empty when the key is missing
+    inline std::string json_value(const std::string& json, const std::string& key) {
+        const auto key_pos = json.find("\"" + key + "\"");
+        if (key_pos == std::string::npos) {
+            return {};
+        }
+        auto pos = key_pos + key.size() + 2;
+        while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) {
+            ++pos;
+        }
+        // a key without its colon is malformed, so it counts as absent
+        if (pos == json.size() || json[pos] != ':') {
+            return {};
+        }
+        ++pos;
+        while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) {
+            ++pos;
+        }
+        if (pos < json.size() && json[pos] == '"') {
+            std::string value{};
+            for (++pos; pos < json.size() && json[pos] != '"'; ++pos) {
+                if (json[pos] == '\\' && pos + 1 < json.size()) {
+                    ++pos;
+                }
+                value += json[pos];
+            }
+            return value;
+        }
+        const auto end = json.find_first_of(",}]\n", pos);
+        return json.substr(pos, end - pos);
+    }
+
+    inline std::string json_escape(const std::string& text) {
+        std::string escaped{};
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += (c == '\n') ? ' ' : c;
+        }
+        return escaped;
+    }
+
+    class file_descriptor {
+    public:
+        explicit file_descriptor(const int fd) : _fd(fd) {
+        }
+
+        file_descriptor(const file_descriptor&) = delete;
+        file_descriptor& operator=(const file_descriptor&) = delete;
+
+        ~file_descriptor() {
+            reset();
+        }
+
+        int get() const noexcept {
+            return _fd;
+        }
+
+        void reset() noexcept {
+            if (_fd >= 0) {
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+
+    private:
+        int _fd;
+    };
+}
+
+inline std::string sigmf_data_path(const std::string& base) {
+    return base + ".sigmf-data";
+}
+
+inline std::string sigmf_meta_path(const std::string& base) {
+    return base + ".sigmf-meta";
+}
+
+/**
+ * @brief Read-only view of a capture, mapped rather than read.
+ *
+ * The pages are read ahead as they are touched, so replaying a capture many times the
+ * size of the memory runs at disk speed. Throws std::system_error if the files cannot be
+ * opened and std::invalid_argument if the capture holds another sample type.
+ */
+template<typename Sample>
+class iq_reader {
+public:
+    explicit iq_reader(const std::string& base) : _fd(::open(sigmf_data_path(base).c_str(), O_RDONLY)) {
+        _read_metadata(base);
+        if (_fd.get() < 0) {
+            throw detail::io_error("cannot open " + sigmf_data_path(base));
+        }
+        struct stat status{};
+        if (::fstat(_fd.get(), &status) != 0) {
+            throw detail::io_error("cannot stat " + sigmf_data_path(base));
+        }
+        const auto bytes = static_cast<std::size_t>(status.st_size);
+        if (bytes % sizeof(Sample) != 0) {
+            throw std::invalid_argument(sigmf_data_path(base) + " does not hold whole " + detail::sigmf_datatype<Sample>() + " samples");
+        }
+        _size = bytes / sizeof(Sample);
+        if (_size != 0) {
+            void* map = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, _fd.get(), 0);
+            if (map == MAP_FAILED) {
+                throw detail::io_error("cannot map " + sigmf_data_path(base));
+            }
+            ::madvise(map, bytes, MADV_SEQUENTIAL);
+            _data = static_cast<const Sample*>(map);
+        }
+    }
+
+    iq_reader(const iq_reader&) = delete;
+    iq_reader& operator=(const iq_reader&) = delete;
+
+    ~iq_reader() {
+        if (_data != nullptr) {
+            ::munmap(const_cast<Sample*>(_data), _size * sizeof(Sample));
+        }
+    }
+
+    const Sample* data() const noexcept {
+        return _data;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    const Sample* begin() const noexcept {
+        return _data;
+    }
+
+    const Sample* end() const noexcept {
+        return _data + _size;
+    }
+
+    const Sample& operator[](const std::size_t i) const noexcept {
+        return _data[i];
+    }
+
+    const iq_metadata& metadata() const noexcept {
+        return _metadata;
+    }
+
+private:
+    void _read_metadata(const std::string& base) {
+        std::ifstream file{sigmf_meta_path(base)};
+        if (!file) {
+            throw detail::io_error("cannot open " + sigmf_meta_path(base));
+        }
+        const std::string json{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        const auto datatype = detail::json_value(json, "core:datatype");
+        if (datatype != detail::sigmf_datatype<Sample>()) {
+            throw std::invalid_argument(base + " holds " + datatype + " samples, not " + detail::sigmf_datatype<Sample>());
+        }
+        const auto sample_rate = detail::json_value(json, "core:sample_rate");
+        const auto frequency = detail::json_value(json, "core:frequency");
+        _metadata.sample_rate = sample_rate.empty() ? 1.0 : std::strtod(sample_rate.c_str(), nullptr);
+        _metadata.frequency = frequency.empty() ? 0.0 : std::strtod(frequency.c_str(), nullptr);
+        _metadata.description = detail::json_value(json, "core:description");
+    }
+
+    detail::file_descriptor _fd;
+    const Sample* _data{nullptr};
+    std::size_t _size{0};
+    iq_metadata _metadata{};
+};
+
+/**
+ * @brief Records a capture by mapping the data file and growing it as samples are added.
+ *
+ * extend() hands out the next samples in the mapped file for a kernel to write into
+ * directly. The file doubles when it fills up, which remaps it, so a pointer from extend()
+ * is valid until the next extend(), append() or close(). close(), also run on destruction,
+ * trims the file to the samples written and writes the metadata.
+ */
+template<typename Sample>
+class iq_writer {
+public:
+    explicit iq_writer(const std::string& base, iq_metadata metadata = {})
+        : _base(base), _metadata(std::move(metadata)), _fd(::open(sigmf_data_path(base).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)) {
+        static_assert(is_sample_v<Sample>, "complex_signal_t, complex_float_t or complex_int16_t");
+        if (_fd.get() < 0) {
+            throw detail::io_error("cannot create " + sigmf_data_path(base));
+        }
+    }
+
+    iq_writer(const iq_writer&) = delete;
+    iq_writer& operator=(const iq_writer&) = delete;
+
+    ~iq_writer() {
+        try {
+            close();
+        } catch (...) {
+            // close() reports errors to callers who want them
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    // n more samples, zero until written
+    Sample* extend(const std::size_t n) {
+        if (_fd.get() < 0) {
+            throw std::logic_error(_base + " is closed");
+        }
+        if (_size + n > _capacity) {
+            _grow(std::max({_size + n, 2 * _capacity, _min_capacity}));
+        }
+        Sample* samples = _data + _size;
+        _size += n;
+        return samples;
+    }
+
+    template<typename InputIterator>
+    void append(const InputIterator first, const InputIterator last) {
+        std::copy(first, last, extend(static_cast<std::size_t>(std::distance(first, last))));
+    }
+
+    void close() {
+        if (_fd.get() < 0) {
+            return;
+        }
+        _unmap();
+        const bool trimmed = ::ftruncate(_fd.get(), static_cast<off_t>(_size * sizeof(Sample))) == 0;
+        _fd.reset();
+        if (!trimmed) {
+            throw detail::io_error("cannot resize " + sigmf_data_path(_base));
+        }
+        _write_metadata();
+    }
+
+private:
+    // 1 MiB of float64 samples
+    static constexpr std::size_t _min_capacity = (1 << 20) / sizeof(complex_signal_t);
+
+    void _grow(const std::size_t capacity) {
+        _unmap();
+        const std::size_t bytes = capacity * sizeof(Sample);
+        if (::ftruncate(_fd.get(), static_cast<off_t>(bytes)) != 0) {
+            throw detail::io_error("cannot resize " + sigmf_data_path(_base));
+        }
+        void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd.get(), 0);
+        if (map == MAP_FAILED) {
+            throw detail::io_error("cannot map " + sigmf_data_path(_base));
+        }
+        _data = static_cast<Sample*>(map);
+        _capacity = capacity;
+    }
+
+    void _unmap() noexcept {
+        if (_data != nullptr) {
+            ::munmap(_data, _capacity * sizeof(Sample));
+            _data = nullptr;
+        }
+    }
+
+    void _write_metadata() const {
+        std::FILE* file = std::fopen(sigmf_meta_path(_base).c_str(), "w");
+        if (file == nullptr) {
+            throw detail::io_error("cannot create " + sigmf_meta_path(_base));
+        }
+        std::fprintf(file,
+                     "{\n"
+                     "    \"global\": {\n"
+                     "        \"core:datatype\": \"%s\",\n"
+                     "        \"core:sample_rate\": %.17g,\n"
+                     "        \"core:version\": \"1.0.0\",\n"
+                     "        \"core:description\": \"%s\"\n"
+                     "    },\n"
+                     "    \"captures\": [\n"
+                     "        {\n"
+                     "            \"core:sample_start\": 0,\n"
+                     "            \"core:frequency\": %.17g\n"
+                     "        }\n"
+                     "    ],\n"
+                     "    \"annotations\": []\n"
+                     "}\n",
+                     detail::sigmf_datatype<Sample>(), _metadata.sample_rate, detail::json_escape(_metadata.description).c_str(), _metadata.frequency);
+        if (std::fclose(file) != 0) {
+            throw detail::io_error("cannot write " + sigmf_meta_path(_base));
+        }
+    }
+
+    std::string _base;
+    iq_metadata _metadata;
+    detail::file_descriptor _fd;
+    Sample* _data{nullptr};
+    std::size_t _size{0};
+    std::size_t _capacity{0};
+};
+
+}
+
+#endif // INCLUDE_IQ_FILE_HPP
@@ -0,0 +1,347 @@
+#ifndef INCLUDE_LLR_HPP
+#define INCLUDE_LLR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "constellation.hpp"
+#include "definitions.h"
+#include "simd.hpp"
+#include "workspace.hpp"
+
+namespace comm {
+
+/*
+    Log-likelihood ratios ln P(b = 0 | y) / P(b = 1 | y), positive when 0 is the likelier bit,
+    one per bit in the order of the hard demodulators. noise_variance is N0 = E|n|^2 of the
+    complex noise, with unit symbol energy that is 10^(-snr_db / 10).
+*/
+
+enum class llr_mode {
+    // differences of the nearest points of each bit value
+    max_log,
+    // log-sum-exp over all points
+    exact,
+};
+
+inline double noise_variance_of(const double snr_db) {
+    return std::pow(10, -snr_db / 10.0);
+}
+
+namespace detail {
+namespace fast_exp {
+    /*
+        exp(x) = 2^k exp(r), k = round(x / ln 2), |r| <= ln 2 / 2, with ln 2 split in two so
+        that r is exact and a degree 12 Taylor polynomial for exp(r), relative error below 1e-15.
+        Inputs below min_input give 0, the kernels only see x <= 0.
+    */
+    struct constants {
+        static constexpr double log2e = 1.4426950408889634074;
+        static constexpr double ln2_hi = 6.93147180369123816490e-01;
+        static constexpr double ln2_lo = 1.90821492927058770002e-10;
+        static constexpr double min_input = -708.0;
+        static constexpr double coefficients[] = {
+            1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880, 1.0 / 40320, 1.0 / 5040,
+            1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 1.0 / 2, 1.0, 1.0,
+        };
+    };
+
+    inline double exp_scalar(const double x) {
+        using c = constants;
+        if (!(x >= c::min_input)) {
+            return 0.0;
+        }
+        const double k = std::nearbyint(x * c::log2e);
+        const double r = (x - k * c::ln2_hi) - k * c::ln2_lo;
+        double p = c::coefficients[0];
+        for (std::size_t i = 1; i < std::size(c::coefficients); ++i) {
+            p = p * r + c::coefficients[i];
+        }
+        const auto bits = static_cast<uint64_t>(static_cast<int64_t>(k) + 1023) << 52U;
+        double scale{};
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+    inline void exp_scalar(const double* in, const std::size_t n, double* out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = exp_scalar(in[i]);
+        }
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void exp_avx2(const double* in, const std::size_t n, double* out) {
+        using c = constants;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d x = _mm256_loadu_pd(in + i);
+            const __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(c::log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(c::ln2_hi))), _mm256_mul_pd(k, _mm256_set1_pd(c::ln2_lo)));
+            __m256d p = _mm256_set1_pd(c::coefficients[0]);
+            for (std::size_t j = 1; j < std::size(c::coefficients); ++j) {
+                p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c::coefficients[j]));
+            }
+            const __m256i exponent = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k)), _mm256_set1_epi64x(1023));
+            const __m256d result = _mm256_mul_pd(p, _mm256_castsi256_pd(_mm256_slli_epi64(exponent, 52)));
+            const __m256d in_range = _mm256_cmp_pd(x, _mm256_set1_pd(c::min_input), _CMP_GE_OQ);
+            _mm256_storeu_pd(out + i, _mm256_and_pd(result, in_range));
+        }
+        exp_scalar(in + i, n - i, out + i);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void exp_avx512(const double* in, const std::size_t n, double* out) {
+        using c = constants;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512d x = _mm512_loadu_pd(in + i);
+            const __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(c::log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m512d r = _mm512_sub_pd(_mm512_sub_pd(x, _mm512_mul_pd(k, _mm512_set1_pd(c::ln2_hi))), _mm512_mul_pd(k, _mm512_set1_pd(c::ln2_lo)));
+            __m512d p = _mm512_set1_pd(c::coefficients[0]);
+            for (std::size_t j = 1; j < std::size(c::coefficients); ++j) {
+                p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c::coefficients[j]));
+            }
+            const __m512i exponent = _mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(k)), _mm512_set1_epi64(1023));
+            const __m512d result = _mm512_mul_pd(p, _mm512_castsi512_pd(_mm512_slli_epi64(exponent, 52)));
+            const __mmask8 in_range = _mm512_cmp_pd_mask(x, _mm512_set1_pd(c::min_input), _CMP_GE_OQ);
+            _mm512_storeu_pd(out + i, _mm512_maskz_mov_pd(in_range, result));
+        }
+        exp_scalar(in + i, n - i, out + i);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    // exp of n values, x <= 0
+    inline void exp(const double* in, const std::size_t n, double* out) {
+#if COMM_SIMD_X86
+        switch (active_simd_isa()) {
+            case simd_isa::avx512:
+                exp_avx512(in, n, out);
+                return;
+            case simd_isa::avx2:
+                exp_avx2(in, n, out);
+                return;
+            default:
+                break;
+        }
+#endif
+        exp_scalar(in, n, out);
+    }
+}
+
+    template<typename Constellation>
+    struct is_qam : std::false_type {};
+
+    template<std::size_t M>
+    struct is_qam<qam_constellation<M>> : std::true_type {};
+
+    // Points per row of metrics, see below
+    template<typename Constellation>
+    constexpr std::size_t llr_points_per_row() {
+        if constexpr (is_qam<Constellation>::value) {
+            return Constellation::levels_per_axis;
+        } else {
+            return Constellation::order;
+        }
+    }
+
+    /*
+        The LLRs come from rows of metrics -d^2 / N0, one per label of a row's points: a
+        whole PSK symbol, or one axis of a QAM symbol whose likelihood factors per axis.
+        Rows are processed a block at a time so that the exact mode runs one vector exp
+        over the whole block. The metrics of a block, and their exps in the exact mode, come
+        from the thread's workspace; rows of many points get fewer rows per block.
+    */
+    constexpr std::size_t llr_rows_per_block = 128;
+    constexpr std::size_t llr_metrics_per_block = 4096;
+
+    inline void metrics_to_llr_max_log(const double* metrics, const std::size_t num_of_points, const std::size_t num_of_bits, double* llrs) {
+        for (std::size_t j = 0; j < num_of_bits; ++j) {
+            double best[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+            for (std::size_t label = 0; label < num_of_points; ++label) {
+                const auto bit = (label >> j) & 1U;
+                best[bit] = std::max(best[bit], metrics[label]);
+            }
+            llrs[j] = best[0] - best[1];
+        }
+    }
+
+    // exps are exp(metrics - row maximum); a set whose sum underflows falls back to its max-log term
+    inline void metrics_to_llr_exact(const double* shifted, const double* exps, const std::size_t num_of_points, const std::size_t num_of_bits, double* llrs) {
+        for (std::size_t j = 0; j < num_of_bits; ++j) {
+            double sum[2] = {0, 0};
+            double best[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+            for (std::size_t label = 0; label < num_of_points; ++label) {
+                const auto bit = (label >> j) & 1U;
+                sum[bit] += exps[label];
+                best[bit] = std::max(best[bit], shifted[label]);
+            }
+            const bool normal0 = sum[0] >= std::numeric_limits<double>::min();
+            const bool normal1 = sum[1] >= std::numeric_limits<double>::min();
+            if (normal0 && normal1) {
+                llrs[j] = std::log(sum[0] / sum[1]);
+            } else {
+                llrs[j] = (normal0 ? std::log(sum[0]) : best[0]) - (normal1 ? std::log(sum[1]) : best[1]);
+            }
+        }
+    }
+
+    // metrics[row * num_of_points + label], llrs[row * num_of_bits + j]
+    inline void rows_to_llr(double* metrics, double* exps, const std::size_t num_of_rows, const std::size_t num_of_points,
+                            const std::size_t num_of_bits, const llr_mode mode, double* llrs) {
+        if (mode == llr_mode::max_log) {
+            for (std::size_t row = 0; row < num_of_rows; ++row) {
+                metrics_to_llr_max_log(metrics + row * num_of_points, num_of_points, num_of_bits, llrs + row * num_of_bits);
+            }
+            return;
+        }
+        for (std::size_t row = 0; row < num_of_rows; ++row) {
+            double* m = metrics + row * num_of_points;
+            const double top = *std::max_element(m, m + num_of_points);
+            for (std::size_t label = 0; label < num_of_points; ++label) {
+                m[label] -= top;
+            }
+        }
+        fast_exp::exp(metrics, num_of_rows * num_of_points, exps);
+        for (std::size_t row = 0; row < num_of_rows; ++row) {
+            metrics_to_llr_exact(metrics + row * num_of_points, exps + row * num_of_points, num_of_points, num_of_bits, llrs + row * num_of_bits);
+        }
+    }
+}
+
+/**
+ * @brief LLRs of BPSK symbols from bpsk_modulation with the same offset, exact and max-log alike.
+ */
+inline
+void bpsk_llr(const complex_signal_t* input_begin, const complex_signal_t* input_end, const double noise_variance, double* output_begin, double offset = 0) {
+    const auto c = std::cos(offset);
+    const auto s = std::sin(offset);
+    const double gain = -4.0 / noise_variance;
+    const std::size_t n = static_cast<std::size_t>(input_end - input_begin);
+    for (std::size_t i = 0; i < n; ++i) {
+        output_begin[i] = gain * (input_begin[i].imag() * s + input_begin[i].real() * c);
+    }
+}
+
+/**
+ * @brief LLRs of QPSK symbols from qpsk_modulation, two per symbol, exact and max-log alike.
+ */
+inline
+void qpsk_llr(const complex_signal_t* input_begin, const complex_signal_t* input_end, const double noise_variance, double* output_begin) {
+    const double gain = 4.0 / std::sqrt(2) / noise_variance;
+    const double* in = reinterpret_cast<const double*>(input_begin);
+    const std::size_t n = 2 * static_cast<std::size_t>(input_end - input_begin);
+    for (std::size_t i = 0; i < n; ++i) {
+        output_begin[i] = gain * in[i];
+    }
+}
+
+inline
+std::vector<double> bpsk_llr(const complex_signal_seq_t& symbols, const double noise_variance, double offset = 0) {
+    std::vector<double> llrs(symbols.size());
+    bpsk_llr(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data(), offset);
+    return llrs;
+}
+
+inline
+std::vector<double> qpsk_llr(const complex_signal_seq_t& symbols, const double noise_variance) {
+    std::vector<double> llrs(symbols.size() * 2);
+    qpsk_llr(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data());
+    return llrs;
+}
+
+/**
+ * @brief LLRs of any constellation, bits_per_symbol per symbol.
+ *
+ * Square QAM works per axis, sqrt(M) distances per axis instead of M per symbol.
+ *
+ * @tparam Constellation psk_constellation<M> or qam_constellation<M>
+ */
+template<typename Constellation>
+void llr_demodulation(const complex_signal_t* input_begin, const complex_signal_t* input_end, const double noise_variance,
+                      double* output_begin, const llr_mode mode = llr_mode::max_log) {
+    constexpr bool per_axis = detail::is_qam<Constellation>::value;
+    constexpr std::size_t num_of_points = detail::llr_points_per_row<Constellation>();
+    constexpr std::size_t rows_per_symbol = per_axis ? 2 : 1;
+    constexpr std::size_t bits_per_row = Constellation::bits_per_symbol / rows_per_symbol;
+    constexpr std::size_t symbols_per_block = std::max<std::size_t>(
+        std::min(detail::llr_rows_per_block, detail::llr_metrics_per_block / num_of_points) / rows_per_symbol, 1);
+
+    const double inverse = 1.0 / noise_variance;
+    constexpr std::size_t metrics_per_block = symbols_per_block * rows_per_symbol * num_of_points;
+    auto& buffers = thread_workspace();
+    const workspace::scope scope{buffers};
+    double* metrics = buffers.allocate<double>(metrics_per_block);
+    double* exps = (mode == llr_mode::exact) ? buffers.allocate<double>(metrics_per_block) : nullptr;
+    for (; input_begin < input_end; input_begin += symbols_per_block) {
+        const auto num_of_symbols = std::min<std::size_t>(symbols_per_block, static_cast<std::size_t>(input_end - input_begin));
+        for (std::size_t i = 0; i < num_of_symbols; ++i) {
+            double* m = metrics + i * rows_per_symbol * num_of_points;
+            if constexpr (per_axis) {
+                // row 2 i is the in-phase axis, the low half of the label
+                for (std::size_t label = 0; label < num_of_points; ++label) {
+                    const double re = input_begin[i].real() - Constellation::axis_levels[label];
+                    const double im = input_begin[i].imag() - Constellation::axis_levels[label];
+                    m[label] = -re * re * inverse;
+                    m[num_of_points + label] = -im * im * inverse;
+                }
+            } else {
+                for (std::size_t label = 0; label < num_of_points; ++label) {
+                    const double re = input_begin[i].real() - Constellation::points[label].real();
+                    const double im = input_begin[i].imag() - Constellation::points[label].imag();
+                    m[label] = -(re * re + im * im) * inverse;
+                }
+            }
+        }
+        detail::rows_to_llr(metrics, exps, num_of_symbols * rows_per_symbol, num_of_points, bits_per_row, mode, output_begin);
+        output_begin += num_of_symbols * Constellation::bits_per_symbol;
+    }
+}
+
+template<typename Constellation>
+std::vector<double> llr_demodulation(const complex_signal_seq_t& symbols, const double noise_variance, const llr_mode mode = llr_mode::max_log) {
+    std::vector<double> llrs(symbols.size() * Constellation::bits_per_symbol);
+    llr_demodulation<Constellation>(symbols.data(), symbols.data() + symbols.size(), noise_variance, llrs.data(), mode);
+    return llrs;
+}
+
+/**
+ * @brief Round scale * llr to a signed integer, saturating symmetrically at +-max; NaN becomes 0.
+ *
+ * @tparam Int int8_t or int16_t for compact storage of decoder inputs, at most int32_t
+ */
+template<typename Int>
+void quantize_llr(const double* input_begin, const double* input_end, const double scale, Int* output_begin) {
+    static_assert(std::is_integral_v<Int> && std::is_signed_v<Int>, "LLRs quantize to signed integers");
+    // the rounding goes through int32_t
+    static_assert(sizeof(Int) <= sizeof(int32_t), "LLRs quantize to at most 32 bits");
+    constexpr double limit = std::numeric_limits<Int>::max();
+    for (; input_begin != input_end; ++input_begin, ++output_begin) {
+        double value = *input_begin * scale;
+        value = (value == value) ? value : 0.0;
+        value = std::min(std::max(value, -limit), limit);
+        // branch free so that the loop vectorizes
+        *output_begin = static_cast<Int>(static_cast<int32_t>(value + std::copysign(0.5, value)));
+    }
+}
+
+template<typename Int>
+std::vector<Int> quantize_llr(const std::vector<double>& llrs, const double scale) {
+    std::vector<Int> quantized(llrs.size());
+    quantize_llr(llrs.data(), llrs.data() + llrs.size(), scale, quantized.data());
+    return quantized;
+}
+
+}
+
+#endif // INCLUDE_LLR_HPP
@@ -0,0 +1,409 @@
+#ifndef INCLUDE_NORMAL_HPP
+#define INCLUDE_NORMAL_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "definitions.h"
+#include "random.hpp"
+#include "simd.hpp"
+
+namespace comm {
+namespace detail {
+    /*
+        Box-Muller on Philox blocks. Block b of the stream gives the pair b of normals:
+            u1 in (0, 1] from the first word, u2 in [0, 1) from the second,
+            (r cos(2 pi u2), r sin(2 pi u2)) with r = sqrt(-2 ln(u1)).
+        ln, sin and cos are the fdlibm polynomials, evaluated in the same order by the
+        scalar and the SIMD kernels, so every kernel gives the same numbers.
+    */
+    namespace box_muller {
+        constexpr uint64_t one_bits = 0x3FF0000000000000ULL;
+        constexpr uint64_t mantissa_mask = 0x000FFFFFFFFFFFFFULL;
+        constexpr uint64_t magic_bits = 0x4330000000000000ULL; // 2^52, turns a small integer into a double
+        constexpr double magic = 4503599627370496.0;
+        constexpr double exponent_bias = 1023.0;
+        constexpr double sqrt2 = 1.41421356237309504880;
+        constexpr double ln2_hi = 6.93147180369123816490e-01;
+        constexpr double ln2_lo = 1.90821492927058770002e-10;
+        constexpr double lg1 = 6.666666666666735130e-01;
+        constexpr double lg2 = 3.999999999940941908e-01;
+        constexpr double lg3 = 2.857142874366239149e-01;
+        constexpr double lg4 = 2.222219843214978396e-01;
+        constexpr double lg5 = 1.818357216161805012e-01;
+        constexpr double lg6 = 1.531383769920937332e-01;
+        constexpr double lg7 = 1.479819860511658591e-01;
+        constexpr double half_pi = 1.57079632679489661923;
+        constexpr double s1 = -1.66666666666666324348e-01;
+        constexpr double s2 = 8.33333333332248946124e-03;
+        constexpr double s3 = -1.98412698298579493134e-04;
+        constexpr double s4 = 2.75573137070700676789e-06;
+        constexpr double s5 = -2.50507602534068634195e-08;
+        constexpr double s6 = 1.58969099521155010221e-10;
+        constexpr double c1 = 4.16666666666666019037e-02;
+        constexpr double c2 = -1.38888888888741095749e-03;
+        constexpr double c3 = 2.48015872894767294178e-05;
+        constexpr double c4 = -2.75573143513906633035e-07;
+        constexpr double c5 = 2.08757232129817482790e-09;
+        constexpr double c6 = -1.13596475577881948265e-11;
+
+        inline double from_bits(const uint64_t bits) {
+            double value{};
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t to_bits(const double value) {
+            uint64_t bits{};
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        // ln(x) for x in (0, 1]
+        inline double log(const double x) {
+            const uint64_t bits = to_bits(x);
+            double e = static_cast<double>(bits >> 52U) - exponent_bias;
+            double m = from_bits((bits & mantissa_mask) | one_bits);
+            if (m > sqrt2) {
+                m = m * 0.5;
+                e = e + 1.0;
+            }
+            const double f = m - 1.0;
+            const double s = f / (2.0 + f);
+            const double z = s * s;
+            const double r = z * (lg1 + z * (lg2 + z * (lg3 + z * (lg4 + z * (lg5 + z * (lg6 + z * lg7))))));
+            const double log_m = f - s * (f - r);
+            return e * ln2_hi + (log_m + e * ln2_lo);
+        }
+
+        // sin(2 pi u) and cos(2 pi u) for u in [0, 1)
+        inline void sincos(const double u, double& sin_value, double& cos_value) {
+            const double t = 4.0 * u;
+            const double k = std::nearbyint(t);
+            const double x = (t - k) * half_pi;
+            const double z = x * x;
+            const double sin_x = x + (x * z) * (s1 + z * (s2 + z * (s3 + z * (s4 + z * (s5 + z * s6)))));
+            const double cos_x = (1.0 - 0.5 * z) + (z * z) * (c1 + z * (c2 + z * (c3 + z * (c4 + z * (c5 + z * c6)))));
+            // rotate by k quarter turns
+            const double q = k - 4.0 * std::floor(k * 0.25);
+            const bool swap = (q == 1.0) || (q == 3.0);
+            cos_value = swap ? sin_x : cos_x;
+            sin_value = swap ? cos_x : sin_x;
+            if ((q == 1.0) || (q == 2.0)) {
+                cos_value = -cos_value;
+            }
+            if (q >= 2.0) {
+                sin_value = -sin_value;
+            }
+        }
+    }
+
+    // Pair i to out[2 i] and out[2 i + 1], or with imag to out[i] and imag[i]
+    inline
+    void normal_pairs_scalar(const uint64_t seed, const uint64_t stream_id, const uint64_t first_block,
+                             double* out, const std::size_t num_of_pairs, const double scale, double* imag = nullptr) {
+        for (std::size_t i = 0; i < num_of_pairs; ++i) {
+            const auto words = random_stream::block(seed, stream_id, first_block + i);
+            const double u1 = 2.0 - box_muller::from_bits((words[0] >> 12U) | box_muller::one_bits);
+            const double u2 = box_muller::from_bits((words[1] >> 12U) | box_muller::one_bits) - 1.0;
+            const double r = std::sqrt(-2.0 * box_muller::log(u1)) * scale;
+            double sin_value{};
+            double cos_value{};
+            box_muller::sincos(u2, sin_value, cos_value);
+            if (imag != nullptr) {
+                out[i] = r * cos_value;
+                imag[i] = r * sin_value;
+            } else {
+                out[2 * i] = r * cos_value;
+                out[2 * i + 1] = r * sin_value;
+            }
+        }
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void normal_pairs_avx2(const uint64_t seed, const uint64_t stream_id, const uint64_t first_block,
+                           double* out, const std::size_t num_of_pairs, const double scale, double* imag = nullptr) {
+        namespace bm = box_muller;
+        constexpr std::size_t lanes = 4;
+        const __m256i low = _mm256_set1_epi64x(0xFFFFFFFFLL);
+        const __m256i m0 = _mm256_set1_epi64x(0xD2511F53LL);
+        const __m256i m1 = _mm256_set1_epi64x(0xCD9E8D57LL);
+        const __m256i stream_lo = _mm256_set1_epi64x(static_cast<int64_t>(stream_id & 0xFFFFFFFFULL));
+        const __m256i stream_hi = _mm256_set1_epi64x(static_cast<int64_t>(stream_id >> 32U));
+        const __m256i one_bits = _mm256_set1_epi64x(static_cast<int64_t>(bm::one_bits));
+        const __m256i mantissa_mask = _mm256_set1_epi64x(static_cast<int64_t>(bm::mantissa_mask));
+        const __m256i magic_bits = _mm256_set1_epi64x(static_cast<int64_t>(bm::magic_bits));
+        const __m256d sign = _mm256_set1_pd(-0.0);
+
+        std::size_t i = 0;
+        for (; i + lanes <= num_of_pairs; i += lanes) {
+            // Philox4x32-10 on four consecutive blocks, one 32-bit word per 64-bit lane
+            const __m256i block = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<int64_t>(first_block + i)), _mm256_set_epi64x(3, 2, 1, 0));
+            __m256i x0 = _mm256_and_si256(block, low);
+            __m256i x1 = _mm256_srli_epi64(block, 32);
+            __m256i x2 = stream_lo;
+            __m256i x3 = stream_hi;
+            uint32_t k0 = static_cast<uint32_t>(seed);
+            uint32_t k1 = static_cast<uint32_t>(seed >> 32U);
+            for (int32_t round = 0; round < 10; ++round) {
+                if (round > 0) {
+                    k0 += 0x9E3779B9U;
+                    k1 += 0xBB67AE85U;
+                }
+                const __m256i product0 = _mm256_mul_epu32(x0, m0);
+                const __m256i product1 = _mm256_mul_epu32(x2, m1);
+                x0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(product1, 32), x1), _mm256_set1_epi64x(k0));
+                x1 = _mm256_and_si256(product1, low);
+                x2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(product0, 32), x3), _mm256_set1_epi64x(k1));
+                x3 = _mm256_and_si256(product0, low);
+            }
+            const __m256i word0 = _mm256_or_si256(_mm256_slli_epi64(x1, 32), x0);
+            const __m256i word1 = _mm256_or_si256(_mm256_slli_epi64(x3, 32), x2);
+            const __m256d u1 = _mm256_sub_pd(_mm256_set1_pd(2.0), _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(word0, 12), one_bits)));
+            const __m256d u2 = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(word1, 12), one_bits)), _mm256_set1_pd(1.0));
+
+            // ln(u1)
+            const __m256i bits = _mm256_castpd_si256(u1);
+            __m256d e = _mm256_sub_pd(_mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), magic_bits)), _mm256_set1_pd(bm::magic)), _mm256_set1_pd(bm::exponent_bias));
+            __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissa_mask), one_bits));
+            const __m256d above = _mm256_cmp_pd(m, _mm256_set1_pd(bm::sqrt2), _CMP_GT_OQ);
+            m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), above);
+            e = _mm256_add_pd(e, _mm256_and_pd(above, _mm256_set1_pd(1.0)));
+            const __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+            const __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+            const __m256d z = _mm256_mul_pd(s, s);
+            __m256d r = _mm256_add_pd(_mm256_set1_pd(bm::lg6), _mm256_mul_pd(z, _mm256_set1_pd(bm::lg7)));
+            r = _mm256_add_pd(_mm256_set1_pd(bm::lg5), _mm256_mul_pd(z, r));
+            r = _mm256_add_pd(_mm256_set1_pd(bm::lg4), _mm256_mul_pd(z, r));
+            r = _mm256_add_pd(_mm256_set1_pd(bm::lg3), _mm256_mul_pd(z, r));
+            r = _mm256_add_pd(_mm256_set1_pd(bm::lg2), _mm256_mul_pd(z, r));
+            r = _mm256_add_pd(_mm256_set1_pd(bm::lg1), _mm256_mul_pd(z, r));
+            r = _mm256_mul_pd(z, r);
+            const __m256d log_m = _mm256_sub_pd(f, _mm256_mul_pd(s, _mm256_sub_pd(f, r)));
+            const __m256d log_u1 = _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(bm::ln2_hi)), _mm256_add_pd(log_m, _mm256_mul_pd(e, _mm256_set1_pd(bm::ln2_lo))));
+            const __m256d radius = _mm256_mul_pd(_mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), log_u1)), _mm256_set1_pd(scale));
+
+            // sin(2 pi u2), cos(2 pi u2)
+            const __m256d t = _mm256_mul_pd(_mm256_set1_pd(4.0), u2);
+            const __m256d k = _mm256_round_pd(t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m256d x = _mm256_mul_pd(_mm256_sub_pd(t, k), _mm256_set1_pd(bm::half_pi));
+            const __m256d zz = _mm256_mul_pd(x, x);
+            __m256d ps = _mm256_add_pd(_mm256_set1_pd(bm::s5), _mm256_mul_pd(zz, _mm256_set1_pd(bm::s6)));
+            ps = _mm256_add_pd(_mm256_set1_pd(bm::s4), _mm256_mul_pd(zz, ps));
+            ps = _mm256_add_pd(_mm256_set1_pd(bm::s3), _mm256_mul_pd(zz, ps));
+            ps = _mm256_add_pd(_mm256_set1_pd(bm::s2), _mm256_mul_pd(zz, ps));
+            ps = _mm256_add_pd(_mm256_set1_pd(bm::s1), _mm256_mul_pd(zz, ps));
+            const __m256d sin_x = _mm256_add_pd(x, _mm256_mul_pd(_mm256_mul_pd(x, zz), ps));
+            __m256d pc = _mm256_add_pd(_mm256_set1_pd(bm::c5), _mm256_mul_pd(zz, _mm256_set1_pd(bm::c6)));
+            pc = _mm256_add_pd(_mm256_set1_pd(bm::c4), _mm256_mul_pd(zz, pc));
+            pc = _mm256_add_pd(_mm256_set1_pd(bm::c3), _mm256_mul_pd(zz, pc));
+            pc = _mm256_add_pd(_mm256_set1_pd(bm::c2), _mm256_mul_pd(zz, pc));
+            pc = _mm256_add_pd(_mm256_set1_pd(bm::c1), _mm256_mul_pd(zz, pc));
+            const __m256d cos_x = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(0.5), zz)), _mm256_mul_pd(_mm256_mul_pd(zz, zz), pc));
+            const __m256d q = _mm256_sub_pd(k, _mm256_mul_pd(_mm256_set1_pd(4.0), _mm256_floor_pd(_mm256_mul_pd(k, _mm256_set1_pd(0.25)))));
+            const __m256d q1 = _mm256_cmp_pd(q, _mm256_set1_pd(1.0), _CMP_EQ_OQ);
+            const __m256d q2 = _mm256_cmp_pd(q, _mm256_set1_pd(2.0), _CMP_EQ_OQ);
+            const __m256d q3 = _mm256_cmp_pd(q, _mm256_set1_pd(3.0), _CMP_EQ_OQ);
+            const __m256d swap = _mm256_or_pd(q1, q3);
+            __m256d cos_value = _mm256_blendv_pd(cos_x, sin_x, swap);
+            __m256d sin_value = _mm256_blendv_pd(sin_x, cos_x, swap);
+            cos_value = _mm256_xor_pd(cos_value, _mm256_and_pd(_mm256_or_pd(q1, q2), sign));
+            sin_value = _mm256_xor_pd(sin_value, _mm256_and_pd(_mm256_or_pd(q2, q3), sign));
+
+            const __m256d re = _mm256_mul_pd(radius, cos_value);
+            const __m256d im = _mm256_mul_pd(radius, sin_value);
+            if (imag != nullptr) {
+                _mm256_storeu_pd(out + i, re);
+                _mm256_storeu_pd(imag + i, im);
+                continue;
+            }
+            // interleave (re0 re1 re2 re3), (im0 im1 im2 im3) -> re0 im0 re1 im1 ...
+            const __m256d lo = _mm256_unpacklo_pd(re, im);
+            const __m256d hi = _mm256_unpackhi_pd(re, im);
+            _mm256_storeu_pd(out + 2 * i, _mm256_permute2f128_pd(lo, hi, 0x20));
+            _mm256_storeu_pd(out + 2 * i + lanes, _mm256_permute2f128_pd(lo, hi, 0x31));
+        }
+        if (imag != nullptr) {
+            normal_pairs_scalar(seed, stream_id, first_block + i, out + i, num_of_pairs - i, scale, imag + i);
+        } else {
+            normal_pairs_scalar(seed, stream_id, first_block + i, out + 2 * i, num_of_pairs - i, scale);
+        }
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+    COMM_TARGET_AVX512 inline
+    void normal_pairs_avx512(const uint64_t seed, const uint64_t stream_id, const uint64_t first_block,
+                             double* out, const std::size_t num_of_pairs, const double scale, double* imag = nullptr) {
+        namespace bm = box_muller;
+        constexpr std::size_t lanes = 8;
+        const __m512i low = _mm512_set1_epi64(0xFFFFFFFFLL);
+        const __m512i m0 = _mm512_set1_epi64(0xD2511F53LL);
+        const __m512i m1 = _mm512_set1_epi64(0xCD9E8D57LL);
+        const __m512i stream_lo = _mm512_set1_epi64(static_cast<int64_t>(stream_id & 0xFFFFFFFFULL));
+        const __m512i stream_hi = _mm512_set1_epi64(static_cast<int64_t>(stream_id >> 32U));
+        const __m512i one_bits = _mm512_set1_epi64(static_cast<int64_t>(bm::one_bits));
+        const __m512i mantissa_mask = _mm512_set1_epi64(static_cast<int64_t>(bm::mantissa_mask));
+        const __m512i magic_bits = _mm512_set1_epi64(static_cast<int64_t>(bm::magic_bits));
+        const __m512d sign = _mm512_set1_pd(-0.0);
+        const __m512i first_half = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+        const __m512i second_half = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+
+        std::size_t i = 0;
+        for (; i + lanes <= num_of_pairs; i += lanes) {
+            const __m512i block = _mm512_add_epi64(_mm512_set1_epi64(static_cast<int64_t>(first_block + i)), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+            __m512i x0 = _mm512_and_si512(block, low);
+            __m512i x1 = _mm512_srli_epi64(block, 32);
+            __m512i x2 = stream_lo;
+            __m512i x3 = stream_hi;
+            uint32_t k0 = static_cast<uint32_t>(seed);
+            uint32_t k1 = static_cast<uint32_t>(seed >> 32U);
+            for (int32_t round = 0; round < 10; ++round) {
+                if (round > 0) {
+                    k0 += 0x9E3779B9U;
+                    k1 += 0xBB67AE85U;
+                }
+                const __m512i product0 = _mm512_mul_epu32(x0, m0);
+                const __m512i product1 = _mm512_mul_epu32(x2, m1);
+                x0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(product1, 32), x1), _mm512_set1_epi64(k0));
+                x1 = _mm512_and_si512(product1, low);
+                x2 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(product0, 32), x3), _mm512_set1_epi64(k1));
+                x3 = _mm512_and_si512(product0, low);
+            }
+            const __m512i word0 = _mm512_or_si512(_mm512_slli_epi64(x1, 32), x0);
+            const __m512i word1 = _mm512_or_si512(_mm512_slli_epi64(x3, 32), x2);
+            const __m512d u1 = _mm512_sub_pd(_mm512_set1_pd(2.0), _mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(word0, 12), one_bits)));
+            const __m512d u2 = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(word1, 12), one_bits)), _mm512_set1_pd(1.0));
+
+            const __m512i bits = _mm512_castpd_si512(u1);
+            __m512d e = _mm512_sub_pd(_mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(bits, 52), magic_bits)), _mm512_set1_pd(bm::magic)), _mm512_set1_pd(bm::exponent_bias));
+            __m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, mantissa_mask), one_bits));
+            const __mmask8 above = _mm512_cmp_pd_mask(m, _mm512_set1_pd(bm::sqrt2), _CMP_GT_OQ);
+            m = _mm512_mask_mul_pd(m, above, m, _mm512_set1_pd(0.5));
+            e = _mm512_mask_add_pd(e, above, e, _mm512_set1_pd(1.0));
+            const __m512d f = _mm512_sub_pd(m, _mm512_set1_pd(1.0));
+            const __m512d s = _mm512_div_pd(f, _mm512_add_pd(_mm512_set1_pd(2.0), f));
+            const __m512d z = _mm512_mul_pd(s, s);
+            __m512d r = _mm512_add_pd(_mm512_set1_pd(bm::lg6), _mm512_mul_pd(z, _mm512_set1_pd(bm::lg7)));
+            r = _mm512_add_pd(_mm512_set1_pd(bm::lg5), _mm512_mul_pd(z, r));
+            r = _mm512_add_pd(_mm512_set1_pd(bm::lg4), _mm512_mul_pd(z, r));
+            r = _mm512_add_pd(_mm512_set1_pd(bm::lg3), _mm512_mul_pd(z, r));
+            r = _mm512_add_pd(_mm512_set1_pd(bm::lg2), _mm512_mul_pd(z, r));
+            r = _mm512_add_pd(_mm512_set1_pd(bm::lg1), _mm512_mul_pd(z, r));
+            r = _mm512_mul_pd(z, r);
+            const __m512d log_m = _mm512_sub_pd(f, _mm512_mul_pd(s, _mm512_sub_pd(f, r)));
+            const __m512d log_u1 = _mm512_add_pd(_mm512_mul_pd(e, _mm512_set1_pd(bm::ln2_hi)), _mm512_add_pd(log_m, _mm512_mul_pd(e, _mm512_set1_pd(bm::ln2_lo))));
+            const __m512d radius = _mm512_mul_pd(_mm512_sqrt_pd(_mm512_mul_pd(_mm512_set1_pd(-2.0), log_u1)), _mm512_set1_pd(scale));
+
+            const __m512d t = _mm512_mul_pd(_mm512_set1_pd(4.0), u2);
+            const __m512d k = _mm512_roundscale_pd(t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            const __m512d x = _mm512_mul_pd(_mm512_sub_pd(t, k), _mm512_set1_pd(bm::half_pi));
+            const __m512d zz = _mm512_mul_pd(x, x);
+            __m512d ps = _mm512_add_pd(_mm512_set1_pd(bm::s5), _mm512_mul_pd(zz, _mm512_set1_pd(bm::s6)));
+            ps = _mm512_add_pd(_mm512_set1_pd(bm::s4), _mm512_mul_pd(zz, ps));
+            ps = _mm512_add_pd(_mm512_set1_pd(bm::s3), _mm512_mul_pd(zz, ps));
+            ps = _mm512_add_pd(_mm512_set1_pd(bm::s2), _mm512_mul_pd(zz, ps));
+            ps = _mm512_add_pd(_mm512_set1_pd(bm::s1), _mm512_mul_pd(zz, ps));
+            const __m512d sin_x = _mm512_add_pd(x, _mm512_mul_pd(_mm512_mul_pd(x, zz), ps));
+            __m512d pc = _mm512_add_pd(_mm512_set1_pd(bm::c5), _mm512_mul_pd(zz, _mm512_set1_pd(bm::c6)));
+            pc = _mm512_add_pd(_mm512_set1_pd(bm::c4), _mm512_mul_pd(zz, pc));
+            pc = _mm512_add_pd(_mm512_set1_pd(bm::c3), _mm512_mul_pd(zz, pc));
+            pc = _mm512_add_pd(_mm512_set1_pd(bm::c2), _mm512_mul_pd(zz, pc));
+            pc = _mm512_add_pd(_mm512_set1_pd(bm::c1), _mm512_mul_pd(zz, pc));
+            const __m512d cos_x = _mm512_add_pd(_mm512_sub_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(_mm512_set1_pd(0.5), zz)), _mm512_mul_pd(_mm512_mul_pd(zz, zz), pc));
+            const __m512d q = _mm512_sub_pd(k, _mm512_mul_pd(_mm512_set1_pd(4.0), _mm512_roundscale_pd(_mm512_mul_pd(k, _mm512_set1_pd(0.25)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)));
+            const __mmask8 q1 = _mm512_cmp_pd_mask(q, _mm512_set1_pd(1.0), _CMP_EQ_OQ);
+            const __mmask8 q2 = _mm512_cmp_pd_mask(q, _mm512_set1_pd(2.0), _CMP_EQ_OQ);
+            const __mmask8 q3 = _mm512_cmp_pd_mask(q, _mm512_set1_pd(3.0), _CMP_EQ_OQ);
+            const __mmask8 swap = static_cast<__mmask8>(q1 | q3);
+            __m512d cos_value = _mm512_mask_blend_pd(swap, cos_x, sin_x);
+            __m512d sin_value = _mm512_mask_blend_pd(swap, sin_x, cos_x);
+            cos_value = _mm512_mask_xor_pd(cos_value, static_cast<__mmask8>(q1 | q2), cos_value, sign);
+            sin_value = _mm512_mask_xor_pd(sin_value, static_cast<__mmask8>(q2 | q3), sin_value, sign);
+
+            const __m512d re = _mm512_mul_pd(radius, cos_value);
+            const __m512d im = _mm512_mul_pd(radius, sin_value);
+            if (imag != nullptr) {
+                _mm512_storeu_pd(out + i, re);
+                _mm512_storeu_pd(imag + i, im);
+                continue;
+            }
+            _mm512_storeu_pd(out + 2 * i, _mm512_permutex2var_pd(re, first_half, im));
+            _mm512_storeu_pd(out + 2 * i + lanes, _mm512_permutex2var_pd(re, second_half, im));
+        }
+        if (imag != nullptr) {
+            normal_pairs_scalar(seed, stream_id, first_block + i, out + i, num_of_pairs - i, scale, imag + i);
+        } else {
+            normal_pairs_scalar(seed, stream_id, first_block + i, out + 2 * i, num_of_pairs - i, scale);
+        }
+    }
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    inline
+    void normal_pairs(const uint64_t seed, const uint64_t stream_id, const uint64_t first_block,
+                      double* out, const std::size_t num_of_pairs, const double scale, double* imag = nullptr) {
+#if COMM_SIMD_X86
+        switch (active_simd_isa()) {
+            case simd_isa::avx512:
+                normal_pairs_avx512(seed, stream_id, first_block, out, num_of_pairs, scale, imag);
+                return;
+            case simd_isa::avx2:
+                normal_pairs_avx2(seed, stream_id, first_block, out, num_of_pairs, scale, imag);
+                return;
+            default:
+                break;
+        }
+#endif
+        normal_pairs_scalar(seed, stream_id, first_block, out, num_of_pairs, scale, imag);
+    }
+}
+
+/**
+ * @brief Fill [first, last) with independent N(0, scale^2) samples.
+ *
+ * Every pair of samples comes from one block of the stream, starting at the next
+ * unused block, and the stream is advanced past the blocks used. An odd count
+ * leaves the second half of the last pair unused.
+ */
+inline void generate_normal(random_stream& stream, double* first, double* last, const double scale = 1.0) {
+    const auto num_of_samples = static_cast<std::size_t>(last - first);
+    const uint64_t first_block = (stream.position() + 1) / 2;
+    const std::size_t num_of_pairs = num_of_samples / 2;
+    detail::normal_pairs(stream.seed(), stream.stream_id(), first_block, first, num_of_pairs, scale);
+    if (num_of_samples % 2 != 0) {
+        std::array<double, 2> pair{};
+        detail::normal_pairs_scalar(stream.seed(), stream.stream_id(), first_block + num_of_pairs, pair.data(), 1, scale);
+        first[num_of_samples - 1] = pair[0];
+    }
+    stream.seek(2 * (first_block + (num_of_samples + 1) / 2));
+}
+
+/**
+ * @brief Fill [first, last) with complex samples whose real and imaginary parts are independent N(0, scale^2).
+ *
+ * Sample i is block (b + i) of the stream, b being the next unused block, so a range
+ * of a long noise sequence can be generated on its own by seeking the stream to it.
+ */
+inline void generate_normal(random_stream& stream, complex_signal_t* first, complex_signal_t* last, const double scale = 1.0) {
+    // std::complex<double> is an array of two doubles, [complex.numbers]
+    generate_normal(stream, reinterpret_cast<double*>(first), reinterpret_cast<double*>(last), scale);
+}
+
+/**
+ * @brief The samples of the complex version split into real and imaginary arrays of n each.
+ *
+ * The kernels store the two halves of each pair straight to their arrays, so split I/Q
+ * noise costs no interleaved pass.
+ */
+inline void generate_normal(random_stream& stream, double* real, double* imag, const std::size_t n, const double scale = 1.0) {
+    const uint64_t first_block = (stream.position() + 1) / 2;
+    detail::normal_pairs(stream.seed(), stream.stream_id(), first_block, real, n, scale, imag);
+    stream.seek(2 * (first_block + n));
+}
+
+}
+
+#endif // INCLUDE_NORMAL_HPP
@@ -0,0 +1,121 @@
+#ifndef INCLUDE_OFDM_HPP
+#define INCLUDE_OFDM_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "definitions.h"
+#include "fft.hpp"
+
+namespace comm {
+
+/**
+ * @brief OFDM stage: IFFT and cyclic prefix on transmit, prefix removal and FFT on receive.
+ *
+ * Every subcarrier carries a data symbol, e.g. from the PSK mappers, and the transforms are
+ * scaled by 1/sqrt(N) so the energy per sample and the SNR stay those of the data symbols.
+ * OFDM symbols go through the FFT batch_size at a time with one cached fftw_plan_many_dft
+ * plan; the buffers are allocated once per modem.
+ */
+class ofdm_modem {
+public:
+    static constexpr std::size_t default_batch_size = 32;
+
+    explicit ofdm_modem(const std::size_t fft_size = 64, const std::size_t cyclic_prefix_length = 16,
+                        const std::size_t batch_size = default_batch_size)
+        : _fft_size(fft_size),
+          _cyclic_prefix_length(cyclic_prefix_length),
+          _batch_size(std::max<std::size_t>(batch_size, 1)),
+          _scale(1 / std::sqrt(static_cast<double>(fft_size))),
+          _buffer(make_fftw_buffer(_fft_size * _batch_size)) {
+        if (fft_size == 0 || cyclic_prefix_length > fft_size) {
+            throw std::invalid_argument("OFDM needs a non-empty FFT and a cyclic prefix no longer than it");
+        }
+    }
+
+    std::size_t fft_size() const noexcept {
+        return _fft_size;
+    }
+
+    std::size_t cyclic_prefix_length() const noexcept {
+        return _cyclic_prefix_length;
+    }
+
+    // Samples per OFDM symbol, prefix included
+    std::size_t symbol_length() const noexcept {
+        return _fft_size + _cyclic_prefix_length;
+    }
+
+    /**
+     * @brief num_of_symbols * fft_size data symbols to num_of_symbols * symbol_length samples.
+     */
+    void modulate(const complex_signal_t* data, const std::size_t num_of_symbols, complex_signal_t* samples) {
+        for (std::size_t done = 0; done < num_of_symbols; done += _batch_size) {
+            const std::size_t batch = std::min(_batch_size, num_of_symbols - done);
+            std::copy(data + done * _fft_size, data + (done + batch) * _fft_size, _buffer.get());
+            _transform(batch, fft_direction::backward);
+            for (std::size_t i = 0; i < batch; ++i) {
+                const complex_signal_t* symbol = _buffer.get() + i * _fft_size;
+                complex_signal_t* out = samples + (done + i) * symbol_length();
+                // the prefix repeats the tail of the symbol
+                out = _scaled_copy(symbol + _fft_size - _cyclic_prefix_length, symbol + _fft_size, out);
+                _scaled_copy(symbol, symbol + _fft_size, out);
+            }
+        }
+    }
+
+    /**
+     * @brief num_of_symbols * symbol_length samples back to num_of_symbols * fft_size data symbols.
+     */
+    void demodulate(const complex_signal_t* samples, const std::size_t num_of_symbols, complex_signal_t* data) {
+        for (std::size_t done = 0; done < num_of_symbols; done += _batch_size) {
+            const std::size_t batch = std::min(_batch_size, num_of_symbols - done);
+            for (std::size_t i = 0; i < batch; ++i) {
+                const complex_signal_t* in = samples + (done + i) * symbol_length() + _cyclic_prefix_length;
+                std::copy(in, in + _fft_size, _buffer.get() + i * _fft_size);
+            }
+            _transform(batch, fft_direction::forward);
+            _scaled_copy(_buffer.get(), _buffer.get() + batch * _fft_size, data + done * _fft_size);
+        }
+    }
+
+    complex_signal_seq_t modulate(const complex_signal_seq_t& data) {
+        assert(data.size() % _fft_size == 0);
+        complex_signal_seq_t samples(data.size() / _fft_size * symbol_length());
+        modulate(data.data(), data.size() / _fft_size, samples.data());
+        return samples;
+    }
+
+    complex_signal_seq_t demodulate(const complex_signal_seq_t& samples) {
+        assert(samples.size() % symbol_length() == 0);
+        complex_signal_seq_t data(samples.size() / symbol_length() * _fft_size);
+        demodulate(samples.data(), samples.size() / symbol_length(), data.data());
+        return data;
+    }
+
+private:
+    complex_signal_t* _scaled_copy(const complex_signal_t* first, const complex_signal_t* last, complex_signal_t* out) const {
+        for (; first != last; ++first, ++out) {
+            *out = complex_signal_t(first->real() * _scale, first->imag() * _scale);
+        }
+        return out;
+    }
+
+    // A partial last batch gets a plan of its own, so every plan starts at the aligned buffer start.
+    void _transform(const std::size_t batch, const fft_direction direction) {
+        fft_in_place(_buffer.get(), _fft_size, batch, direction);
+    }
+
+    std::size_t _fft_size;
+    std::size_t _cyclic_prefix_length;
+    std::size_t _batch_size;
+    double _scale;
+    fftw_buffer _buffer;
+};
+
+}
+
+#endif // INCLUDE_OFDM_HPP
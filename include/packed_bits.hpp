@@ -0,0 +1,132 @@
+#ifndef INCLUDE_PACKED_BITS_HPP
+#define INCLUDE_PACKED_BITS_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "definitions.h"
+
+namespace comm {
+
+/**
+ * @brief Bit sequence packed 64 bits to a word.
+ *
+ * Bit i lives in bit (i % 64) of word (i / 64). The unused bits of the last word
+ * are always zero, so word-level operations such as XOR + popcount need no masking.
+ */
+class packed_bit_seq_t {
+public:
+    using word_type = uint64_t;
+    static constexpr std::size_t bits_per_word = 64;
+
+    packed_bit_seq_t() = default;
+
+    explicit packed_bit_seq_t(const std::size_t num_of_bits) : _words(num_of_words(num_of_bits), 0), _size(num_of_bits) {
+    }
+
+    explicit packed_bit_seq_t(const bit_seq_t& bits) : packed_bit_seq_t(bits.size()) {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            _words[i / bits_per_word] |= static_cast<word_type>(bits[i] & 1U) << (i % bits_per_word);
+        }
+    }
+
+    static constexpr std::size_t num_of_words(const std::size_t num_of_bits) {
+        return (num_of_bits + bits_per_word - 1) / bits_per_word;
+    }
+
+    bit_seq_t unpack() const {
+        bit_seq_t bits(_size);
+        for (std::size_t i = 0; i < _size; ++i) {
+            bits[i] = (*this)[i];
+        }
+        return bits;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    std::size_t num_of_words() const noexcept {
+        return _words.size();
+    }
+
+    void resize(const std::size_t num_of_bits) {
+        _words.resize(num_of_words(num_of_bits), 0);
+        _size = num_of_bits;
+        clear_padding();
+    }
+
+    bit_t operator[](const std::size_t i) const {
+        assert(i < _size);
+        return static_cast<bit_t>((_words[i / bits_per_word] >> (i % bits_per_word)) & 1U);
+    }
+
+    void set(const std::size_t i, const bit_t value) {
+        assert(i < _size);
+        const word_type mask = word_type{1} << (i % bits_per_word);
+        _words[i / bits_per_word] = (value & 1U) ? (_words[i / bits_per_word] | mask) : (_words[i / bits_per_word] & ~mask);
+    }
+
+    word_type* data() noexcept {
+        return _words.data();
+    }
+
+    const word_type* data() const noexcept {
+        return _words.data();
+    }
+
+    // Zero the unused bits of the last word, needed after writing whole words through data().
+    void clear_padding() {
+        const std::size_t used = _size % bits_per_word;
+        if (used != 0) {
+            _words.back() &= (word_type{1} << used) - 1;
+        }
+    }
+
+    friend bool operator==(const packed_bit_seq_t& lhs, const packed_bit_seq_t& rhs) {
+        return lhs._size == rhs._size && lhs._words == rhs._words;
+    }
+
+    friend bool operator!=(const packed_bit_seq_t& lhs, const packed_bit_seq_t& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    std::vector<word_type> _words{};
+    std::size_t _size{0};
+};
+
+namespace detail {
+    inline
+    std::size_t popcount(uint64_t word) {
+#if defined(__POPCNT__)
+        return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+        // Without the popcnt instruction the builtin is a library call; this form also vectorizes.
+        word = word - ((word >> 1U) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2U) & 0x3333333333333333ULL);
+        word = (word + (word >> 4U)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<std::size_t>((word * 0x0101010101010101ULL) >> 56U);
+#endif
+    }
+
+    // Bits 0, 2, 4, ... 62 of word, packed into the low 32 bits
+    inline
+    uint64_t even_bits(uint64_t word) {
+        word &= 0x5555555555555555ULL;
+        word = (word | (word >> 1U)) & 0x3333333333333333ULL;
+        word = (word | (word >> 2U)) & 0x0F0F0F0F0F0F0F0FULL;
+        word = (word | (word >> 4U)) & 0x00FF00FF00FF00FFULL;
+        word = (word | (word >> 8U)) & 0x0000FFFF0000FFFFULL;
+        return (word | (word >> 16U)) & 0x00000000FFFFFFFFULL;
+    }
+}
+
+}
+
+#endif // INCLUDE_PACKED_BITS_HPP
@@ -0,0 +1,409 @@
+#ifndef INCLUDE_PIPELINE_HPP
+#define INCLUDE_PIPELINE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "constellation.hpp"
+#include "convolutional.hpp"
+#include "definitions.h"
+#include "llr.hpp"
+#include "packed_bits.hpp"
+#include "profile.hpp"
+#include "psk.hpp"
+#include "random.hpp"
+#include "utilities.hpp"
+#include "workspace.hpp"
+
+namespace comm {
+
+// Modems of the pipeline: map packed words to symbols and back, bpsk_modem and qpsk_modem on any sample type,
+// and symbols to LLRs for the coded pipeline.
+struct bpsk_modem {
+    static constexpr std::size_t bits_per_symbol = 1;
+    double offset{0};
+
+    template<typename Sample>
+    void modulate(const uint64_t* words, const std::size_t num_of_bits, Sample* symbols) const {
+        bpsk_modulation(words, num_of_bits, symbols, offset);
+    }
+
+    template<typename Sample>
+    void demodulate(const Sample* symbols, const std::size_t num_of_symbols, uint64_t* words) const {
+        bpsk_demodulation(symbols, num_of_symbols, words, offset);
+    }
+
+    void soft_demodulate(const complex_signal_t* symbols, const std::size_t num_of_symbols, const double noise_variance, double* llrs) const {
+        bpsk_llr(symbols, symbols + num_of_symbols, noise_variance, llrs, offset);
+    }
+};
+
+struct qpsk_modem {
+    static constexpr std::size_t bits_per_symbol = 2;
+
+    template<typename Sample>
+    void modulate(const uint64_t* words, const std::size_t num_of_bits, Sample* symbols) const {
+        qpsk_modulation(words, num_of_bits, symbols);
+    }
+
+    template<typename Sample>
+    void demodulate(const Sample* symbols, const std::size_t num_of_symbols, uint64_t* words) const {
+        qpsk_demodulation(symbols, num_of_symbols, words);
+    }
+
+    void soft_demodulate(const complex_signal_t* symbols, const std::size_t num_of_symbols, const double noise_variance, double* llrs) const {
+        qpsk_llr(symbols, symbols + num_of_symbols, noise_variance, llrs);
+    }
+};
+
+// Any psk_constellation<M> or qam_constellation<M>
+template<typename Constellation>
+struct constellation_modem {
+    static constexpr std::size_t bits_per_symbol = Constellation::bits_per_symbol;
+
+    void modulate(const uint64_t* words, const std::size_t num_of_bits, complex_signal_t* symbols) const {
+        comm::modulate<Constellation>(words, num_of_bits, symbols);
+    }
+
+    void demodulate(const complex_signal_t* symbols, const std::size_t num_of_symbols, uint64_t* words) const {
+        comm::demodulate<Constellation>(symbols, num_of_symbols, words);
+    }
+
+    void soft_demodulate(const complex_signal_t* symbols, const std::size_t num_of_symbols, const double noise_variance, double* llrs) const {
+        llr_demodulation<Constellation>(symbols, symbols + num_of_symbols, noise_variance, llrs);
+    }
+};
+
+/**
+ * @brief Fused bits -> modulation -> AWGN -> demodulation -> error count over an AWGN channel.
+ *
+ * The bits are pushed through every stage one block at a time, so the buffers stay
+ * cache resident and the memory used is O(block size) whatever the number of bits.
+ * Per block the generator gives the bits first and then the noise.
+ *
+ * The buffers come uninitialized from a workspace, by default the calling thread's, and go
+ * back when the pipeline is destroyed: a pipeline built per trial costs no heap allocation
+ * after the first trial of each thread. Pipelines sharing a workspace must be destroyed in
+ * the reverse order of their construction, as locals are.
+ *
+ * The sweep version of run() evaluates a whole list of SNRs on common random numbers:
+ * per block the bits, symbols and unit noise are drawn once, and every SNR only scales
+ * the noise onto the symbols and demodulates, so a sweep costs about one point's worth
+ * of random numbers and its curve is free of point-to-point sampling noise.
+ *
+ * Built with COMM_PROFILE, every stage is timed per SNR, see profile.hpp; the work a
+ * sweep shares between its SNRs goes to profile::shared_point.
+ *
+ * @tparam Modem bpsk_modem, qpsk_modem, constellation_modem or anything with the same interface
+ * @tparam Sample complex_signal_t, complex_float_t or complex_int16_t, the sample type of the symbols and noise
+ */
+template<typename Modem, typename Sample = complex_signal_t>
+class ber_pipeline {
+public:
+    // 2048 BPSK symbols and their noise take 64 KiB in double
+    static constexpr std::size_t default_block_size = 2048;
+
+    explicit ber_pipeline(Modem modem = Modem{}, const std::size_t block_size = default_block_size, workspace& buffers = thread_workspace())
+        : _modem(modem),
+          _block_size(std::max<std::size_t>(block_size / _bits_per_block_unit * _bits_per_block_unit, _bits_per_block_unit)),
+          _scope(buffers),
+          _bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _demodulated_bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _symbols(buffers.allocate<Sample>(_block_size / Modem::bits_per_symbol)),
+          _noise(buffers.allocate<Sample>(_block_size / Modem::bits_per_symbol)),
+          _unit_noise(buffers.allocate<complex_signal_t>(_block_size / Modem::bits_per_symbol)) {
+    }
+
+    std::size_t block_size() const noexcept {
+        return _block_size;
+    }
+
+    // Number of bit errors of num_of_bits bits, which must be a multiple of the bits per symbol.
+    std::size_t run(const std::size_t num_of_bits, const double snr_db, random_stream& generator) {
+        assert(num_of_bits % Modem::bits_per_symbol == 0);
+        COMM_PROFILE_POINT(snr_db);
+        std::size_t error_num{0};
+        for (std::size_t done = 0; done < num_of_bits; done += _block_size) {
+            error_num += _run_block(std::min(_block_size, num_of_bits - done), snr_db, generator);
+        }
+        return error_num;
+    }
+
+    /**
+     * @brief Number of bit errors at every SNR of snr_list, all on the same bits and noise.
+     *
+     * With complex_signal_t samples each point sees the noise run() would give it from the
+     * same generator, up to the rounding of the scaling.
+     */
+    std::vector<std::size_t> run(const std::size_t num_of_bits, const std::vector<double>& snr_list, random_stream& generator) {
+        std::vector<std::size_t> error_num(snr_list.size(), 0);
+        run(num_of_bits, snr_list, generator, error_num.data());
+        return error_num;
+    }
+
+    // The same, adding the errors at every SNR to error_num without allocating
+    void run(const std::size_t num_of_bits, const std::vector<double>& snr_list, random_stream& generator, std::size_t* error_num) {
+        assert(num_of_bits % Modem::bits_per_symbol == 0);
+        for (std::size_t done = 0; done < num_of_bits; done += _block_size) {
+            _run_sweep_block(std::min(_block_size, num_of_bits - done), snr_list, generator, error_num);
+        }
+    }
+
+private:
+    // Blocks are whole words and whole symbols
+    static constexpr std::size_t _bits_per_block_unit = packed_bit_seq_t::bits_per_word * Modem::bits_per_symbol;
+
+    void _generate_bits(const std::size_t num_of_bits, random_stream& generator) {
+        COMM_PROFILE_STAGE(bits, num_of_bits);
+        const std::size_t num_of_words = packed_bit_seq_t::num_of_words(num_of_bits);
+        generator.generate(_bits, _bits + num_of_words);
+        if (num_of_bits % packed_bit_seq_t::bits_per_word != 0) {
+            _bits[num_of_words - 1] &= (uint64_t{1} << (num_of_bits % packed_bit_seq_t::bits_per_word)) - 1;
+        }
+    }
+
+    std::size_t _count_errors(const std::size_t num_of_bits) const {
+        COMM_PROFILE_STAGE(count_errors, num_of_bits);
+        std::size_t error_num{0};
+        for (std::size_t i = 0; i < packed_bit_seq_t::num_of_words(num_of_bits); ++i) {
+            error_num += detail::popcount(_bits[i] ^ _demodulated_bits[i]);
+        }
+        return error_num;
+    }
+
+    void _modulate(const std::size_t num_of_bits) {
+        COMM_PROFILE_STAGE(modulation, num_of_bits / Modem::bits_per_symbol);
+        _modem.modulate(_bits, num_of_bits, _symbols);
+    }
+
+    void _demodulate(const Sample* received, const std::size_t num_of_symbols) {
+        COMM_PROFILE_STAGE(demodulation, num_of_symbols);
+        _modem.demodulate(received, num_of_symbols, _demodulated_bits);
+    }
+
+    std::size_t _run_block(const std::size_t num_of_bits, const double snr_db, random_stream& generator) {
+        const std::size_t num_of_symbols = num_of_bits / Modem::bits_per_symbol;
+        _generate_bits(num_of_bits, generator);
+        _modulate(num_of_bits);
+        {
+            COMM_PROFILE_STAGE(noise, num_of_symbols);
+            generate_awgn_noise(_noise, _noise + num_of_symbols, snr_db, generator);
+        }
+        {
+            COMM_PROFILE_STAGE(channel, num_of_symbols);
+            add_in_place(_noise, _noise + num_of_symbols, _symbols);
+        }
+        _demodulate(_symbols, num_of_symbols);
+        return _count_errors(num_of_bits);
+    }
+
+    void _run_sweep_block(const std::size_t num_of_bits, const std::vector<double>& snr_list, random_stream& generator, std::size_t* error_num) {
+        const std::size_t num_of_symbols = num_of_bits / Modem::bits_per_symbol;
+        COMM_PROFILE_POINT(profile::shared_point);
+        _generate_bits(num_of_bits, generator);
+        _modulate(num_of_bits);
+        {
+            COMM_PROFILE_STAGE(noise, num_of_symbols);
+            generate_awgn_noise(_unit_noise, _unit_noise + num_of_symbols, 0.0, generator);
+        }
+
+        // _noise holds the received samples, symbols + scale * unit noise in one pass
+        for (std::size_t point = 0; point < snr_list.size(); ++point) {
+            COMM_PROFILE_POINT(snr_list[point]);
+            const double scale = std::pow(10, -snr_list[point] / 20.0);
+            {
+                COMM_PROFILE_STAGE(channel, num_of_symbols);
+                for (std::size_t i = 0; i < num_of_symbols; ++i) {
+                    const complex_signal_t noise(scale * _unit_noise[i].real(), scale * _unit_noise[i].imag());
+                    if constexpr (std::is_same_v<Sample, complex_signal_t>) {
+                        _noise[i] = _symbols[i] + noise;
+                    } else {
+                        _noise[i] = to_sample<Sample>(to_complex(_symbols[i]) + noise);
+                    }
+                }
+            }
+            _demodulate(_noise, num_of_symbols);
+            error_num[point] += _count_errors(num_of_bits);
+        }
+    }
+
+    Modem _modem;
+    std::size_t _block_size;
+    workspace::scope _scope;
+    uint64_t* _bits;
+    uint64_t* _demodulated_bits;
+    Sample* _symbols;
+    Sample* _noise;
+    complex_signal_t* _unit_noise;
+};
+
+/**
+ * @brief Fused bits -> encoding -> modulation -> AWGN -> LLRs -> Viterbi decoding -> error count.
+ *
+ * run() sends one terminated codeword of num_of_bits bits, block by block as ber_pipeline
+ * does: the encoder and the decoder carry their state from block to block, and the decoded
+ * bits, late by up to twice the traceback depth, are checked against the bits of this block
+ * or the one before. snr_db is Eb/N0 of the information bits, the symbols get
+ * Es/N0 = Eb/N0 + 10 log10(rate * bits per symbol); the tail is not counted against it.
+ *
+ * LLRs are quantized to int8_t with noiseless bits at about 16 in magnitude, set per block
+ * from the mean magnitude of its LLRs, which leaves room for the noise and keeps the
+ * quantization well below the noise.
+ *
+ * @tparam Modem bpsk_modem, qpsk_modem or constellation_modem, on complex_signal_t samples
+ */
+template<typename Modem>
+class coded_ber_pipeline {
+public:
+    // Information bits per block, whole words and whole puncturing periods
+    static constexpr std::size_t default_block_size = 3072;
+
+    explicit coded_ber_pipeline(const code_rate rate = code_rate::rate_1_2, Modem modem = Modem{}, const std::size_t block_size = default_block_size,
+                                workspace& buffers = thread_workspace())
+        : _modem(modem),
+          _rate(rate),
+          _block_size(std::max<std::size_t>(block_size / _block_unit * _block_unit, _block_unit)),
+          _encoder(rate),
+          _decoder(rate),
+          _scope(buffers),
+          _bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _previous_bits(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_block_size))),
+          _coded(buffers.allocate<uint64_t>(packed_bit_seq_t::num_of_words(_max_coded()) + 1)),
+          _symbols(buffers.allocate<complex_signal_t>(_max_coded() / Modem::bits_per_symbol)),
+          _noise(buffers.allocate<complex_signal_t>(_max_coded() / Modem::bits_per_symbol)),
+          _llrs(buffers.allocate<double>(_max_coded())),
+          _soft(buffers.allocate<int8_t>(_max_coded())),
+          _decoded(buffers.allocate<bit_t>(_max_coded() + 2 * _decoder.traceback_depth())) {
+        assert(_block_size >= 2 * _decoder.traceback_depth());
+    }
+
+    std::size_t block_size() const noexcept {
+        return _block_size;
+    }
+
+    code_rate rate() const noexcept {
+        return _rate;
+    }
+
+    // Number of bit errors in the num_of_bits bits of one codeword.
+    std::size_t run(const std::size_t num_of_bits, const double snr_db, random_stream& generator) {
+        COMM_PROFILE_POINT(snr_db);
+        const double es_n0_db = snr_db + 10 * std::log10(code_rate_value(_rate) * static_cast<double>(Modem::bits_per_symbol));
+        const double noise_variance = noise_variance_of(es_n0_db);
+        _encoder.reset();
+        _decoder.reset();
+        std::size_t error_num{0};
+        std::size_t num_of_decoded{0};
+        std::size_t start{0};
+        for (std::size_t done = 0; done < num_of_bits; done += _block_size) {
+            const std::size_t m = std::min(_block_size, num_of_bits - done);
+            const bool last = done + m == num_of_bits;
+            std::swap(_bits, _previous_bits);
+            start = done;
+            _generate_bits(m, generator);
+
+            std::size_t num_of_coded{0};
+            {
+                COMM_PROFILE_STAGE(encoding, m);
+                num_of_coded = _encoder.encode(_bits, m, _coded);
+                if (last) {
+                    num_of_coded += _encoder.terminate(_coded, num_of_coded);
+                }
+            }
+            // whole symbols, the padding bits are sent and not decoded
+            const std::size_t num_of_symbols = (num_of_coded + Modem::bits_per_symbol - 1) / Modem::bits_per_symbol;
+            detail::write_bits(_coded, num_of_coded, 0, num_of_symbols * Modem::bits_per_symbol - num_of_coded);
+            {
+                COMM_PROFILE_STAGE(modulation, num_of_symbols);
+                _modem.modulate(_coded, num_of_symbols * Modem::bits_per_symbol, _symbols);
+            }
+            {
+                COMM_PROFILE_STAGE(noise, num_of_symbols);
+                generate_awgn_noise(_noise, _noise + num_of_symbols, es_n0_db, generator);
+            }
+            {
+                COMM_PROFILE_STAGE(channel, num_of_symbols);
+                add_in_place(_noise, _noise + num_of_symbols, _symbols);
+            }
+            {
+                COMM_PROFILE_STAGE(demodulation, num_of_symbols);
+                _modem.soft_demodulate(_symbols, num_of_symbols, noise_variance, _llrs);
+                _quantize(num_of_coded);
+            }
+
+            std::size_t n{0};
+            {
+                COMM_PROFILE_STAGE(decoding, m);
+                n = _decoder.decode(_soft, num_of_coded, _decoded);
+                if (last) {
+                    n += _decoder.finish(_decoded + n);
+                }
+            }
+            error_num += _count_errors(n, num_of_decoded, start);
+            num_of_decoded += n;
+        }
+        return error_num;
+    }
+
+private:
+    // Blocks are whole words and whole puncturing periods of 1, 2 or 3 steps
+    static constexpr std::size_t _block_unit = 3 * packed_bit_seq_t::bits_per_word;
+
+    std::size_t _max_coded() const {
+        return 2 * (_block_size + detail::conv_tail) + Modem::bits_per_symbol;
+    }
+
+    void _generate_bits(const std::size_t num_of_bits, random_stream& generator) {
+        COMM_PROFILE_STAGE(bits, num_of_bits);
+        const std::size_t num_of_words = packed_bit_seq_t::num_of_words(num_of_bits);
+        generator.generate(_bits, _bits + num_of_words);
+        if (num_of_bits % packed_bit_seq_t::bits_per_word != 0) {
+            _bits[num_of_words - 1] &= (uint64_t{1} << (num_of_bits % packed_bit_seq_t::bits_per_word)) - 1;
+        }
+    }
+
+    void _quantize(const std::size_t n) {
+        double magnitude{0.0};
+        for (std::size_t i = 0; i < n; ++i) {
+            magnitude += std::abs(_llrs[i]);
+        }
+        magnitude /= static_cast<double>(std::max<std::size_t>(n, 1));
+        quantize_llr(_llrs, _llrs + n, (magnitude > 0.0) ? 16.0 / magnitude : 1.0, _soft);
+    }
+
+    // Decoded bits first .. first + n against the bits of this block, from start on, or of the one before
+    std::size_t _count_errors(const std::size_t n, const std::size_t first, const std::size_t start) const {
+        COMM_PROFILE_STAGE(count_errors, n);
+        std::size_t error_num{0};
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t bit = first + i;
+            const uint64_t* words = (bit >= start) ? _bits : _previous_bits;
+            const std::size_t index = (bit >= start) ? bit - start : bit + _block_size - start;
+            error_num += ((words[index / packed_bit_seq_t::bits_per_word] >> (index % packed_bit_seq_t::bits_per_word)) & 1U) != _decoded[i];
+        }
+        return error_num;
+    }
+
+    Modem _modem;
+    code_rate _rate;
+    std::size_t _block_size;
+    convolutional_encoder _encoder;
+    viterbi_decoder _decoder;
+    workspace::scope _scope;
+    uint64_t* _bits;
+    uint64_t* _previous_bits;
+    uint64_t* _coded;
+    complex_signal_t* _symbols;
+    complex_signal_t* _noise;
+    double* _llrs;
+    int8_t* _soft;
+    bit_t* _decoded;
+};
+
+}
+
+#endif // INCLUDE_PIPELINE_HPP
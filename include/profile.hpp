@@ -0,0 +1,446 @@
+#ifndef INCLUDE_PROFILE_HPP
+#define INCLUDE_PROFILE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+    Per-stage timing of the simulation hot path, compiled in with -DCOMM_PROFILE.
+
+    COMM_PROFILE_POINT(snr_db) names the SNR point the calling thread works on and
+    COMM_PROFILE_STAGE(name, items) times the rest of the enclosing block as that stage of
+    the point. Each thread adds to its own counters, merged by comm::profile::report() once
+    the threads are idle. Without COMM_PROFILE both macros expand to nothing.
+*/
+#if defined(COMM_PROFILE)
+#define COMM_PROFILE_CONCAT_IMPL(a, b) a##b
+#define COMM_PROFILE_CONCAT(a, b) COMM_PROFILE_CONCAT_IMPL(a, b)
+#define COMM_PROFILE_POINT(snr_db) ::comm::profile::set_point(snr_db)
+#define COMM_PROFILE_STAGE(name, items) \
+    const ::comm::profile::stage_timer COMM_PROFILE_CONCAT(comm_profile_timer_, __LINE__){::comm::profile::stage::name, (items)}
+#else
+#define COMM_PROFILE_POINT(snr_db) static_cast<void>(0)
+#define COMM_PROFILE_STAGE(name, items) static_cast<void>(0)
+#endif
+
+namespace comm {
+namespace profile {
+
+#if defined(COMM_PROFILE)
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+enum class stage {
+    bits,
+    encoding,
+    modulation,
+    noise,
+    channel,
+    demodulation,
+    decoding,
+    count_errors,
+};
+
+constexpr std::size_t num_of_stages = 8;
+
+inline const char* to_string(const stage s) {
+    switch (s) {
+        case stage::bits:
+            return "bits";
+        case stage::encoding:
+            return "encoding";
+        case stage::modulation:
+            return "modulation";
+        case stage::noise:
+            return "noise";
+        case stage::channel:
+            return "channel";
+        case stage::demodulation:
+            return "demodulation";
+        case stage::decoding:
+            return "decoding";
+        default:
+            return "count_errors";
+    }
+}
+
+// The point of work shared by all SNRs of a sweep
+constexpr double shared_point = -std::numeric_limits<double>::infinity();
+
+struct stage_counters {
+    uint64_t calls{0};
+    uint64_t nanoseconds{0};
+    uint64_t items{0};
+    // zero unless the hardware counters are on
+    uint64_t cycles{0};
+    uint64_t cache_misses{0};
+
+    stage_counters& operator+=(const stage_counters& other) {
+        calls += other.calls;
+        nanoseconds += other.nanoseconds;
+        items += other.items;
+        cycles += other.cycles;
+        cache_misses += other.cache_misses;
+        return *this;
+    }
+};
+
+using stage_table = std::array<stage_counters, num_of_stages>;
+using point_table = std::map<double, stage_table>;
+
+namespace detail {
+    struct hardware_sample {
+        uint64_t cycles{0};
+        uint64_t cache_misses{0};
+    };
+
+    inline std::atomic<bool>& hardware_counters_requested() {
+        static std::atomic<bool> requested{false};
+        return requested;
+    }
+
+#if defined(__linux__)
+    // CPU cycles and last level cache misses of the calling thread, one group read per sample.
+    class perf_counters {
+    public:
+        perf_counters() {
+            _leader = _open(PERF_COUNT_HW_CPU_CYCLES, -1);
+            if (_leader >= 0) {
+                _member = _open(PERF_COUNT_HW_CACHE_MISSES, _leader);
+                if (_member < 0) {
+                    ::close(_leader);
+                    _leader = -1;
+                } else {
+                    ::ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                }
+            }
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters() {
+            if (_leader >= 0) {
+                ::close(_member);
+                ::close(_leader);
+            }
+        }
+
+        bool available() const noexcept {
+            return _leader >= 0;
+        }
+
+        hardware_sample read() const {
+            // PERF_FORMAT_GROUP: the number of events, then their values
+            std::array<uint64_t, 3> values{};
+            if (_leader < 0 || ::read(_leader, values.data(), sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+                return {};
+            }
+            return {values[1], values[2]};
+        }
+
+    private:
+        static int _open(const uint64_t config, const int group) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = (group < 0) ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+        }
+
+        int _leader{-1};
+        int _member{-1};
+    };
+#else
+    class perf_counters {
+    public:
+        bool available() const noexcept {
+            return false;
+        }
+
+        hardware_sample read() const {
+            return {};
+        }
+    };
+#endif
+
+    class thread_profile;
+
+    // Every live thread's counters, and those of the threads that have exited
+    struct registry {
+        std::mutex mutex{};
+        std::vector<thread_profile*> threads{};
+        point_table retired{};
+        bool hardware_counters_used{false};
+    };
+
+    inline registry& global_registry() {
+        static registry instance{};
+        return instance;
+    }
+
+    inline void merge(point_table& into, const point_table& from) {
+        for (const auto& [point, table] : from) {
+            auto& target = into[point];
+            for (std::size_t i = 0; i < num_of_stages; ++i) {
+                target[i] += table[i];
+            }
+        }
+    }
+
+    class thread_profile {
+    public:
+        thread_profile() {
+            auto& r = global_registry();
+            const std::lock_guard<std::mutex> lock{r.mutex};
+            r.threads.push_back(this);
+        }
+
+        thread_profile(const thread_profile&) = delete;
+        thread_profile& operator=(const thread_profile&) = delete;
+
+        ~thread_profile() {
+            auto& r = global_registry();
+            const std::lock_guard<std::mutex> lock{r.mutex};
+            merge(r.retired, _points);
+            for (auto it = r.threads.begin(); it != r.threads.end(); ++it) {
+                if (*it == this) {
+                    r.threads.erase(it);
+                    break;
+                }
+            }
+        }
+
+        void set_point(const double snr_db) {
+            _current = &_points[snr_db];
+        }
+
+        stage_counters& counters(const stage s) {
+            if (_current == nullptr) {
+                set_point(shared_point);
+            }
+            return (*_current)[static_cast<std::size_t>(s)];
+        }
+
+        // Opened on first use after enable_hardware_counters()
+        perf_counters* hardware() {
+            if (!hardware_counters_requested().load(std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            if (!_hardware_tried) {
+                _hardware_tried = true;
+                _perf = std::make_unique<perf_counters>();
+                if (_perf->available()) {
+                    auto& r = global_registry();
+                    const std::lock_guard<std::mutex> lock{r.mutex};
+                    r.hardware_counters_used = true;
+                }
+            }
+            return _perf->available() ? _perf.get() : nullptr;
+        }
+
+        const point_table& points() const noexcept {
+            return _points;
+        }
+
+        void clear() {
+            _points.clear();
+            _current = nullptr;
+        }
+
+    private:
+        point_table _points{};
+        stage_table* _current{nullptr};
+        bool _hardware_tried{false};
+        std::unique_ptr<perf_counters> _perf{};
+    };
+
+    inline thread_profile& this_thread_profile() {
+        thread_local thread_profile instance{};
+        return instance;
+    }
+}
+
+// Work of the calling thread goes to this SNR point until the next call.
+inline void set_point(const double snr_db) {
+    detail::this_thread_profile().set_point(snr_db);
+}
+
+/**
+ * @brief Also count CPU cycles and cache misses per stage with perf_event_open.
+ *
+ * Costs a system call at each end of a stage. Threads that cannot open the counters
+ * (no Linux, perf_event_paranoid, containers) report zeros.
+ */
+inline void enable_hardware_counters(const bool enable = true) {
+    detail::hardware_counters_requested().store(enable);
+}
+
+// Times its lifetime as one call of a stage of the thread's current point.
+class stage_timer {
+public:
+    stage_timer(const stage s, const std::size_t items) : _stage(s), _items(items), _hardware(detail::this_thread_profile().hardware()) {
+        if (_hardware != nullptr) {
+            _start_sample = _hardware->read();
+        }
+        _start = std::chrono::steady_clock::now();
+    }
+
+    stage_timer(const stage_timer&) = delete;
+    stage_timer& operator=(const stage_timer&) = delete;
+
+    ~stage_timer() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        auto& counters = detail::this_thread_profile().counters(_stage);
+        ++counters.calls;
+        counters.nanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        counters.items += _items;
+        if (_hardware != nullptr) {
+            const auto end_sample = _hardware->read();
+            counters.cycles += end_sample.cycles - _start_sample.cycles;
+            counters.cache_misses += end_sample.cache_misses - _start_sample.cache_misses;
+        }
+    }
+
+private:
+    stage _stage;
+    std::size_t _items;
+    detail::perf_counters* _hardware;
+    detail::hardware_sample _start_sample{};
+    std::chrono::steady_clock::time_point _start{};
+};
+
+// Counters of all threads so far, by SNR point. Call it while no stage is running.
+inline point_table report() {
+    auto& r = detail::global_registry();
+    const std::lock_guard<std::mutex> lock{r.mutex};
+    point_table total = r.retired;
+    for (const auto* thread : r.threads) {
+        detail::merge(total, thread->points());
+    }
+    return total;
+}
+
+// Forgets all counters. Call it while no stage is running.
+inline void reset() {
+    auto& r = detail::global_registry();
+    const std::lock_guard<std::mutex> lock{r.mutex};
+    r.retired.clear();
+    for (auto* thread : r.threads) {
+        thread->clear();
+    }
+}
+
+inline bool hardware_counters_used() {
+    auto& r = detail::global_registry();
+    const std::lock_guard<std::mutex> lock{r.mutex};
+    return r.hardware_counters_used;
+}
+
+namespace detail {
+    inline std::string point_name(const double point) {
+        if (point == shared_point) {
+            return "shared";
+        }
+        std::array<char, 32> buf{};
+        (void) std::snprintf(buf.data(), buf.size(), "%.2f dB", point);
+        return buf.data();
+    }
+}
+
+// Per SNR point: each stage's calls, time, share of the point's time and cost per item.
+inline void print(std::ostream& os, const point_table& table) {
+    const bool hardware = hardware_counters_used();
+    std::array<char, 192> buf{};
+    (void) std::snprintf(buf.data(), buf.size(), "%-10s %-13s %10s %12s %7s %10s", "point", "stage", "calls", "ms", "share", "ns/item");
+    os << buf.data() << (hardware ? "  cycles/item  misses/kitem\n" : "\n");
+    for (const auto& [point, stages] : table) {
+        uint64_t point_nanoseconds{0};
+        for (const auto& counters : stages) {
+            point_nanoseconds += counters.nanoseconds;
+        }
+        for (std::size_t i = 0; i < num_of_stages; ++i) {
+            const auto& counters = stages[i];
+            if (counters.calls == 0) {
+                continue;
+            }
+            const auto items = static_cast<double>(std::max<uint64_t>(counters.items, 1));
+            (void) std::snprintf(buf.data(), buf.size(), "%-10s %-13s %10llu %12.3f %6.1f%% %10.3f", detail::point_name(point).c_str(),
+                                 to_string(static_cast<stage>(i)), static_cast<unsigned long long>(counters.calls),
+                                 static_cast<double>(counters.nanoseconds) * 1e-6,
+                                 point_nanoseconds == 0 ? 0.0 : 100.0 * static_cast<double>(counters.nanoseconds) / static_cast<double>(point_nanoseconds),
+                                 static_cast<double>(counters.nanoseconds) / items);
+            os << buf.data();
+            if (hardware) {
+                (void) std::snprintf(buf.data(), buf.size(), "  %11.3f  %12.3f", static_cast<double>(counters.cycles) / items,
+                                     1e3 * static_cast<double>(counters.cache_misses) / items);
+                os << buf.data();
+            }
+            os << '\n';
+        }
+    }
+}
+
+// The same as JSON, for tracking across commits; false when the file cannot be written.
+inline bool write_json(const std::string& path, const point_table& table) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::fprintf(file, "{\n  \"hardware_counters\": %s,\n  \"points\": [\n", hardware_counters_used() ? "true" : "false");
+    std::size_t remaining = table.size();
+    for (const auto& [point, stages] : table) {
+        if (point == shared_point) {
+            std::fprintf(file, "    {\"snr_db\": null, \"stages\": [\n");
+        } else {
+            std::fprintf(file, "    {\"snr_db\": %.6g, \"stages\": [\n", point);
+        }
+        bool first = true;
+        for (std::size_t i = 0; i < num_of_stages; ++i) {
+            const auto& counters = stages[i];
+            if (counters.calls == 0) {
+                continue;
+            }
+            std::fprintf(file, "%s      {\"name\": \"%s\", \"calls\": %llu, \"seconds\": %.9f, \"items\": %llu, \"cycles\": %llu, \"cache_misses\": %llu}",
+                         first ? "" : ",\n", to_string(static_cast<stage>(i)), static_cast<unsigned long long>(counters.calls),
+                         static_cast<double>(counters.nanoseconds) * 1e-9, static_cast<unsigned long long>(counters.items),
+                         static_cast<unsigned long long>(counters.cycles), static_cast<unsigned long long>(counters.cache_misses));
+            first = false;
+        }
+        std::fprintf(file, "\n    ]}%s\n", (--remaining != 0) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+
+}
+}
+
+#endif // INCLUDE_PROFILE_HPP
@@ -5,9 +5,15 @@
 #include <array>
 #include <complex>
 #include <cassert>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 #include "definitions.h"
+#include "packed_bits.hpp"
+#include "psk_kernels.hpp"
+#include "sample.hpp"
+#include "split_signal.hpp"
 
 
 namespace comm {
@@ -32,10 +38,17 @@ namespace comm {
 
 template<typename InputIterator, typename OutputIterator>
 void bpsk_modulation(const InputIterator input_begin, const InputIterator input_end, OutputIterator output_begin, double offset = 0) {
-    using input_value_type = typename InputIterator::value_type;
-    using output_value_type = typename OutputIterator::value_type;
+    using input_value_type = typename std::iterator_traits<InputIterator>::value_type;
+    using output_value_type = typename std::iterator_traits<OutputIterator>::value_type;
     const auto c = std::cos(offset);
     const auto s = std::sin(offset);
+    if constexpr (detail::is_contiguous_input_v<InputIterator, bit_t> && detail::is_contiguous_output_v<OutputIterator, complex_signal_t>) {
+        const auto n = static_cast<std::size_t>(std::distance(input_begin, input_end));
+        if (n > 0) {
+            detail::bpsk_modulation_kernel(std::addressof(*input_begin), n, std::addressof(*output_begin), c, s);
+        }
+        return;
+    }
     std::transform(input_begin, input_end, output_begin, [c, s](const input_value_type bit) {
         // (cos(pi + offset) + i*sin(pi + offset) : (cos(0 + offset) + i*sin(0 + offset)
         return (bit == 0) ? output_value_type(-c, -s) : output_value_type(c, s);
@@ -60,10 +73,17 @@ complex_signal_seq_t bpsk_modulation(const bit_seq_t& bit_seq, double offset = 0
  */
 template<typename InputIterator, typename OutputIterator>
 void bpsk_demodulation(const InputIterator input_begin, const InputIterator input_end, OutputIterator output_begin, double offset = 0) {
-    using input_value_type = typename InputIterator::value_type;
-    using output_value_type = typename OutputIterator::value_type;
+    using input_value_type = typename std::iterator_traits<InputIterator>::value_type;
+    using output_value_type = typename std::iterator_traits<OutputIterator>::value_type;
     const auto c = std::cos(offset);
     const auto s = std::sin(offset);
+    if constexpr (detail::is_contiguous_input_v<InputIterator, complex_signal_t> && detail::is_contiguous_output_v<OutputIterator, bit_t>) {
+        const auto n = static_cast<std::size_t>(std::distance(input_begin, input_end));
+        if (n > 0) {
+            detail::bpsk_demodulation_kernel(std::addressof(*input_begin), n, std::addressof(*output_begin), c, s);
+        }
+        return;
+    }
     // For zero offset, If the received symbol is above the curve of y=-x (y+x=0), it is demodulated as 0, otherwise 1.
     std::transform(input_begin, input_end, output_begin, [c, s](const input_value_type symbol) {
         return (symbol.imag() * s + symbol.real() * c < 0) ? static_cast<output_value_type>(0) : static_cast<output_value_type>(1);
@@ -85,8 +105,15 @@ bit_seq_t bpsk_demodulation(const complex_signal_seq_t& symbols, double offset =
 */
 template<typename InputIterator, typename OutputIterator>
 void qpsk_modulation(InputIterator input_begin, InputIterator input_end, OutputIterator output_begin) {
-    using input_value_type = typename InputIterator::value_type;
+    using input_value_type = typename std::iterator_traits<InputIterator>::value_type;
     assert(std::distance(input_begin, input_end) % 2 == 0);
+    if constexpr (detail::is_contiguous_input_v<InputIterator, bit_t> && detail::is_contiguous_output_v<OutputIterator, complex_signal_t>) {
+        const auto n = static_cast<std::size_t>(std::distance(input_begin, input_end));
+        if (n > 0) {
+            detail::qpsk_modulation_kernel(std::addressof(*input_begin), n, std::addressof(*output_begin));
+        }
+        return;
+    }
     for (; input_begin != input_end; ++input_begin, ++output_begin) {
         const input_value_type bit1 = *input_begin;
         const input_value_type bit2 = *(++input_begin);
@@ -109,8 +136,15 @@ complex_signal_seq_t qpsk_modulation(const bit_seq_t& bit_seq) {
 // Return demodulated bit sequence
 template<typename InputIterator, typename OutputIterator>
 void qpsk_demodulation(InputIterator input_begin, InputIterator input_end, OutputIterator output_begin, OutputIterator output_end) {
-    using output_value_type = typename OutputIterator::value_type;
+    using output_value_type = typename std::iterator_traits<OutputIterator>::value_type;
     assert(std::distance(input_begin, input_end) * 2 == std::distance(output_begin, output_end));
+    if constexpr (detail::is_contiguous_input_v<InputIterator, complex_signal_t> && detail::is_contiguous_output_v<OutputIterator, bit_t>) {
+        const auto n = static_cast<std::size_t>(std::distance(input_begin, input_end));
+        if (n > 0) {
+            detail::qpsk_demodulation_kernel(std::addressof(*input_begin), n, std::addressof(*output_begin));
+        }
+        return;
+    }
     static std::array<std::array<std::pair<output_value_type, output_value_type>, 2>, 2> table = []() {
         std::array<std::array<std::pair<output_value_type, output_value_type>, 2>, 2> t{};
         t[0][0] = {1, 1}; // (-1, -1) -> 11
@@ -133,6 +167,198 @@ bit_seq_t qpsk_demodulation(const complex_signal_seq_t& symbols) {
     return bit_seq;
 }
 
+/*
+    Contiguous buffer versions, same mappings as above.
+    Vectors and pointers given to the iterator versions end up here too. They run the
+    AVX2 or AVX-512 kernel picked by active_simd_isa() and give bit-exact scalar results.
+*/
+
+inline
+void bpsk_modulation(const bit_t* input_begin, const bit_t* input_end, complex_signal_t* output_begin, double offset = 0) {
+    detail::bpsk_modulation_kernel(input_begin, static_cast<std::size_t>(input_end - input_begin), output_begin, std::cos(offset), std::sin(offset));
+}
+
+inline
+void bpsk_demodulation(const complex_signal_t* input_begin, const complex_signal_t* input_end, bit_t* output_begin, double offset = 0) {
+    detail::bpsk_demodulation_kernel(input_begin, static_cast<std::size_t>(input_end - input_begin), output_begin, std::cos(offset), std::sin(offset));
+}
+
+inline
+void qpsk_modulation(const bit_t* input_begin, const bit_t* input_end, complex_signal_t* output_begin) {
+    assert((input_end - input_begin) % 2 == 0);
+    detail::qpsk_modulation_kernel(input_begin, static_cast<std::size_t>(input_end - input_begin), output_begin);
+}
+
+inline
+void qpsk_demodulation(const complex_signal_t* input_begin, const complex_signal_t* input_end, bit_t* output_begin, [[maybe_unused]] bit_t* output_end) {
+    assert((input_end - input_begin) * 2 == output_end - output_begin);
+    detail::qpsk_demodulation_kernel(input_begin, static_cast<std::size_t>(input_end - input_begin), output_begin);
+}
+
+// Packed bit versions. Bit i is bit (i % 64) of word i / 64;
+// the demodulators write whole words and leave the unused bits of the last one zero.
+
+inline
+void bpsk_modulation(const uint64_t* words, const std::size_t num_of_bits, complex_signal_t* symbols, double offset = 0) {
+    detail::bpsk_modulation_words_kernel(words, num_of_bits, symbols, std::cos(offset), std::sin(offset));
+}
+
+inline
+void bpsk_demodulation(const complex_signal_t* symbols, const std::size_t num_of_symbols, uint64_t* words, double offset = 0) {
+    detail::bpsk_demodulation_words_kernel(symbols, num_of_symbols, words, std::cos(offset), std::sin(offset));
+}
+
+inline
+void qpsk_modulation(const uint64_t* words, const std::size_t num_of_bits, complex_signal_t* symbols) {
+    assert(num_of_bits % 2 == 0);
+    detail::qpsk_modulation_words_kernel(words, num_of_bits, symbols);
+}
+
+inline
+void qpsk_demodulation(const complex_signal_t* symbols, const std::size_t num_of_symbols, uint64_t* words) {
+    detail::qpsk_demodulation_words_kernel(symbols, num_of_symbols, words);
+}
+
+inline
+complex_signal_seq_t bpsk_modulation(const packed_bit_seq_t& bit_seq, double offset = 0) {
+    complex_signal_seq_t symbols(bit_seq.size());
+    bpsk_modulation(bit_seq.data(), bit_seq.size(), symbols.data(), offset);
+    return symbols;
+}
+
+inline
+void bpsk_demodulation(const complex_signal_seq_t& symbols, packed_bit_seq_t& bit_seq, double offset = 0) {
+    bit_seq.resize(symbols.size());
+    bpsk_demodulation(symbols.data(), symbols.size(), bit_seq.data(), offset);
+}
+
+inline
+complex_signal_seq_t qpsk_modulation(const packed_bit_seq_t& bit_seq) {
+    assert(bit_seq.size() % 2 == 0);
+    complex_signal_seq_t symbols(bit_seq.size() / 2);
+    qpsk_modulation(bit_seq.data(), bit_seq.size(), symbols.data());
+    return symbols;
+}
+
+inline
+void qpsk_demodulation(const complex_signal_seq_t& symbols, packed_bit_seq_t& bit_seq) {
+    bit_seq.resize(symbols.size() * 2);
+    qpsk_demodulation(symbols.data(), symbols.size(), bit_seq.data());
+}
+
+/*
+    Packed bit versions on the other sample types, std::complex<float> and complex_int16_t.
+    Same mappings, rounded to the sample type; the decisions look at the signs only, so
+    they need no conversion back to double for the QPSK ones.
+*/
+
+template<typename Sample>
+void bpsk_modulation(const uint64_t* words, const std::size_t num_of_bits, Sample* symbols, double offset = 0) {
+    const auto one = to_sample<Sample>({std::cos(offset), std::sin(offset)});
+    const auto zero = to_sample<Sample>({-std::cos(offset), -std::sin(offset)});
+    for (std::size_t i = 0; i < num_of_bits; ++i) {
+        symbols[i] = ((words[i / packed_bit_seq_t::bits_per_word] >> (i % packed_bit_seq_t::bits_per_word)) & 1U) ? one : zero;
+    }
+}
+
+template<typename Sample>
+void bpsk_demodulation(const Sample* symbols, const std::size_t num_of_symbols, uint64_t* words, double offset = 0) {
+    // the scale of fixed-point samples does not change the sign of the decision
+    const auto c = std::cos(offset);
+    const auto s = std::sin(offset);
+    for (std::size_t first = 0; first < num_of_symbols; first += packed_bit_seq_t::bits_per_word) {
+        const std::size_t last = std::min(first + packed_bit_seq_t::bits_per_word, num_of_symbols);
+        uint64_t word = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            const double decision = static_cast<double>(symbols[i].imag()) * s + static_cast<double>(symbols[i].real()) * c;
+            word |= static_cast<uint64_t>(!(decision < 0)) << (i - first);
+        }
+        words[first / packed_bit_seq_t::bits_per_word] = word;
+    }
+}
+
+template<typename Sample>
+void qpsk_modulation(const uint64_t* words, const std::size_t num_of_bits, Sample* symbols) {
+    assert(num_of_bits % 2 == 0);
+    const double scale = 1/std::sqrt(2);
+    const std::array<Sample, 4> table{
+        to_sample<Sample>({scale, scale}), to_sample<Sample>({-scale, scale}),
+        to_sample<Sample>({scale, -scale}), to_sample<Sample>({-scale, -scale}),
+    };
+    for (std::size_t i = 0; i < num_of_bits / 2; ++i) {
+        symbols[i] = table[(words[2 * i / packed_bit_seq_t::bits_per_word] >> (2 * i % packed_bit_seq_t::bits_per_word)) & 3U];
+    }
+}
+
+template<typename Sample>
+void qpsk_demodulation(const Sample* symbols, const std::size_t num_of_symbols, uint64_t* words) {
+    constexpr std::size_t symbols_per_word = packed_bit_seq_t::bits_per_word / 2;
+    for (std::size_t first = 0; first < num_of_symbols; first += symbols_per_word) {
+        const std::size_t last = std::min(first + symbols_per_word, num_of_symbols);
+        uint64_t word = 0;
+        for (std::size_t i = first; i < last; ++i) {
+            const auto bit1 = static_cast<uint64_t>(!(symbols[i].real() > 0));
+            const auto bit2 = static_cast<uint64_t>(!(symbols[i].imag() > 0));
+            word |= (bit1 | (bit2 << 1U)) << (2 * (i - first));
+        }
+        words[first / symbols_per_word] = word;
+    }
+}
+
+// Split I/Q versions, same mappings with the real and imaginary parts in separate arrays.
+
+inline
+void bpsk_modulation(const bit_seq_t& bit_seq, split_signal_t& symbols, double offset = 0) {
+    symbols.resize(bit_seq.size());
+    detail::bpsk_modulation_split_kernel(bit_seq.data(), bit_seq.size(), symbols.real(), symbols.imag(), std::cos(offset), std::sin(offset));
+}
+
+inline
+bit_seq_t bpsk_demodulation(const split_signal_t& symbols, double offset = 0) {
+    bit_seq_t bit_seq(symbols.size());
+    detail::bpsk_demodulation_split_kernel(symbols.real(), symbols.imag(), symbols.size(), bit_seq.data(), std::cos(offset), std::sin(offset));
+    return bit_seq;
+}
+
+inline
+void qpsk_modulation(const bit_seq_t& bit_seq, split_signal_t& symbols) {
+    assert(bit_seq.size() % 2 == 0);
+    symbols.resize(bit_seq.size() / 2);
+    detail::qpsk_modulation_split_kernel(bit_seq.data(), bit_seq.size(), symbols.real(), symbols.imag());
+}
+
+inline
+bit_seq_t qpsk_demodulation(const split_signal_t& symbols) {
+    bit_seq_t bit_seq(symbols.size() * 2);
+    detail::qpsk_demodulation_split_kernel(symbols.real(), symbols.imag(), symbols.size(), bit_seq.data());
+    return bit_seq;
+}
+
+inline
+void bpsk_modulation(const packed_bit_seq_t& bit_seq, split_signal_t& symbols, double offset = 0) {
+    symbols.resize(bit_seq.size());
+    detail::bpsk_modulation_words_split_kernel(bit_seq.data(), bit_seq.size(), symbols.real(), symbols.imag(), std::cos(offset), std::sin(offset));
+}
+
+inline
+void bpsk_demodulation(const split_signal_t& symbols, packed_bit_seq_t& bit_seq, double offset = 0) {
+    bit_seq.resize(symbols.size());
+    detail::bpsk_demodulation_words_split_kernel(symbols.real(), symbols.imag(), symbols.size(), bit_seq.data(), std::cos(offset), std::sin(offset));
+}
+
+inline
+void qpsk_modulation(const packed_bit_seq_t& bit_seq, split_signal_t& symbols) {
+    assert(bit_seq.size() % 2 == 0);
+    symbols.resize(bit_seq.size() / 2);
+    detail::qpsk_modulation_words_split_kernel(bit_seq.data(), bit_seq.size(), symbols.real(), symbols.imag());
+}
+
+inline
+void qpsk_demodulation(const split_signal_t& symbols, packed_bit_seq_t& bit_seq) {
+    bit_seq.resize(symbols.size() * 2);
+    detail::qpsk_demodulation_words_split_kernel(symbols.real(), symbols.imag(), symbols.size(), bit_seq.data());
+}
+
 }
 
 
@@ -0,0 +1,926 @@
+#ifndef INCLUDE_PSK_KERNELS_HPP
+#define INCLUDE_PSK_KERNELS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "definitions.h"
+#include "packed_bits.hpp"
+#include "simd.hpp"
+
+namespace comm {
+namespace detail {
+    /*
+        Kernels behind the contiguous-buffer BPSK/QPSK mappers of psk.hpp.
+        Bytes hold one bit each; words hold 64 bits, bit i in bit (i % 64) of word i / 64.
+        Every SIMD kernel gives exactly the output of its scalar kernel, down to the
+        treatment of zero and NaN decision variables, and hands its tail to it.
+    */
+
+    constexpr std::size_t bits_per_word = packed_bit_seq_t::bits_per_word;
+
+    // Byte k is 1 when bit k of the nibble is clear.
+    constexpr std::array<uint32_t, 16> inverted_nibble_to_bytes = []() {
+        std::array<uint32_t, 16> table{};
+        for (uint32_t nibble = 0; nibble < 16; ++nibble) {
+            for (uint32_t k = 0; k < 4; ++k) {
+                table[nibble] |= static_cast<uint32_t>(((nibble >> k) & 1U) == 0) << (8 * k);
+            }
+        }
+        return table;
+    }();
+
+    // Bit k of the nibble to bits 2k and 2k + 1, masks one complex sample per bit.
+    constexpr std::array<uint8_t, 16> nibble_to_pair_mask = []() {
+        std::array<uint8_t, 16> table{};
+        for (uint32_t nibble = 0; nibble < 16; ++nibble) {
+            for (uint32_t k = 0; k < 4; ++k) {
+                table[nibble] = static_cast<uint8_t>(table[nibble] | (((nibble >> k) & 1U) * 3U) << (2 * k));
+            }
+        }
+        return table;
+    }();
+
+    // Bit k of a byte to bit 2k, interleaves the real and imaginary decisions of split I/Q symbols
+    constexpr std::array<uint16_t, 256> byte_to_even_bits = []() {
+        std::array<uint16_t, 256> table{};
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            for (uint32_t k = 0; k < 8; ++k) {
+                table[byte] = static_cast<uint16_t>(table[byte] | ((byte >> k) & 1U) << (2 * k));
+            }
+        }
+        return table;
+    }();
+
+    // std::vector of T, or complex_signal_seq_t whose allocator may be FFTW's
+    template<typename T>
+    using sequence_of_t = std::conditional_t<std::is_same_v<T, complex_signal_t>, complex_signal_seq_t, std::vector<T>>;
+
+    // Pointers and vector iterators to T, whose ranges the kernels can take as plain pointers.
+    template<typename Iterator, typename T>
+    constexpr bool is_contiguous_output_v = std::is_same_v<Iterator, T*> || std::is_same_v<Iterator, typename std::vector<T>::iterator> ||
+        std::is_same_v<Iterator, typename sequence_of_t<T>::iterator>;
+
+    template<typename Iterator, typename T>
+    constexpr bool is_contiguous_input_v = is_contiguous_output_v<Iterator, T> ||
+        std::is_same_v<Iterator, const T*> || std::is_same_v<Iterator, typename std::vector<T>::const_iterator> ||
+        std::is_same_v<Iterator, typename sequence_of_t<T>::const_iterator>;
+
+    inline double* as_doubles(complex_signal_t* symbols) {
+        // std::complex<double> is an array of two doubles, [complex.numbers]
+        return reinterpret_cast<double*>(symbols);
+    }
+
+    inline const double* as_doubles(const complex_signal_t* symbols) {
+        return reinterpret_cast<const double*>(symbols);
+    }
+
+    // Scalar kernels
+
+    inline
+    void bpsk_modulation_scalar(const bit_t* bits, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            symbols[i] = (bits[i] == 0) ? complex_signal_t(-c, -s) : complex_signal_t(c, s);
+        }
+    }
+
+    inline
+    void bpsk_demodulation_scalar(const complex_signal_t* symbols, const std::size_t n, bit_t* bits, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            bits[i] = (symbols[i].imag() * s + symbols[i].real() * c < 0) ? 0 : 1;
+        }
+    }
+
+    // n is the number of bits, two per symbol
+    inline
+    void qpsk_modulation_scalar(const bit_t* bits, const std::size_t n, complex_signal_t* symbols) {
+        const double scale = 1/std::sqrt(2);
+        for (std::size_t i = 0; i < n / 2; ++i) {
+            const double val1 = 1 - 2 * bits[2 * i];
+            const double val2 = 1 - 2 * bits[2 * i + 1];
+            symbols[i] = complex_signal_t(scale * val1, scale * val2);
+        }
+    }
+
+    // n is the number of symbols
+    inline
+    void qpsk_demodulation_scalar(const complex_signal_t* symbols, const std::size_t n, bit_t* bits) {
+        for (std::size_t i = 0; i < n; ++i) {
+            bits[2 * i] = (symbols[i].real() > 0) ? 0 : 1;
+            bits[2 * i + 1] = (symbols[i].imag() > 0) ? 0 : 1;
+        }
+    }
+
+    inline
+    void bpsk_modulation_words_scalar(const uint64_t* words, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto bit = (words[i / bits_per_word] >> (i % bits_per_word)) & 1U;
+            symbols[i] = (bit == 0) ? complex_signal_t(-c, -s) : complex_signal_t(c, s);
+        }
+    }
+
+    inline
+    void bpsk_demodulation_words_scalar(const complex_signal_t* symbols, const std::size_t n, uint64_t* words, const double c, const double s) {
+        for (std::size_t first = 0; first < n; first += bits_per_word) {
+            const std::size_t last = std::min(first + bits_per_word, n);
+            uint64_t word = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const auto bit = static_cast<uint64_t>(!(symbols[i].imag() * s + symbols[i].real() * c < 0));
+                word |= bit << (i - first);
+            }
+            words[first / bits_per_word] = word;
+        }
+    }
+
+    // n is the number of bits, two per symbol; a symbol never straddles two words since 64 is even
+    inline
+    void qpsk_modulation_words_scalar(const uint64_t* words, const std::size_t n, complex_signal_t* symbols) {
+        const double scale = 1/std::sqrt(2);
+        for (std::size_t i = 0; i < n / 2; ++i) {
+            const auto pair = words[2 * i / bits_per_word] >> (2 * i % bits_per_word);
+            const double val1 = 1 - 2 * static_cast<double>(pair & 1U);
+            const double val2 = 1 - 2 * static_cast<double>((pair >> 1U) & 1U);
+            symbols[i] = complex_signal_t(scale * val1, scale * val2);
+        }
+    }
+
+    // n is the number of symbols
+    inline
+    void qpsk_demodulation_words_scalar(const complex_signal_t* symbols, const std::size_t n, uint64_t* words) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        for (std::size_t first = 0; first < n; first += symbols_per_word) {
+            const std::size_t last = std::min(first + symbols_per_word, n);
+            uint64_t word = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const auto bit1 = static_cast<uint64_t>(!(symbols[i].real() > 0));
+                const auto bit2 = static_cast<uint64_t>(!(symbols[i].imag() > 0));
+                word |= (bit1 | (bit2 << 1U)) << (2 * (i - first));
+            }
+            words[first / symbols_per_word] = word;
+        }
+    }
+
+#if COMM_SIMD_X86
+    // AVX2 kernels
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_modulation_avx2(const bit_t* bits, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        const __m256d base = _mm256_set_pd(s, c, s, c);
+        const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(0x8000000000000000ULL));
+        const __m256i zero = _mm256_setzero_si256();
+        double* out = as_doubles(symbols);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            int32_t four{};
+            std::memcpy(&four, bits + i, sizeof(four));
+            const __m256i lanes = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(four));
+            const __m256i zero01 = _mm256_cmpeq_epi64(_mm256_permute4x64_epi64(lanes, 0x50), zero); // b0 b0 b1 b1
+            const __m256i zero23 = _mm256_cmpeq_epi64(_mm256_permute4x64_epi64(lanes, 0xFA), zero); // b2 b2 b3 b3
+            _mm256_storeu_pd(out + 2 * i, _mm256_xor_pd(base, _mm256_castsi256_pd(_mm256_and_si256(zero01, sign))));
+            _mm256_storeu_pd(out + 2 * i + 4, _mm256_xor_pd(base, _mm256_castsi256_pd(_mm256_and_si256(zero23, sign))));
+        }
+        bpsk_modulation_scalar(bits + i, n - i, symbols + i, c, s);
+    }
+
+    // Decision variables imag * s + real * c of four symbols, in order
+    COMM_TARGET_AVX2 inline
+    __m256d bpsk_decision_avx2(const double* in, const __m256d c, const __m256d s) {
+        const __m256d v0 = _mm256_loadu_pd(in);
+        const __m256d v1 = _mm256_loadu_pd(in + 4);
+        const __m256d re = _mm256_permute4x64_pd(_mm256_unpacklo_pd(v0, v1), 0xD8);
+        const __m256d im = _mm256_permute4x64_pd(_mm256_unpackhi_pd(v0, v1), 0xD8);
+        return _mm256_add_pd(_mm256_mul_pd(im, s), _mm256_mul_pd(re, c));
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_demodulation_avx2(const complex_signal_t* symbols, const std::size_t n, bit_t* bits, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        const double* in = as_doubles(symbols);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const auto negative = _mm256_movemask_pd(_mm256_cmp_pd(bpsk_decision_avx2(in + 2 * i, vc, vs), _mm256_setzero_pd(), _CMP_LT_OQ));
+            std::memcpy(bits + i, &inverted_nibble_to_bytes[static_cast<std::size_t>(negative)], 4);
+        }
+        bpsk_demodulation_scalar(symbols + i, n - i, bits + i, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_modulation_avx2(const bit_t* bits, const std::size_t n, complex_signal_t* symbols) {
+        const __m256d scale = _mm256_set1_pd(1/std::sqrt(2));
+        double* out = as_doubles(symbols);
+        // bit j is the real or imaginary part j of the output
+        std::size_t j = 0;
+        for (; j + 4 <= n; j += 4) {
+            int32_t four{};
+            std::memcpy(&four, bits + j, sizeof(four));
+            const __m256d value = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(four)));
+            const __m256d sign = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(2.0), value));
+            _mm256_storeu_pd(out + j, _mm256_mul_pd(scale, sign));
+        }
+        qpsk_modulation_scalar(bits + j, n - j, symbols + j / 2);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_demodulation_avx2(const complex_signal_t* symbols, const std::size_t n, bit_t* bits) {
+        const double* in = as_doubles(symbols);
+        std::size_t j = 0;
+        for (; j + 4 <= 2 * n; j += 4) {
+            const auto positive = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(in + j), _mm256_setzero_pd(), _CMP_GT_OQ));
+            std::memcpy(bits + j, &inverted_nibble_to_bytes[static_cast<std::size_t>(positive)], 4);
+        }
+        qpsk_demodulation_scalar(symbols + j / 2, n - j / 2, bits + j);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_modulation_words_avx2(const uint64_t* words, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        const __m256d base = _mm256_set_pd(s, c, s, c);
+        const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(0x8000000000000000ULL));
+        const __m256i select = _mm256_set_epi64x(2, 2, 1, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        double* out = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 2) {
+                const __m256i pair = _mm256_set1_epi64x(static_cast<int64_t>((word >> k) & 3U));
+                const __m256i is_zero = _mm256_cmpeq_epi64(_mm256_and_si256(pair, select), zero);
+                _mm256_storeu_pd(out + 2 * (w * bits_per_word + k), _mm256_xor_pd(base, _mm256_castsi256_pd(_mm256_and_si256(is_zero, sign))));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_modulation_words_scalar(words + num_of_words, n - done, symbols + done, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_demodulation_words_avx2(const complex_signal_t* symbols, const std::size_t n, uint64_t* words, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        const double* in = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __m256d decision = bpsk_decision_avx2(in + 2 * (w * bits_per_word + k), vc, vs);
+                word |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(decision, _mm256_setzero_pd(), _CMP_NLT_UQ))) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_demodulation_words_scalar(symbols + done, n - done, words + num_of_words, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_modulation_words_avx2(const uint64_t* words, const std::size_t n, complex_signal_t* symbols) {
+        const __m256d positive = _mm256_set1_pd(1/std::sqrt(2));
+        const __m256d negative = _mm256_set1_pd(-1/std::sqrt(2));
+        const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        double* out = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __m256i nibble = _mm256_set1_epi64x(static_cast<int64_t>((word >> k) & 15U));
+                const __m256i is_zero = _mm256_cmpeq_epi64(_mm256_and_si256(nibble, select), zero);
+                _mm256_storeu_pd(out + w * bits_per_word + k, _mm256_blendv_pd(negative, positive, _mm256_castsi256_pd(is_zero)));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        qpsk_modulation_words_scalar(words + num_of_words, n - done, symbols + done / 2);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_demodulation_words_avx2(const complex_signal_t* symbols, const std::size_t n, uint64_t* words) {
+        const double* in = as_doubles(symbols);
+        const std::size_t num_of_words = 2 * n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __m256d value = _mm256_loadu_pd(in + w * bits_per_word + k);
+                word |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(value, _mm256_setzero_pd(), _CMP_NGT_UQ))) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word / 2;
+        qpsk_demodulation_words_scalar(symbols + done, n - done, words + num_of_words);
+    }
+
+    // AVX-512 kernels
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_modulation_avx512(const bit_t* bits, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        const __m512d base = _mm512_set_pd(s, c, s, c, s, c, s, c);
+        const __m512d negated = _mm512_set_pd(-s, -c, -s, -c, -s, -c, -s, -c);
+        double* out = as_doubles(symbols);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512i lanes = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bits + i)));
+            const auto ones = static_cast<uint32_t>(_mm512_test_epi64_mask(lanes, lanes));
+            _mm512_storeu_pd(out + 2 * i, _mm512_mask_blend_pd(nibble_to_pair_mask[ones & 15U], negated, base));
+            _mm512_storeu_pd(out + 2 * i + 8, _mm512_mask_blend_pd(nibble_to_pair_mask[ones >> 4U], negated, base));
+        }
+        bpsk_modulation_scalar(bits + i, n - i, symbols + i, c, s);
+    }
+
+    // Decision variables imag * s + real * c of eight symbols, in order
+    COMM_TARGET_AVX512 inline
+    __m512d bpsk_decision_avx512(const double* in, const __m512d c, const __m512d s) {
+        const __m512i even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+        const __m512i odd = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+        const __m512d v0 = _mm512_loadu_pd(in);
+        const __m512d v1 = _mm512_loadu_pd(in + 8);
+        const __m512d re = _mm512_permutex2var_pd(v0, even, v1);
+        const __m512d im = _mm512_permutex2var_pd(v0, odd, v1);
+        return _mm512_add_pd(_mm512_mul_pd(im, s), _mm512_mul_pd(re, c));
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_demodulation_avx512(const complex_signal_t* symbols, const std::size_t n, bit_t* bits, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        const double* in = as_doubles(symbols);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __mmask8 ones = _mm512_cmp_pd_mask(bpsk_decision_avx512(in + 2 * i, vc, vs), _mm512_setzero_pd(), _CMP_NLT_UQ);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bits + i), _mm_maskz_mov_epi8(ones, _mm_set1_epi8(1)));
+        }
+        bpsk_demodulation_scalar(symbols + i, n - i, bits + i, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_modulation_avx512(const bit_t* bits, const std::size_t n, complex_signal_t* symbols) {
+        const __m512d scale = _mm512_set1_pd(1/std::sqrt(2));
+        double* out = as_doubles(symbols);
+        std::size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+            const __m512d value = _mm512_cvtepi32_pd(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bits + j))));
+            const __m512d sign = _mm512_sub_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(_mm512_set1_pd(2.0), value));
+            _mm512_storeu_pd(out + j, _mm512_mul_pd(scale, sign));
+        }
+        qpsk_modulation_scalar(bits + j, n - j, symbols + j / 2);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_demodulation_avx512(const complex_signal_t* symbols, const std::size_t n, bit_t* bits) {
+        const double* in = as_doubles(symbols);
+        std::size_t j = 0;
+        for (; j + 8 <= 2 * n; j += 8) {
+            const __mmask8 ones = _mm512_cmp_pd_mask(_mm512_loadu_pd(in + j), _mm512_setzero_pd(), _CMP_NGT_UQ);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bits + j), _mm_maskz_mov_epi8(ones, _mm_set1_epi8(1)));
+        }
+        qpsk_demodulation_scalar(symbols + j / 2, n - j / 2, bits + j);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_modulation_words_avx512(const uint64_t* words, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        const __m512d base = _mm512_set_pd(s, c, s, c, s, c, s, c);
+        const __m512d negated = _mm512_set_pd(-s, -c, -s, -c, -s, -c, -s, -c);
+        double* out = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __mmask8 ones = nibble_to_pair_mask[(word >> k) & 15U];
+                _mm512_storeu_pd(out + 2 * (w * bits_per_word + k), _mm512_mask_blend_pd(ones, negated, base));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_modulation_words_scalar(words + num_of_words, n - done, symbols + done, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_demodulation_words_avx512(const complex_signal_t* symbols, const std::size_t n, uint64_t* words, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        const double* in = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 8) {
+                const __m512d decision = bpsk_decision_avx512(in + 2 * (w * bits_per_word + k), vc, vs);
+                word |= static_cast<uint64_t>(_mm512_cmp_pd_mask(decision, _mm512_setzero_pd(), _CMP_NLT_UQ)) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_demodulation_words_scalar(symbols + done, n - done, words + num_of_words, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_modulation_words_avx512(const uint64_t* words, const std::size_t n, complex_signal_t* symbols) {
+        const __m512d positive = _mm512_set1_pd(1/std::sqrt(2));
+        const __m512d negative = _mm512_set1_pd(-1/std::sqrt(2));
+        double* out = as_doubles(symbols);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 8) {
+                const auto ones = static_cast<__mmask8>((word >> k) & 0xFFU);
+                _mm512_storeu_pd(out + w * bits_per_word + k, _mm512_mask_blend_pd(ones, positive, negative));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        qpsk_modulation_words_scalar(words + num_of_words, n - done, symbols + done / 2);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_demodulation_words_avx512(const complex_signal_t* symbols, const std::size_t n, uint64_t* words) {
+        const double* in = as_doubles(symbols);
+        const std::size_t num_of_words = 2 * n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 8) {
+                word |= static_cast<uint64_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(in + w * bits_per_word + k), _mm512_setzero_pd(), _CMP_NGT_UQ)) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word / 2;
+        qpsk_demodulation_words_scalar(symbols + done, n - done, words + num_of_words);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+    /*
+        Split I/Q kernels, the same mappings on separate real and imaginary arrays.
+        Lanes load and store straight from the arrays, with no interleaving shuffles.
+    */
+
+    inline
+    void bpsk_modulation_split_scalar(const bit_t* bits, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            real[i] = (bits[i] == 0) ? -c : c;
+            imag[i] = (bits[i] == 0) ? -s : s;
+        }
+    }
+
+    inline
+    void bpsk_demodulation_split_scalar(const double* real, const double* imag, const std::size_t n, bit_t* bits, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            bits[i] = (imag[i] * s + real[i] * c < 0) ? 0 : 1;
+        }
+    }
+
+    // n is the number of bits, two per symbol
+    inline
+    void qpsk_modulation_split_scalar(const bit_t* bits, const std::size_t n, double* real, double* imag) {
+        const double scale = 1/std::sqrt(2);
+        for (std::size_t i = 0; i < n / 2; ++i) {
+            real[i] = scale * (1 - 2 * bits[2 * i]);
+            imag[i] = scale * (1 - 2 * bits[2 * i + 1]);
+        }
+    }
+
+    // n is the number of symbols
+    inline
+    void qpsk_demodulation_split_scalar(const double* real, const double* imag, const std::size_t n, bit_t* bits) {
+        for (std::size_t i = 0; i < n; ++i) {
+            bits[2 * i] = (real[i] > 0) ? 0 : 1;
+            bits[2 * i + 1] = (imag[i] > 0) ? 0 : 1;
+        }
+    }
+
+    inline
+    void bpsk_modulation_words_split_scalar(const uint64_t* words, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto bit = (words[i / bits_per_word] >> (i % bits_per_word)) & 1U;
+            real[i] = (bit == 0) ? -c : c;
+            imag[i] = (bit == 0) ? -s : s;
+        }
+    }
+
+    inline
+    void bpsk_demodulation_words_split_scalar(const double* real, const double* imag, const std::size_t n, uint64_t* words, const double c, const double s) {
+        for (std::size_t first = 0; first < n; first += bits_per_word) {
+            const std::size_t last = std::min(first + bits_per_word, n);
+            uint64_t word = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                word |= static_cast<uint64_t>(!(imag[i] * s + real[i] * c < 0)) << (i - first);
+            }
+            words[first / bits_per_word] = word;
+        }
+    }
+
+    // n is the number of bits, two per symbol
+    inline
+    void qpsk_modulation_words_split_scalar(const uint64_t* words, const std::size_t n, double* real, double* imag) {
+        const double scale = 1/std::sqrt(2);
+        for (std::size_t i = 0; i < n / 2; ++i) {
+            const auto pair = words[2 * i / bits_per_word] >> (2 * i % bits_per_word);
+            real[i] = scale * (1 - 2 * static_cast<double>(pair & 1U));
+            imag[i] = scale * (1 - 2 * static_cast<double>((pair >> 1U) & 1U));
+        }
+    }
+
+    // n is the number of symbols
+    inline
+    void qpsk_demodulation_words_split_scalar(const double* real, const double* imag, const std::size_t n, uint64_t* words) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        for (std::size_t first = 0; first < n; first += symbols_per_word) {
+            const std::size_t last = std::min(first + symbols_per_word, n);
+            uint64_t word = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const auto bit1 = static_cast<uint64_t>(!(real[i] > 0));
+                const auto bit2 = static_cast<uint64_t>(!(imag[i] > 0));
+                word |= (bit1 | (bit2 << 1U)) << (2 * (i - first));
+            }
+            words[first / symbols_per_word] = word;
+        }
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void bpsk_modulation_split_avx2(const bit_t* bits, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(0x8000000000000000ULL));
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            int32_t four{};
+            std::memcpy(&four, bits + i, sizeof(four));
+            const __m256i is_zero = _mm256_cmpeq_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(four)), _mm256_setzero_si256());
+            const __m256d flip = _mm256_castsi256_pd(_mm256_and_si256(is_zero, sign));
+            _mm256_storeu_pd(real + i, _mm256_xor_pd(vc, flip));
+            _mm256_storeu_pd(imag + i, _mm256_xor_pd(vs, flip));
+        }
+        bpsk_modulation_split_scalar(bits + i, n - i, real + i, imag + i, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_demodulation_split_avx2(const double* real, const double* imag, const std::size_t n, bit_t* bits, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d decision = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(imag + i), vs), _mm256_mul_pd(_mm256_loadu_pd(real + i), vc));
+            const auto negative = _mm256_movemask_pd(_mm256_cmp_pd(decision, _mm256_setzero_pd(), _CMP_LT_OQ));
+            std::memcpy(bits + i, &inverted_nibble_to_bytes[static_cast<std::size_t>(negative)], 4);
+        }
+        bpsk_demodulation_split_scalar(real + i, imag + i, n - i, bits + i, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_modulation_split_avx2(const bit_t* bits, const std::size_t n, double* real, double* imag) {
+        const __m256d scale = _mm256_set1_pd(1/std::sqrt(2));
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d two = _mm256_set1_pd(2.0);
+        // even bytes to the low four, odd bytes to the next four
+        const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 1, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+        std::size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+            const __m128i pairs = _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bits + j)), split);
+            const __m256d first = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(pairs));
+            const __m256d second = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_srli_si128(pairs, 4)));
+            _mm256_storeu_pd(real + j / 2, _mm256_mul_pd(scale, _mm256_sub_pd(one, _mm256_mul_pd(two, first))));
+            _mm256_storeu_pd(imag + j / 2, _mm256_mul_pd(scale, _mm256_sub_pd(one, _mm256_mul_pd(two, second))));
+        }
+        qpsk_modulation_split_scalar(bits + j, n - j, real + j / 2, imag + j / 2);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_demodulation_split_avx2(const double* real, const double* imag, const std::size_t n, bit_t* bits) {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const auto re = static_cast<std::size_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(real + i), _mm256_setzero_pd(), _CMP_GT_OQ)));
+            const auto im = static_cast<std::size_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(imag + i), _mm256_setzero_pd(), _CMP_GT_OQ)));
+            const uint32_t positive = byte_to_even_bits[re] | (byte_to_even_bits[im] << 1U);
+            std::memcpy(bits + 2 * i, &inverted_nibble_to_bytes[positive & 15U], 4);
+            std::memcpy(bits + 2 * i + 4, &inverted_nibble_to_bytes[positive >> 4U], 4);
+        }
+        qpsk_demodulation_split_scalar(real + i, imag + i, n - i, bits + 2 * i);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_modulation_words_split_avx2(const uint64_t* words, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(0x8000000000000000ULL));
+        const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __m256i nibble = _mm256_set1_epi64x(static_cast<int64_t>((word >> k) & 15U));
+                const __m256i is_zero = _mm256_cmpeq_epi64(_mm256_and_si256(nibble, select), zero);
+                const __m256d flip = _mm256_castsi256_pd(_mm256_and_si256(is_zero, sign));
+                _mm256_storeu_pd(real + w * bits_per_word + k, _mm256_xor_pd(vc, flip));
+                _mm256_storeu_pd(imag + w * bits_per_word + k, _mm256_xor_pd(vs, flip));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_modulation_words_split_scalar(words + num_of_words, n - done, real + done, imag + done, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void bpsk_demodulation_words_split_avx2(const double* real, const double* imag, const std::size_t n, uint64_t* words, const double c, const double s) {
+        const __m256d vc = _mm256_set1_pd(c);
+        const __m256d vs = _mm256_set1_pd(s);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const double* re = real + w * bits_per_word;
+            const double* im = imag + w * bits_per_word;
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 4) {
+                const __m256d decision = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(im + k), vs), _mm256_mul_pd(_mm256_loadu_pd(re + k), vc));
+                word |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(decision, _mm256_setzero_pd(), _CMP_NLT_UQ))) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_demodulation_words_split_scalar(real + done, imag + done, n - done, words + num_of_words, c, s);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_modulation_words_split_avx2(const uint64_t* words, const std::size_t n, double* real, double* imag) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        const __m256d positive = _mm256_set1_pd(1/std::sqrt(2));
+        const __m256d negative = _mm256_set1_pd(-1/std::sqrt(2));
+        const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t re = even_bits(words[w]);
+            const uint64_t im = even_bits(words[w] >> 1U);
+            for (std::size_t k = 0; k < symbols_per_word; k += 4) {
+                const __m256i re_zero = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>((re >> k) & 15U)), select), zero);
+                const __m256i im_zero = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>((im >> k) & 15U)), select), zero);
+                _mm256_storeu_pd(real + w * symbols_per_word + k, _mm256_blendv_pd(negative, positive, _mm256_castsi256_pd(re_zero)));
+                _mm256_storeu_pd(imag + w * symbols_per_word + k, _mm256_blendv_pd(negative, positive, _mm256_castsi256_pd(im_zero)));
+            }
+        }
+        const std::size_t done = num_of_words * symbols_per_word;
+        qpsk_modulation_words_split_scalar(words + num_of_words, n - 2 * done, real + done, imag + done);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void qpsk_demodulation_words_split_avx2(const double* real, const double* imag, const std::size_t n, uint64_t* words) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        const std::size_t num_of_words = n / symbols_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const double* re = real + w * symbols_per_word;
+            const double* im = imag + w * symbols_per_word;
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < symbols_per_word; k += 8) {
+                const auto re_ones = static_cast<std::size_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(re + k), _mm256_setzero_pd(), _CMP_NGT_UQ)) |
+                                                              (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(re + k + 4), _mm256_setzero_pd(), _CMP_NGT_UQ)) << 4));
+                const auto im_ones = static_cast<std::size_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(im + k), _mm256_setzero_pd(), _CMP_NGT_UQ)) |
+                                                              (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(im + k + 4), _mm256_setzero_pd(), _CMP_NGT_UQ)) << 4));
+                word |= static_cast<uint64_t>(byte_to_even_bits[re_ones] | (byte_to_even_bits[im_ones] << 1U)) << (2 * k);
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * symbols_per_word;
+        qpsk_demodulation_words_split_scalar(real + done, imag + done, n - done, words + num_of_words);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_modulation_split_avx512(const bit_t* bits, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        const __m512d negated_c = _mm512_set1_pd(-c);
+        const __m512d negated_s = _mm512_set1_pd(-s);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512i lanes = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bits + i)));
+            const __mmask8 ones = _mm512_test_epi64_mask(lanes, lanes);
+            _mm512_storeu_pd(real + i, _mm512_mask_blend_pd(ones, negated_c, vc));
+            _mm512_storeu_pd(imag + i, _mm512_mask_blend_pd(ones, negated_s, vs));
+        }
+        bpsk_modulation_split_scalar(bits + i, n - i, real + i, imag + i, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_demodulation_split_avx512(const double* real, const double* imag, const std::size_t n, bit_t* bits, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512d decision = _mm512_add_pd(_mm512_mul_pd(_mm512_loadu_pd(imag + i), vs), _mm512_mul_pd(_mm512_loadu_pd(real + i), vc));
+            const __mmask8 ones = _mm512_cmp_pd_mask(decision, _mm512_setzero_pd(), _CMP_NLT_UQ);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bits + i), _mm_maskz_mov_epi8(ones, _mm_set1_epi8(1)));
+        }
+        bpsk_demodulation_split_scalar(real + i, imag + i, n - i, bits + i, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_modulation_split_avx512(const bit_t* bits, const std::size_t n, double* real, double* imag) {
+        const __m512d scale = _mm512_set1_pd(1/std::sqrt(2));
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512d two = _mm512_set1_pd(2.0);
+        // even bytes to the low eight, odd bytes to the high eight
+        const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        std::size_t j = 0;
+        for (; j + 16 <= n; j += 16) {
+            const __m128i pairs = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + j)), split);
+            const __m512d first = _mm512_cvtepi32_pd(_mm256_cvtepu8_epi32(pairs));
+            const __m512d second = _mm512_cvtepi32_pd(_mm256_cvtepu8_epi32(_mm_srli_si128(pairs, 8)));
+            _mm512_storeu_pd(real + j / 2, _mm512_mul_pd(scale, _mm512_sub_pd(one, _mm512_mul_pd(two, first))));
+            _mm512_storeu_pd(imag + j / 2, _mm512_mul_pd(scale, _mm512_sub_pd(one, _mm512_mul_pd(two, second))));
+        }
+        qpsk_modulation_split_scalar(bits + j, n - j, real + j / 2, imag + j / 2);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_demodulation_split_avx512(const double* real, const double* imag, const std::size_t n, bit_t* bits) {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const auto re = static_cast<std::size_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(real + i), _mm512_setzero_pd(), _CMP_NGT_UQ));
+            const auto im = static_cast<std::size_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(imag + i), _mm512_setzero_pd(), _CMP_NGT_UQ));
+            const auto ones = static_cast<__mmask16>(byte_to_even_bits[re] | (byte_to_even_bits[im] << 1U));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bits + 2 * i), _mm_maskz_mov_epi8(ones, _mm_set1_epi8(1)));
+        }
+        qpsk_demodulation_split_scalar(real + i, imag + i, n - i, bits + 2 * i);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_modulation_words_split_avx512(const uint64_t* words, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        const __m512d negated_c = _mm512_set1_pd(-c);
+        const __m512d negated_s = _mm512_set1_pd(-s);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t word = words[w];
+            for (std::size_t k = 0; k < bits_per_word; k += 8) {
+                const auto ones = static_cast<__mmask8>((word >> k) & 0xFFU);
+                _mm512_storeu_pd(real + w * bits_per_word + k, _mm512_mask_blend_pd(ones, negated_c, vc));
+                _mm512_storeu_pd(imag + w * bits_per_word + k, _mm512_mask_blend_pd(ones, negated_s, vs));
+            }
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_modulation_words_split_scalar(words + num_of_words, n - done, real + done, imag + done, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void bpsk_demodulation_words_split_avx512(const double* real, const double* imag, const std::size_t n, uint64_t* words, const double c, const double s) {
+        const __m512d vc = _mm512_set1_pd(c);
+        const __m512d vs = _mm512_set1_pd(s);
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const double* re = real + w * bits_per_word;
+            const double* im = imag + w * bits_per_word;
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < bits_per_word; k += 8) {
+                const __m512d decision = _mm512_add_pd(_mm512_mul_pd(_mm512_loadu_pd(im + k), vs), _mm512_mul_pd(_mm512_loadu_pd(re + k), vc));
+                word |= static_cast<uint64_t>(_mm512_cmp_pd_mask(decision, _mm512_setzero_pd(), _CMP_NLT_UQ)) << k;
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * bits_per_word;
+        bpsk_demodulation_words_split_scalar(real + done, imag + done, n - done, words + num_of_words, c, s);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_modulation_words_split_avx512(const uint64_t* words, const std::size_t n, double* real, double* imag) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        const __m512d positive = _mm512_set1_pd(1/std::sqrt(2));
+        const __m512d negative = _mm512_set1_pd(-1/std::sqrt(2));
+        const std::size_t num_of_words = n / bits_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const uint64_t re = even_bits(words[w]);
+            const uint64_t im = even_bits(words[w] >> 1U);
+            for (std::size_t k = 0; k < symbols_per_word; k += 8) {
+                _mm512_storeu_pd(real + w * symbols_per_word + k, _mm512_mask_blend_pd(static_cast<__mmask8>((re >> k) & 0xFFU), positive, negative));
+                _mm512_storeu_pd(imag + w * symbols_per_word + k, _mm512_mask_blend_pd(static_cast<__mmask8>((im >> k) & 0xFFU), positive, negative));
+            }
+        }
+        const std::size_t done = num_of_words * symbols_per_word;
+        qpsk_modulation_words_split_scalar(words + num_of_words, n - 2 * done, real + done, imag + done);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void qpsk_demodulation_words_split_avx512(const double* real, const double* imag, const std::size_t n, uint64_t* words) {
+        constexpr std::size_t symbols_per_word = bits_per_word / 2;
+        const std::size_t num_of_words = n / symbols_per_word;
+        for (std::size_t w = 0; w < num_of_words; ++w) {
+            const double* re = real + w * symbols_per_word;
+            const double* im = imag + w * symbols_per_word;
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < symbols_per_word; k += 8) {
+                const auto re_ones = static_cast<std::size_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(re + k), _mm512_setzero_pd(), _CMP_NGT_UQ));
+                const auto im_ones = static_cast<std::size_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(im + k), _mm512_setzero_pd(), _CMP_NGT_UQ));
+                word |= static_cast<uint64_t>(byte_to_even_bits[re_ones] | (byte_to_even_bits[im_ones] << 1U)) << (2 * k);
+            }
+            words[w] = word;
+        }
+        const std::size_t done = num_of_words * symbols_per_word;
+        qpsk_demodulation_words_split_scalar(real + done, imag + done, n - done, words + num_of_words);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+
+// Call the widest kernel the CPU supports
+#if COMM_SIMD_X86
+#define COMM_PSK_DISPATCH(name, ...)                    \
+    switch (active_simd_isa()) {                        \
+        case simd_isa::avx512:                          \
+            name##_avx512(__VA_ARGS__);                 \
+            return;                                     \
+        case simd_isa::avx2:                            \
+            name##_avx2(__VA_ARGS__);                   \
+            return;                                     \
+        default:                                        \
+            name##_scalar(__VA_ARGS__);                 \
+            return;                                     \
+    }
+#else
+#define COMM_PSK_DISPATCH(name, ...) name##_scalar(__VA_ARGS__);
+#endif
+
+    inline
+    void bpsk_modulation_kernel(const bit_t* bits, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_modulation, bits, n, symbols, c, s)
+    }
+
+    inline
+    void bpsk_demodulation_kernel(const complex_signal_t* symbols, const std::size_t n, bit_t* bits, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_demodulation, symbols, n, bits, c, s)
+    }
+
+    inline
+    void qpsk_modulation_kernel(const bit_t* bits, const std::size_t n, complex_signal_t* symbols) {
+        COMM_PSK_DISPATCH(qpsk_modulation, bits, n, symbols)
+    }
+
+    inline
+    void qpsk_demodulation_kernel(const complex_signal_t* symbols, const std::size_t n, bit_t* bits) {
+        COMM_PSK_DISPATCH(qpsk_demodulation, symbols, n, bits)
+    }
+
+    inline
+    void bpsk_modulation_words_kernel(const uint64_t* words, const std::size_t n, complex_signal_t* symbols, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_modulation_words, words, n, symbols, c, s)
+    }
+
+    inline
+    void bpsk_demodulation_words_kernel(const complex_signal_t* symbols, const std::size_t n, uint64_t* words, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_demodulation_words, symbols, n, words, c, s)
+    }
+
+    inline
+    void qpsk_modulation_words_kernel(const uint64_t* words, const std::size_t n, complex_signal_t* symbols) {
+        COMM_PSK_DISPATCH(qpsk_modulation_words, words, n, symbols)
+    }
+
+    inline
+    void qpsk_demodulation_words_kernel(const complex_signal_t* symbols, const std::size_t n, uint64_t* words) {
+        COMM_PSK_DISPATCH(qpsk_demodulation_words, symbols, n, words)
+    }
+
+    inline
+    void bpsk_modulation_split_kernel(const bit_t* bits, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_modulation_split, bits, n, real, imag, c, s)
+    }
+
+    inline
+    void bpsk_demodulation_split_kernel(const double* real, const double* imag, const std::size_t n, bit_t* bits, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_demodulation_split, real, imag, n, bits, c, s)
+    }
+
+    inline
+    void qpsk_modulation_split_kernel(const bit_t* bits, const std::size_t n, double* real, double* imag) {
+        COMM_PSK_DISPATCH(qpsk_modulation_split, bits, n, real, imag)
+    }
+
+    inline
+    void qpsk_demodulation_split_kernel(const double* real, const double* imag, const std::size_t n, bit_t* bits) {
+        COMM_PSK_DISPATCH(qpsk_demodulation_split, real, imag, n, bits)
+    }
+
+    inline
+    void bpsk_modulation_words_split_kernel(const uint64_t* words, const std::size_t n, double* real, double* imag, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_modulation_words_split, words, n, real, imag, c, s)
+    }
+
+    inline
+    void bpsk_demodulation_words_split_kernel(const double* real, const double* imag, const std::size_t n, uint64_t* words, const double c, const double s) {
+        COMM_PSK_DISPATCH(bpsk_demodulation_words_split, real, imag, n, words, c, s)
+    }
+
+    inline
+    void qpsk_modulation_words_split_kernel(const uint64_t* words, const std::size_t n, double* real, double* imag) {
+        COMM_PSK_DISPATCH(qpsk_modulation_words_split, words, n, real, imag)
+    }
+
+    inline
+    void qpsk_demodulation_words_split_kernel(const double* real, const double* imag, const std::size_t n, uint64_t* words) {
+        COMM_PSK_DISPATCH(qpsk_demodulation_words_split, real, imag, n, words)
+    }
+
+#undef COMM_PSK_DISPATCH
+}
+}
+
+#endif // INCLUDE_PSK_KERNELS_HPP
@@ -0,0 +1,190 @@
+#ifndef INCLUDE_PULSE_SHAPING_HPP
+#define INCLUDE_PULSE_SHAPING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "definitions.h"
+#include "fir.hpp"
+
+namespace comm {
+
+/**
+ * @brief Root-raised-cosine taps over span symbols, span * samples_per_symbol + 1 of them, with unit energy.
+ *
+ * A pulse through its own matched filter is a raised cosine: one at the peak and zero at
+ * the other multiples of the symbol period, up to the truncation to span symbols.
+ */
+inline std::vector<double> rrc_taps(const double rolloff, const std::size_t samples_per_symbol, const std::size_t span) {
+    if (rolloff < 0.0 || rolloff > 1.0 || samples_per_symbol == 0 || span == 0) {
+        throw std::invalid_argument("RRC needs a roll-off in [0, 1], samples per symbol and a span");
+    }
+    constexpr double pi = 3.14159265358979323846;
+    const std::size_t size = span * samples_per_symbol + 1;
+    std::vector<double> taps(size);
+    for (std::size_t k = 0; k < size; ++k) {
+        // in symbol periods from the center
+        const double t = (static_cast<double>(k) - static_cast<double>(size - 1) / 2) / static_cast<double>(samples_per_symbol);
+        if (std::abs(t) < 1e-12) {
+            taps[k] = 1 - rolloff + 4 * rolloff / pi;
+        } else if (rolloff > 0.0 && std::abs(std::abs(t) - 1 / (4 * rolloff)) < 1e-12) {
+            taps[k] = rolloff / std::sqrt(2.0) * ((1 + 2 / pi) * std::sin(pi / (4 * rolloff)) + (1 - 2 / pi) * std::cos(pi / (4 * rolloff)));
+        } else {
+            const double x = 4 * rolloff * t;
+            taps[k] = (std::sin(pi * t * (1 - rolloff)) + x * std::cos(pi * t * (1 + rolloff))) / (pi * t * (1 - x * x));
+        }
+    }
+    double energy = 0.0;
+    for (const double tap : taps) {
+        energy += tap * tap;
+    }
+    const double scale = 1 / std::sqrt(energy);
+    for (auto& tap : taps) {
+        tap *= scale;
+    }
+    return taps;
+}
+
+/**
+ * @brief Upsamples symbols by samples_per_symbol through a root-raised-cosine filter.
+ *
+ * Up to fft_threshold taps the polyphase interpolator computes every sample as a dot
+ * product of span taps; longer filters zero-stuff the symbols and convolve by overlap-save.
+ * Unit energy symbols give samples of power 1 / samples_per_symbol: noise of
+ * generate_awgn_noise at Es/N0 on the samples gives Es/N0 at the matched filter output.
+ *
+ * The pulses of the last span / 2 symbols run past their samples; shape span / 2 + 1 zero
+ * symbols after the signal to send them whole.
+ */
+class pulse_shaper {
+public:
+    static constexpr std::size_t default_span = 8;
+    static constexpr std::size_t default_fft_threshold = 128;
+
+    pulse_shaper(const double rolloff, const std::size_t samples_per_symbol, const std::size_t span = default_span,
+                 const std::size_t fft_threshold = default_fft_threshold)
+        : _samples_per_symbol(samples_per_symbol), _taps(rrc_taps(rolloff, samples_per_symbol, span)) {
+        if (_taps.size() > fft_threshold) {
+            _overlap_save.emplace(std::vector<complex_signal_t>(std::cbegin(_taps), std::cend(_taps)));
+        } else {
+            _polyphase.emplace(_taps, samples_per_symbol);
+        }
+    }
+
+    std::size_t samples_per_symbol() const noexcept {
+        return _samples_per_symbol;
+    }
+
+    const std::vector<double>& taps() const noexcept {
+        return _taps;
+    }
+
+    bool uses_fft() const noexcept {
+        return _overlap_save.has_value();
+    }
+
+    // n symbols to n * samples_per_symbol samples
+    void process(const complex_signal_t* symbols, const std::size_t n, complex_signal_t* samples) {
+        if (_polyphase) {
+            _polyphase->process(symbols, n, samples);
+            return;
+        }
+        std::fill(samples, samples + n * _samples_per_symbol, complex_signal_t{});
+        for (std::size_t i = 0; i < n; ++i) {
+            samples[i * _samples_per_symbol] = symbols[i];
+        }
+        _overlap_save->process(samples, n * _samples_per_symbol);
+    }
+
+    void reset() {
+        if (_polyphase) {
+            _polyphase->reset();
+        } else {
+            _overlap_save->reset();
+        }
+    }
+
+private:
+    std::size_t _samples_per_symbol;
+    std::vector<double> _taps;
+    std::optional<polyphase_interpolator> _polyphase{};
+    std::optional<overlap_save_filter> _overlap_save{};
+};
+
+/**
+ * @brief Root-raised-cosine matched filter and decimation to one sample per symbol.
+ *
+ * Aligned with the pulse_shaper of the same parameters: the i-th symbol shaped comes out
+ * once its span following symbols have gone in, and flush() pushes the last span out.
+ */
+class matched_filter {
+public:
+    matched_filter(const double rolloff, const std::size_t samples_per_symbol, const std::size_t span = pulse_shaper::default_span,
+                   const std::size_t fft_threshold = pulse_shaper::default_fft_threshold)
+        : _samples_per_symbol(samples_per_symbol), _span(span), _taps(rrc_taps(rolloff, samples_per_symbol, span)) {
+        // the peak of shaping and matched filtering together is span symbols late
+        if (_taps.size() > fft_threshold) {
+            _overlap_save.emplace(std::vector<complex_signal_t>(std::cbegin(_taps), std::cend(_taps)));
+        } else {
+            _polyphase.emplace(_taps, samples_per_symbol, span * samples_per_symbol);
+        }
+        _next = span * samples_per_symbol;
+    }
+
+    std::size_t samples_per_symbol() const noexcept {
+        return _samples_per_symbol;
+    }
+
+    bool uses_fft() const noexcept {
+        return _overlap_save.has_value();
+    }
+
+    // Writes the symbols completed by the next n samples, at most n / samples_per_symbol + 1, and returns their number.
+    std::size_t process(const complex_signal_t* samples, const std::size_t n, complex_signal_t* symbols) {
+        if (_polyphase) {
+            return _polyphase->process(samples, n, symbols);
+        }
+        _filtered.assign(samples, samples + n);
+        _overlap_save->process(_filtered.data(), n);
+        std::size_t num_of_symbols = 0;
+        std::size_t i = _next;
+        for (; i < n; i += _samples_per_symbol) {
+            symbols[num_of_symbols++] = _filtered[i];
+        }
+        _next = i - n;
+        return num_of_symbols;
+    }
+
+    // The last span symbols, still in the filter at the end of the signal
+    std::size_t flush(complex_signal_t* symbols) {
+        const std::vector<complex_signal_t> zeros(_span * _samples_per_symbol);
+        return process(zeros.data(), zeros.size(), symbols);
+    }
+
+    void reset() {
+        if (_polyphase) {
+            _polyphase->reset();
+        } else {
+            _overlap_save->reset();
+        }
+        _next = _span * _samples_per_symbol;
+    }
+
+private:
+    std::size_t _samples_per_symbol;
+    std::size_t _span;
+    std::vector<double> _taps;
+    std::optional<polyphase_decimator> _polyphase{};
+    std::optional<overlap_save_filter> _overlap_save{};
+    std::vector<complex_signal_t> _filtered{};
+    // index in the next samples of the next symbol, for the overlap-save path
+    std::size_t _next{0};
+};
+
+}
+
+#endif // INCLUDE_PULSE_SHAPING_HPP
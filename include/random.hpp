@@ -0,0 +1,146 @@
+#ifndef INCLUDE_RANDOM_HPP
+#define INCLUDE_RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace comm {
+
+/**
+ * @brief Philox4x32-10 counter-based bijection.
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits with no state, so any
+ * block of any stream can be computed on its own, by any thread or SIMD lane.
+ *
+ * Resource: Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011.
+ */
+struct philox4x32 {
+    using counter_type = std::array<uint32_t, 4>;
+    using key_type = std::array<uint32_t, 2>;
+
+    static constexpr counter_type block(counter_type counter, key_type key) {
+        for (int32_t round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9U;
+                key[1] += 0xBB67AE85U;
+            }
+            const uint64_t product0 = static_cast<uint64_t>(0xD2511F53U) * counter[0];
+            const uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57U) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32U) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32U) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+};
+
+/**
+ * @brief Seedable random stream over Philox blocks, usable as a UniformRandomBitGenerator.
+ *
+ * Block b of stream s under seed k is philox4x32(counter = {b, s}, key = k) and gives two
+ * 64-bit words. Streams with different ids never overlap, so each thread, trial or SIMD
+ * lane gets its own stream and the output depends only on (seed, stream id, position).
+ */
+class random_stream {
+public:
+    using result_type = uint64_t;
+    using block_type = std::array<uint64_t, 2>;
+
+    constexpr random_stream() = default;
+
+    constexpr random_stream(const uint64_t seed, const uint64_t stream_id) : _seed(seed), _stream_id(stream_id) {
+    }
+
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    static constexpr block_type block(const uint64_t seed, const uint64_t stream_id, const uint64_t block_index) {
+        const auto words = philox4x32::block(
+            {static_cast<uint32_t>(block_index), static_cast<uint32_t>(block_index >> 32U),
+             static_cast<uint32_t>(stream_id), static_cast<uint32_t>(stream_id >> 32U)},
+            {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32U)});
+        return {(static_cast<uint64_t>(words[1]) << 32U) | words[0], (static_cast<uint64_t>(words[3]) << 32U) | words[2]};
+    }
+
+    constexpr block_type block(const uint64_t block_index) const {
+        return block(_seed, _stream_id, block_index);
+    }
+
+    result_type operator()() {
+        if (_position % 2 == 0) {
+            _buffer = block(_position / 2);
+        }
+        return _buffer[_position++ % 2];
+    }
+
+    // Fill [begin, end) with the next words of the stream, as if calling operator() for each.
+    template<typename OutputIterator>
+    void generate(OutputIterator begin, OutputIterator end) {
+        for (; begin != end && _position % 2 != 0; ++begin) {
+            *begin = (*this)();
+        }
+        for (; begin != end; ++begin) {
+            const auto words = block(_position / 2);
+            *begin = words[0];
+            if (++begin == end) {
+                _buffer = words;
+                ++_position;
+                return;
+            }
+            *begin = words[1];
+            _position += 2;
+        }
+    }
+
+    // Jump to the given 64-bit word of the stream.
+    void seek(const uint64_t position) {
+        _position = position;
+        if (_position % 2 != 0) {
+            _buffer = block(_position / 2);
+        }
+    }
+
+    void discard(const unsigned long long n) {
+        seek(_position + n);
+    }
+
+    constexpr uint64_t seed() const {
+        return _seed;
+    }
+
+    constexpr uint64_t stream_id() const {
+        return _stream_id;
+    }
+
+    constexpr uint64_t position() const {
+        return _position;
+    }
+
+    friend bool operator==(const random_stream& lhs, const random_stream& rhs) {
+        return lhs._seed == rhs._seed && lhs._stream_id == rhs._stream_id && lhs._position == rhs._position;
+    }
+
+    friend bool operator!=(const random_stream& lhs, const random_stream& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    uint64_t _seed{0};
+    uint64_t _stream_id{0};
+    uint64_t _position{0};
+    block_type _buffer{};
+};
+
+// Uniform double in [0, 1) from the top 53 bits of a random word.
+constexpr double to_unit_interval(const uint64_t word) {
+    return static_cast<double>(word >> 11U) * 0x1.0p-53;
+}
+
+}
+
+#endif // INCLUDE_RANDOM_HPP
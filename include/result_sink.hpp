@@ -0,0 +1,250 @@
+#ifndef INCLUDE_RESULT_SINK_HPP
+#define INCLUDE_RESULT_SINK_HPP
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Writes to a file from its own thread, so the producer only copies into a chunk.
+ *
+ * At most max_pending_chunks full chunks wait for the disk; past that write() blocks, which
+ * bounds the memory whatever the amount of data. Chunks are reused once written. One thread
+ * writes; finish() waits for the data to reach the file.
+ */
+class background_writer {
+public:
+    static constexpr std::size_t chunk_size = 1 << 16;
+    static constexpr std::size_t max_pending_chunks = 8;
+
+    // file stays open and owned by the caller, who must not touch it before finish()
+    explicit background_writer(std::FILE* file) : _file(file) {
+        _current.reserve(chunk_size);
+        _thread = std::thread([this]() { _run(); });
+    }
+
+    background_writer(const background_writer&) = delete;
+    background_writer& operator=(const background_writer&) = delete;
+    background_writer(background_writer&&) = delete;
+    background_writer& operator=(background_writer&&) = delete;
+
+    ~background_writer() {
+        finish();
+    }
+
+    void write(const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const char*>(data);
+        while (size != 0) {
+            const std::size_t n = std::min(size, chunk_size - _current.size());
+            _current.insert(std::end(_current), bytes, bytes + n);
+            bytes += n;
+            size -= n;
+            if (_current.size() == chunk_size) {
+                _submit();
+            }
+        }
+    }
+
+    // Waits until everything is in the file; false if a write failed.
+    bool finish() {
+        if (_thread.joinable()) {
+            _submit();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _ready.notify_one();
+            _thread.join();
+            std::fflush(_file);
+        }
+        return !_failed;
+    }
+
+private:
+    void _submit() {
+        if (_current.empty()) {
+            return;
+        }
+        std::vector<char> next{};
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _space.wait(lock, [this]() { return _pending.size() < max_pending_chunks; });
+            _pending.push_back(std::move(_current));
+            if (!_spare.empty()) {
+                next = std::move(_spare.back());
+                _spare.pop_back();
+            }
+        }
+        _ready.notify_one();
+        next.clear();
+        next.reserve(chunk_size);
+        _current = std::move(next);
+    }
+
+    void _run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _ready.wait(lock, [this]() { return _stop || !_pending.empty(); });
+            if (_pending.empty()) {
+                return;
+            }
+            auto chunk = std::move(_pending.front());
+            _pending.pop_front();
+            lock.unlock();
+            _space.notify_one();
+            const bool failed = std::fwrite(chunk.data(), 1, chunk.size(), _file) != chunk.size();
+            lock.lock();
+            _failed = _failed || failed;
+            _spare.push_back(std::move(chunk));
+        }
+    }
+
+    std::FILE* _file;
+    std::vector<char> _current{};
+    std::deque<std::vector<char>> _pending{};
+    std::vector<std::vector<char>> _spare{};
+    bool _stop{false};
+    bool _failed{false};
+    std::mutex _mutex{};
+    std::condition_variable _ready{};
+    std::condition_variable _space{};
+    std::thread _thread{};
+};
+
+enum class sink_format {
+    binary, // x and y as native float64, gnuplot's binary format="%float64%float64"
+    csv,    // x,y per line, as many digits as a double needs
+    npy,    // an n x 2 float64 NumPy array
+};
+
+inline const char* file_extension(const sink_format format) {
+    switch (format) {
+        case sink_format::binary:
+            return ".bin";
+        case sink_format::csv:
+            return ".csv";
+        default:
+            return ".npy";
+    }
+}
+
+/**
+ * @brief A series of (x, y) points streamed to a file as they are appended.
+ *
+ * Any arithmetic x and y are written as doubles, exact for integers below 2^53.
+ */
+class series_sink {
+public:
+    series_sink(const std::string& path, const sink_format format) : _path(path), _format(format), _file(std::fopen(path.c_str(), "wb")) {
+        if (_file == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", path.c_str());
+            return;
+        }
+        if (_format == sink_format::npy) {
+            // the shape is rewritten in place by close(), the header is padded to fit any size
+            const auto header = _npy_header(0);
+            std::fwrite(header.data(), 1, header.size(), _file);
+        }
+        _writer = std::make_unique<background_writer>(_file);
+    }
+
+    series_sink(const series_sink&) = delete;
+    series_sink& operator=(const series_sink&) = delete;
+
+    ~series_sink() {
+        close();
+    }
+
+    bool good() const noexcept {
+        return _file != nullptr;
+    }
+
+    const std::string& path() const noexcept {
+        return _path;
+    }
+
+    sink_format format() const noexcept {
+        return _format;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    template<typename T, typename U>
+    void append(const T x, const U y) {
+        if (_writer == nullptr) {
+            return;
+        }
+        if (_format == sink_format::csv) {
+            std::array<char, 64> buf{};
+            const int n = std::snprintf(buf.data(), buf.size(), "%.17g,%.17g\n", static_cast<double>(x), static_cast<double>(y));
+            _writer->write(buf.data(), static_cast<std::size_t>(n));
+        } else {
+            const std::array<double, 2> point{static_cast<double>(x), static_cast<double>(y)};
+            _writer->write(point.data(), sizeof(point));
+        }
+        ++_size;
+    }
+
+    template<typename T, typename U>
+    void append(const std::vector<std::pair<T, U>>& data) {
+        for (const auto& [x, y] : data) {
+            append(x, y);
+        }
+    }
+
+    // Waits for the data to reach the file and closes it; false if anything failed.
+    bool close() {
+        if (_file == nullptr) {
+            return false;
+        }
+        bool ok = _writer->finish();
+        _writer.reset();
+        if (_format == sink_format::npy) {
+            const auto header = _npy_header(_size);
+            ok = ok && std::fseek(_file, 0, SEEK_SET) == 0 && std::fwrite(header.data(), 1, header.size(), _file) == header.size();
+        }
+        ok = (std::fclose(_file) == 0) && ok;
+        _file = nullptr;
+        return ok;
+    }
+
+private:
+    // NPY 1.0: magic, version, header length, then a dict padded with spaces to a multiple of 64
+    static std::string _npy_header(const std::size_t rows) {
+        constexpr std::size_t size = 128;
+        std::array<char, 96> dict{};
+        (void) std::snprintf(dict.data(), dict.size(), "{'descr': '<f8', 'fortran_order': False, 'shape': (%zu, 2), }", rows);
+        std::string header("\x93NUMPY\x01\x00", 8);
+        const std::size_t dict_size = size - 10;
+        header += static_cast<char>(dict_size & 0xff);
+        header += static_cast<char>(dict_size >> 8);
+        header += dict.data();
+        header.resize(size - 1, ' ');
+        header += '\n';
+        return header;
+    }
+
+    std::string _path;
+    sink_format _format;
+    std::FILE* _file;
+    std::unique_ptr<background_writer> _writer{};
+    std::size_t _size{0};
+};
+
+}
+
+#endif // INCLUDE_RESULT_SINK_HPP
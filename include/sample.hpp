@@ -0,0 +1,159 @@
+#ifndef INCLUDE_SAMPLE_HPP
+#define INCLUDE_SAMPLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "definitions.h"
+
+namespace comm {
+
+namespace detail {
+    inline int16_t saturate_int16(const int32_t value) {
+        return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(value, std::numeric_limits<int16_t>::min()), std::numeric_limits<int16_t>::max()));
+    }
+
+    // Rounded to nearest and saturated, NaN to 0
+    inline int16_t to_int16(const double value) {
+        if (std::isnan(value)) {
+            return 0;
+        }
+        const double rounded = std::round(value);
+        if (rounded >= std::numeric_limits<int16_t>::max()) {
+            return std::numeric_limits<int16_t>::max();
+        }
+        if (rounded <= std::numeric_limits<int16_t>::min()) {
+            return std::numeric_limits<int16_t>::min();
+        }
+        return static_cast<int16_t>(rounded);
+    }
+}
+
+/**
+ * @brief Fixed-point I/Q sample, the real and imaginary parts times scale in int16.
+ *
+ * Q3.12: unit energy symbols use an eighth of the range, which leaves room for noise
+ * down to about -10 dB SNR before the additions saturate.
+ */
+struct complex_int16_t {
+    static constexpr double scale = 4096.0;
+
+    int16_t re{0};
+    int16_t im{0};
+
+    constexpr int16_t real() const noexcept {
+        return re;
+    }
+
+    constexpr int16_t imag() const noexcept {
+        return im;
+    }
+
+    // Saturating
+    complex_int16_t& operator+=(const complex_int16_t& other) noexcept {
+        re = detail::saturate_int16(int32_t{re} + other.re);
+        im = detail::saturate_int16(int32_t{im} + other.im);
+        return *this;
+    }
+
+    friend complex_int16_t operator+(complex_int16_t lhs, const complex_int16_t& rhs) noexcept {
+        return lhs += rhs;
+    }
+
+    friend bool operator==(const complex_int16_t& lhs, const complex_int16_t& rhs) noexcept {
+        return lhs.re == rhs.re && lhs.im == rhs.im;
+    }
+
+    friend bool operator!=(const complex_int16_t& lhs, const complex_int16_t& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+using complex_float_t = std::complex<float>;
+
+// Sample types the chain runs on
+template<typename T>
+constexpr bool is_sample_v = std::is_same_v<T, complex_signal_t> || std::is_same_v<T, complex_float_t> || std::is_same_v<T, complex_int16_t>;
+
+template<typename Sample>
+Sample to_sample(const complex_signal_t& value) {
+    static_assert(is_sample_v<Sample>, "not a sample type");
+    if constexpr (std::is_same_v<Sample, complex_int16_t>) {
+        return {detail::to_int16(value.real() * complex_int16_t::scale), detail::to_int16(value.imag() * complex_int16_t::scale)};
+    } else {
+        return Sample(value);
+    }
+}
+
+template<typename Sample>
+complex_signal_t to_complex(const Sample& sample) {
+    static_assert(is_sample_v<Sample>, "not a sample type");
+    if constexpr (std::is_same_v<Sample, complex_int16_t>) {
+        return {sample.re / complex_int16_t::scale, sample.im / complex_int16_t::scale};
+    } else {
+        return complex_signal_t(sample);
+    }
+}
+
+// Sample type picked at run time, e.g. from the command line of a simulation
+enum class sample_type {
+    float64,
+    float32,
+    int16,
+};
+
+inline const char* to_string(const sample_type type) {
+    switch (type) {
+        case sample_type::float32:
+            return "float32";
+        case sample_type::int16:
+            return "int16";
+        default:
+            return "float64";
+    }
+}
+
+// "float64" or "double", "float32" or "float", "int16"
+inline sample_type parse_sample_type(const std::string& name) {
+    if (name == "float64" || name == "double") {
+        return sample_type::float64;
+    }
+    if (name == "float32" || name == "float") {
+        return sample_type::float32;
+    }
+    if (name == "int16") {
+        return sample_type::int16;
+    }
+    throw std::invalid_argument("unknown sample type " + name + ", expected float64, float32 or int16");
+}
+
+template<typename T>
+struct sample_tag {
+    using type = T;
+};
+
+/**
+ * @brief Calls f(sample_tag<Sample>{}) with the Sample type of type, so a run time choice
+ * selects one of the instantiations of a templated chain.
+ */
+template<typename F>
+decltype(auto) visit_sample_type(const sample_type type, F&& f) {
+    switch (type) {
+        case sample_type::float32:
+            return f(sample_tag<complex_float_t>{});
+        case sample_type::int16:
+            return f(sample_tag<complex_int16_t>{});
+        default:
+            return f(sample_tag<complex_signal_t>{});
+    }
+}
+
+}
+
+#endif // INCLUDE_SAMPLE_HPP
@@ -0,0 +1,90 @@
+#ifndef INCLUDE_SIMD_HPP
+#define INCLUDE_SIMD_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define COMM_SIMD_X86 1
+#include <immintrin.h>
+// Kernels are compiled for their own instruction set and picked at run time,
+// so the rest of the program keeps the default -march.
+#define COMM_TARGET_AVX2 __attribute__((target("avx2")))
+#define COMM_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512bw,avx512vl,avx2")))
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12 reports the _mm512_undefined_*() placeholders inside its own intrinsics at -O3
+#define COMM_AVX512_DIAGNOSTIC_PUSH _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"") \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")
+#define COMM_AVX512_DIAGNOSTIC_POP _Pragma("GCC diagnostic pop")
+#else
+#define COMM_AVX512_DIAGNOSTIC_PUSH
+#define COMM_AVX512_DIAGNOSTIC_POP
+#endif
+#else
+#define COMM_SIMD_X86 0
+#endif
+
+namespace comm {
+
+// Ordered from the narrowest to the widest, a kernel of level L needs every level below it.
+enum class simd_isa {
+    scalar,
+    avx2,
+    avx512,
+};
+
+namespace detail {
+    inline
+    simd_isa detect_simd_isa() {
+#if COMM_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+            __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl")) {
+            return simd_isa::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_isa::avx2;
+        }
+#endif
+        return simd_isa::scalar;
+    }
+
+    inline
+    std::atomic<simd_isa>& get_simd_isa() {
+        static std::atomic<simd_isa> isa{detect_simd_isa()};
+        return isa;
+    }
+}
+
+// Widest instruction set the kernels dispatch to.
+inline simd_isa active_simd_isa() {
+    return detail::get_simd_isa().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Limit the kernels to the given instruction set, e.g. to compare them in tests and benchmarks.
+ *
+ * Requests above what the CPU supports are lowered to the widest supported one.
+ * @return the instruction set in effect
+ */
+inline simd_isa set_simd_isa(const simd_isa isa) {
+    const auto supported = detail::detect_simd_isa();
+    const auto applied = (static_cast<int32_t>(isa) < static_cast<int32_t>(supported)) ? isa : supported;
+    detail::get_simd_isa().store(applied, std::memory_order_relaxed);
+    return applied;
+}
+
+inline const char* to_string(const simd_isa isa) {
+    switch (isa) {
+        case simd_isa::avx512:
+            return "avx512";
+        case simd_isa::avx2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+}
+
+#endif // INCLUDE_SIMD_HPP
@@ -0,0 +1,245 @@
+#ifndef INCLUDE_SPLIT_SIGNAL_HPP
+#define INCLUDE_SPLIT_SIGNAL_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "definitions.h"
+#include "simd.hpp"
+
+namespace comm {
+
+namespace detail {
+    // Cache line aligned storage, enough for any vector load
+    template<typename T, std::size_t Alignment = 64>
+    struct aligned_allocator {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = aligned_allocator<U, Alignment>;
+        };
+
+        aligned_allocator() noexcept = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+        T* allocate(const std::size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* p, std::size_t) noexcept {
+            ::operator delete(p, std::align_val_t{Alignment});
+        }
+    };
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+        return true;
+    }
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+        return false;
+    }
+
+    inline
+    void deinterleave_scalar(const complex_signal_t* signal, const std::size_t n, double* real, double* imag) {
+        for (std::size_t i = 0; i < n; ++i) {
+            real[i] = signal[i].real();
+            imag[i] = signal[i].imag();
+        }
+    }
+
+    inline
+    void interleave_scalar(const double* real, const double* imag, const std::size_t n, complex_signal_t* signal) {
+        for (std::size_t i = 0; i < n; ++i) {
+            signal[i] = complex_signal_t(real[i], imag[i]);
+        }
+    }
+
+#if COMM_SIMD_X86
+    COMM_TARGET_AVX2 inline
+    void deinterleave_avx2(const complex_signal_t* signal, const std::size_t n, double* real, double* imag) {
+        // std::complex<double> is an array of two doubles, [complex.numbers]
+        const auto* in = reinterpret_cast<const double*>(signal);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d v0 = _mm256_loadu_pd(in + 2 * i);
+            const __m256d v1 = _mm256_loadu_pd(in + 2 * i + 4);
+            _mm256_storeu_pd(real + i, _mm256_permute4x64_pd(_mm256_unpacklo_pd(v0, v1), 0xD8));
+            _mm256_storeu_pd(imag + i, _mm256_permute4x64_pd(_mm256_unpackhi_pd(v0, v1), 0xD8));
+        }
+        deinterleave_scalar(signal + i, n - i, real + i, imag + i);
+    }
+
+    COMM_TARGET_AVX2 inline
+    void interleave_avx2(const double* real, const double* imag, const std::size_t n, complex_signal_t* signal) {
+        auto* out = reinterpret_cast<double*>(signal);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d re = _mm256_loadu_pd(real + i);
+            const __m256d im = _mm256_loadu_pd(imag + i);
+            const __m256d lo = _mm256_unpacklo_pd(re, im);
+            const __m256d hi = _mm256_unpackhi_pd(re, im);
+            _mm256_storeu_pd(out + 2 * i, _mm256_permute2f128_pd(lo, hi, 0x20));
+            _mm256_storeu_pd(out + 2 * i + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+        }
+        interleave_scalar(real + i, imag + i, n - i, signal + i);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_PUSH
+
+    COMM_TARGET_AVX512 inline
+    void deinterleave_avx512(const complex_signal_t* signal, const std::size_t n, double* real, double* imag) {
+        const __m512i even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+        const __m512i odd = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+        const auto* in = reinterpret_cast<const double*>(signal);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512d v0 = _mm512_loadu_pd(in + 2 * i);
+            const __m512d v1 = _mm512_loadu_pd(in + 2 * i + 8);
+            _mm512_storeu_pd(real + i, _mm512_permutex2var_pd(v0, even, v1));
+            _mm512_storeu_pd(imag + i, _mm512_permutex2var_pd(v0, odd, v1));
+        }
+        deinterleave_scalar(signal + i, n - i, real + i, imag + i);
+    }
+
+    COMM_TARGET_AVX512 inline
+    void interleave_avx512(const double* real, const double* imag, const std::size_t n, complex_signal_t* signal) {
+        const __m512i first_half = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+        const __m512i second_half = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+        auto* out = reinterpret_cast<double*>(signal);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512d re = _mm512_loadu_pd(real + i);
+            const __m512d im = _mm512_loadu_pd(imag + i);
+            _mm512_storeu_pd(out + 2 * i, _mm512_permutex2var_pd(re, first_half, im));
+            _mm512_storeu_pd(out + 2 * i + 8, _mm512_permutex2var_pd(re, second_half, im));
+        }
+        interleave_scalar(real + i, imag + i, n - i, signal + i);
+    }
+
+    COMM_AVX512_DIAGNOSTIC_POP
+#endif
+}
+
+// Interleaved samples to separate real and imaginary arrays.
+inline void deinterleave(const complex_signal_t* signal, const std::size_t n, double* real, double* imag) {
+#if COMM_SIMD_X86
+    switch (active_simd_isa()) {
+        case simd_isa::avx512:
+            detail::deinterleave_avx512(signal, n, real, imag);
+            return;
+        case simd_isa::avx2:
+            detail::deinterleave_avx2(signal, n, real, imag);
+            return;
+        default:
+            break;
+    }
+#endif
+    detail::deinterleave_scalar(signal, n, real, imag);
+}
+
+// Separate real and imaginary arrays back to interleaved samples.
+inline void interleave(const double* real, const double* imag, const std::size_t n, complex_signal_t* signal) {
+#if COMM_SIMD_X86
+    switch (active_simd_isa()) {
+        case simd_isa::avx512:
+            detail::interleave_avx512(real, imag, n, signal);
+            return;
+        case simd_isa::avx2:
+            detail::interleave_avx2(real, imag, n, signal);
+            return;
+        default:
+            break;
+    }
+#endif
+    detail::interleave_scalar(real, imag, n, signal);
+}
+
+/**
+ * @brief Complex signal stored as split I/Q, the real parts in one array and the imaginary parts in another.
+ *
+ * Both arrays are cache line aligned. Kernels load four or eight real or imaginary parts
+ * at once with no shuffling, where interleaved std::complex samples need their lanes
+ * separated first. Convert with the constructor from complex_signal_seq_t and interleave().
+ */
+class split_signal_t {
+public:
+    using storage_type = std::vector<double, detail::aligned_allocator<double>>;
+
+    split_signal_t() = default;
+
+    explicit split_signal_t(const std::size_t num_of_samples) : _real(num_of_samples), _imag(num_of_samples) {
+    }
+
+    explicit split_signal_t(const complex_signal_seq_t& signal) : split_signal_t(signal.size()) {
+        deinterleave(signal.data(), signal.size(), real(), imag());
+    }
+
+    complex_signal_seq_t interleave() const {
+        complex_signal_seq_t signal(size());
+        comm::interleave(real(), imag(), size(), signal.data());
+        return signal;
+    }
+
+    std::size_t size() const noexcept {
+        return _real.size();
+    }
+
+    bool empty() const noexcept {
+        return _real.empty();
+    }
+
+    void resize(const std::size_t num_of_samples) {
+        _real.resize(num_of_samples);
+        _imag.resize(num_of_samples);
+    }
+
+    complex_signal_t operator[](const std::size_t i) const {
+        assert(i < size());
+        return {_real[i], _imag[i]};
+    }
+
+    void set(const std::size_t i, const complex_signal_t value) {
+        assert(i < size());
+        _real[i] = value.real();
+        _imag[i] = value.imag();
+    }
+
+    double* real() noexcept {
+        return _real.data();
+    }
+
+    const double* real() const noexcept {
+        return _real.data();
+    }
+
+    double* imag() noexcept {
+        return _imag.data();
+    }
+
+    const double* imag() const noexcept {
+        return _imag.data();
+    }
+
+    friend bool operator==(const split_signal_t& lhs, const split_signal_t& rhs) {
+        return lhs._real == rhs._real && lhs._imag == rhs._imag;
+    }
+
+    friend bool operator!=(const split_signal_t& lhs, const split_signal_t& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    storage_type _real{};
+    storage_type _imag{};
+};
+
+}
+
+#endif // INCLUDE_SPLIT_SIGNAL_HPP
@@ -0,0 +1,135 @@
+#ifndef INCLUDE_STATISTICS_HPP
+#define INCLUDE_STATISTICS_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace comm {
+
+struct confidence_interval {
+    double lower{0};
+    double upper{1};
+
+    double width() const {
+        return upper - lower;
+    }
+};
+
+namespace detail {
+    // Continued fraction of the regularized incomplete beta function, modified Lentz's method.
+    inline
+    double incomplete_beta_fraction(const double a, const double b, const double x) {
+        constexpr double tiny = 1e-300;
+        constexpr double epsilon = 1e-15;
+        double c = 1.0;
+        double d = 1.0 - (a + b) * x / (a + 1.0);
+        d = 1.0 / ((std::abs(d) < tiny) ? tiny : d);
+        double fraction = d;
+        for (int32_t m = 1; m <= 10'000; ++m) {
+            for (const double numerator : {m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m)),
+                                           -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0))}) {
+                d = 1.0 + numerator * d;
+                d = 1.0 / ((std::abs(d) < tiny) ? tiny : d);
+                c = 1.0 + numerator / c;
+                c = (std::abs(c) < tiny) ? tiny : c;
+                fraction *= d * c;
+            }
+            if (std::abs(d * c - 1.0) < epsilon) {
+                break;
+            }
+        }
+        return fraction;
+    }
+}
+
+// Regularized incomplete beta function I_x(a, b)
+inline double incomplete_beta(const double a, const double b, const double x) {
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    if (x >= 1.0) {
+        return 1.0;
+    }
+    const double log_front = std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x);
+    // The fraction converges fast below the mean, use the symmetry above it
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return std::exp(log_front) * detail::incomplete_beta_fraction(a, b, x) / a;
+    }
+    return 1.0 - std::exp(log_front) * detail::incomplete_beta_fraction(b, a, 1.0 - x) / b;
+}
+
+// x such that I_x(a, b) = p, by bisection
+inline double inverse_incomplete_beta(const double a, const double b, const double p) {
+    double lower = 0.0;
+    double upper = 1.0;
+    for (int32_t i = 0; i < 200 && upper - lower > std::numeric_limits<double>::min(); ++i) {
+        const double middle = 0.5 * (lower + upper);
+        if (middle <= lower || middle >= upper) {
+            break;
+        }
+        (incomplete_beta(a, b, middle) < p ? lower : upper) = middle;
+    }
+    return 0.5 * (lower + upper);
+}
+
+// Quantile of the standard normal distribution, Newton's method on erfc.
+inline double normal_quantile(const double p) {
+    assert(p > 0.0 && p < 1.0);
+    double x = 0.0;
+    for (int32_t i = 0; i < 100; ++i) {
+        const double cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+        const double pdf = std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI);
+        const double step = (cdf - p) / std::max(pdf, 1e-300);
+        x -= std::clamp(step, -1.0, 1.0);
+        if (std::abs(step) < 1e-14) {
+            break;
+        }
+    }
+    return x;
+}
+
+/**
+ * @brief Wilson score interval of a binomial proportion.
+ *
+ * @param successes e.g. the bit errors
+ * @param trials e.g. the bits sent
+ * @param confidence two-sided confidence level, e.g. 0.95
+ */
+inline confidence_interval wilson_interval(const std::size_t successes, const std::size_t trials, const double confidence = 0.95) {
+    if (trials == 0) {
+        return {};
+    }
+    const double n = static_cast<double>(trials);
+    const double p = static_cast<double>(successes) / n;
+    const double z = normal_quantile(0.5 + 0.5 * confidence);
+    const double z2 = z * z;
+    const double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+    const double half_width = z / (1 + z2 / n) * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n));
+    return {std::max(0.0, center - half_width), std::min(1.0, center + half_width)};
+}
+
+/**
+ * @brief Clopper-Pearson (exact) interval of a binomial proportion.
+ *
+ * Conservative: it covers the true proportion at least as often as the confidence
+ * level says, and stays meaningful with zero or very few errors.
+ */
+inline confidence_interval clopper_pearson_interval(const std::size_t successes, const std::size_t trials, const double confidence = 0.95) {
+    if (trials == 0) {
+        return {};
+    }
+    const double alpha = 1.0 - confidence;
+    const double k = static_cast<double>(successes);
+    const double n = static_cast<double>(trials);
+    confidence_interval interval{};
+    interval.lower = (successes == 0) ? 0.0 : inverse_incomplete_beta(k, n - k + 1, alpha / 2);
+    interval.upper = (successes == trials) ? 1.0 : inverse_incomplete_beta(k + 1, n - k, 1 - alpha / 2);
+    return interval;
+}
+
+}
+
+#endif // INCLUDE_STATISTICS_HPP
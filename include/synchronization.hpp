@@ -0,0 +1,305 @@
+#ifndef INCLUDE_SYNCHRONIZATION_HPP
+#define INCLUDE_SYNCHRONIZATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+#include "fft.hpp"
+
+namespace comm {
+
+/*
+    Receiver synchronization, in the order a receiver runs it:
+
+        coarse_cfo_estimator  frequency offset from the spectrum of the signal to the M-th power
+        timing_recovery       symbol strobes from the matched filter output, Gardner or Mueller-Muller
+        costas_loop           residual frequency and phase on the symbols
+
+    Each takes the signal in chunks of any size and keeps its state between them, so a
+    stream of any length runs through in one pass with the result of a single call.
+    Frequencies are normalized, in cycles per sample as for cfo_stage, and in cycles per
+    symbol for the Costas loop, which runs on the symbols.
+*/
+
+namespace detail {
+    constexpr double sync_pi = 3.14159265358979323846;
+
+    // The timing error is normalized by the strobe power averaged over this many strobes, a running mean before
+    constexpr std::size_t timing_power_window = 64;
+
+    inline double sign(const double x) {
+        return (x < 0) ? -1.0 : 1.0;
+    }
+
+    // Proportional and integral gains of a second-order loop of normalized noise bandwidth and damping
+    inline std::pair<double, double> loop_gains(const double loop_bandwidth, const double damping) {
+        const double theta = loop_bandwidth / (damping + 1 / (4 * damping));
+        const double d = 1 + 2 * damping * theta + theta * theta;
+        return {4 * damping * theta / d, 4 * theta * theta / d};
+    }
+}
+
+/**
+ * @brief Frequency offset of an M-PSK signal from the peak of the spectrum of its M-th power.
+ *
+ * Raising to the power order removes the modulation and leaves a tone at order times the
+ * offset; the power spectra of blocks of fft_size samples are averaged and the peak is
+ * interpolated between bins. Offsets up to 1 / (2 order) are unambiguous.
+ */
+class coarse_cfo_estimator {
+public:
+    static constexpr std::size_t default_fft_size = 4096;
+
+    explicit coarse_cfo_estimator(const std::size_t order, const std::size_t fft_size = default_fft_size)
+        : _order(order), _fft_size(fft_size), _buffer(make_fftw_buffer(fft_size)), _power(fft_size, 0.0) {
+        if (order == 0 || fft_size < 4) {
+            throw std::invalid_argument("CFO estimation needs a modulation order and at least 4 FFT points");
+        }
+    }
+
+    void process(const complex_signal_t* samples, const std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            complex_signal_t powered = samples[i];
+            for (std::size_t k = 1; k < _order; ++k) {
+                const complex_signal_t x = powered;
+                powered = {x.real() * samples[i].real() - x.imag() * samples[i].imag(), x.real() * samples[i].imag() + x.imag() * samples[i].real()};
+            }
+            _buffer[_filled++] = powered;
+            if (_filled == _fft_size) {
+                _add_block();
+            }
+        }
+    }
+
+    // Blocks averaged so far; estimate() is zero before the first
+    std::size_t num_of_blocks() const noexcept {
+        return _num_of_blocks;
+    }
+
+    double estimate() const {
+        if (_num_of_blocks == 0) {
+            return 0.0;
+        }
+        const auto peak = static_cast<std::size_t>(std::distance(std::cbegin(_power), std::max_element(std::cbegin(_power), std::cend(_power))));
+        // parabola through the magnitudes around the peak
+        const double left = std::sqrt(_power[(peak + _fft_size - 1) % _fft_size]);
+        const double center = std::sqrt(_power[peak]);
+        const double right = std::sqrt(_power[(peak + 1) % _fft_size]);
+        const double curvature = left - 2 * center + right;
+        const double delta = (curvature == 0.0) ? 0.0 : 0.5 * (left - right) / curvature;
+        double frequency = (static_cast<double>(peak) + delta) / static_cast<double>(_fft_size);
+        frequency -= std::floor(frequency + 0.5);
+        return frequency / static_cast<double>(_order);
+    }
+
+    void reset() {
+        std::fill(std::begin(_power), std::end(_power), 0.0);
+        _filled = 0;
+        _num_of_blocks = 0;
+    }
+
+private:
+    void _add_block() {
+        fft_in_place(_buffer.get(), _fft_size, 1, fft_direction::forward);
+        for (std::size_t k = 0; k < _fft_size; ++k) {
+            _power[k] += std::norm(_buffer[k]);
+        }
+        _filled = 0;
+        ++_num_of_blocks;
+    }
+
+    std::size_t _order;
+    std::size_t _fft_size;
+    fftw_buffer _buffer;
+    std::vector<double> _power;
+    std::size_t _filled{0};
+    std::size_t _num_of_blocks{0};
+};
+
+/**
+ * @brief Decision-directed Costas loop tracking the carrier phase and frequency of BPSK or QPSK symbols.
+ *
+ * Derotates the symbols in place. BPSK lies on the real axis and QPSK on the diagonals,
+ * as bpsk_modulation and qpsk_modulation make them; the phase locks up to the order-fold
+ * ambiguity of the constellation. Start from a coarse estimate with initial_frequency, in
+ * cycles per symbol, when the offset is more than a fraction of the loop bandwidth.
+ */
+class costas_loop {
+public:
+    costas_loop(const std::size_t order, const double loop_bandwidth, const double initial_frequency = 0.0, const double damping = 1 / std::sqrt(2.0))
+        : _order(order), _initial_frequency(2 * detail::sync_pi * initial_frequency) {
+        if (order != 2 && order != 4) {
+            throw std::invalid_argument("the Costas loop tracks BPSK (order 2) or QPSK (order 4)");
+        }
+        std::tie(_proportional, _integral) = detail::loop_gains(loop_bandwidth, damping);
+        reset();
+    }
+
+    void process(complex_signal_t* symbols, const std::size_t n) {
+        // the error slope for unit energy symbols, so that the gains hold for both orders
+        const double detector_gain = (_order == 2) ? 1.0 : std::sqrt(2.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            const complex_signal_t rotation(std::cos(_phase), -std::sin(_phase));
+            const complex_signal_t x = symbols[i];
+            const complex_signal_t y(x.real() * rotation.real() - x.imag() * rotation.imag(), x.real() * rotation.imag() + x.imag() * rotation.real());
+            symbols[i] = y;
+
+            double error = detail::sign(y.real()) * y.imag();
+            if (_order == 4) {
+                error -= detail::sign(y.imag()) * y.real();
+            }
+            error /= detector_gain;
+            _frequency += _integral * error;
+            _phase += _frequency + _proportional * error;
+            _phase = std::remainder(_phase, 2 * detail::sync_pi);
+        }
+    }
+
+    // Radians
+    double phase() const noexcept {
+        return _phase;
+    }
+
+    // Cycles per symbol
+    double frequency() const noexcept {
+        return _frequency / (2 * detail::sync_pi);
+    }
+
+    void reset() {
+        _phase = 0.0;
+        _frequency = _initial_frequency;
+    }
+
+private:
+    std::size_t _order;
+    double _initial_frequency;
+    double _proportional{0.0};
+    double _integral{0.0};
+    double _phase{0.0};
+    // radians per symbol
+    double _frequency{0.0};
+};
+
+enum class timing_detector {
+    // on two samples per symbol, independent of the carrier phase
+    gardner,
+    // on the symbol strobes and their decisions, for BPSK and QPSK
+    mueller_muller,
+};
+
+/**
+ * @brief Symbol timing recovery: one strobe per symbol, interpolated from the matched filter output.
+ *
+ * A second-order loop steers the strobe position from the detector's timing error; the
+ * strobes are cubic Lagrange interpolations between the samples, so any samples per symbol
+ * of at least two works, and a sample clock offset shows up in period(). The error is
+ * normalized by the average strobe power, so the loop holds its bandwidth at any signal
+ * level, and a step never moves the strobe by more than half a symbol.
+ */
+class timing_recovery {
+public:
+    timing_recovery(const double samples_per_symbol, const timing_detector detector = timing_detector::gardner, const double loop_bandwidth = 0.01,
+                    const double damping = 1 / std::sqrt(2.0))
+        : _samples_per_symbol(samples_per_symbol), _detector(detector) {
+        if (samples_per_symbol < 2) {
+            throw std::invalid_argument("timing recovery needs at least two samples per symbol");
+        }
+        std::tie(_proportional, _integral) = detail::loop_gains(loop_bandwidth, damping);
+        reset();
+    }
+
+    // Writes the symbols strobed in the next n samples, at most n / samples_per_symbol + 1, and returns their number.
+    std::size_t process(const complex_signal_t* samples, const std::size_t n, complex_signal_t* symbols) {
+        _line.insert(std::end(_line), samples, samples + n);
+        std::size_t num_of_symbols = 0;
+        while (_position + 2 < static_cast<double>(_line.size())) {
+            const complex_signal_t strobe = _interpolate(_position);
+            // the detectors' slopes scale with the signal, Gardner's with its power, Mueller-Muller's with its amplitude
+            const double power = std::norm(strobe);
+            _num_of_strobes = std::min(_num_of_strobes + 1, detail::timing_power_window);
+            _power += (power - _power) / static_cast<double>(_num_of_strobes);
+            const double scale = std::max(_power, std::numeric_limits<double>::min());
+            double error{0.0};
+            if (_detector == timing_detector::gardner) {
+                const complex_signal_t middle = _interpolate(_position - _period() / 2);
+                error = ((_previous - strobe) * std::conj(middle)).real() / scale;
+            } else {
+                const complex_signal_t decision(detail::sign(strobe.real()), detail::sign(strobe.imag()));
+                error = (std::conj(_previous_decision) * strobe - std::conj(decision) * _previous).real() / (2 * std::sqrt(scale));
+                _previous_decision = decision;
+            }
+            _previous = strobe;
+            symbols[num_of_symbols++] = strobe;
+
+            // positive errors are early strobes: the next comes later, never before the midpoint of this symbol
+            const double limit = _samples_per_symbol / 2;
+            _period_offset = std::clamp(_period_offset + _integral * error * _samples_per_symbol, -limit, limit);
+            _position += _period() + std::clamp(_proportional * error * _samples_per_symbol, -_period() / 2, _period() / 2);
+        }
+        // keep what the next strobes interpolate from, their midpoints included
+        const double oldest = _position - _period() / 2 - 1;
+        const auto drop = static_cast<std::size_t>(std::max(0.0, std::floor(oldest)));
+        const std::size_t dropped = std::min(drop, _line.size());
+        _line.erase(std::begin(_line), std::begin(_line) + static_cast<std::ptrdiff_t>(dropped));
+        _position -= static_cast<double>(dropped);
+        return num_of_symbols;
+    }
+
+    // Samples per symbol as tracked, off the nominal by the sample clock offset
+    double period() const noexcept {
+        return _period();
+    }
+
+    void reset() {
+        _line.assign(1, complex_signal_t{});
+        // a whole symbol of history before the first strobe, for its midpoint
+        _position = _samples_per_symbol + 1;
+        _period_offset = 0.0;
+        _previous = complex_signal_t{};
+        _previous_decision = complex_signal_t{};
+        _power = 0.0;
+        _num_of_strobes = 0;
+    }
+
+private:
+    double _period() const noexcept {
+        return _samples_per_symbol + _period_offset;
+    }
+
+    complex_signal_t _interpolate(const double position) const {
+        const double base = std::floor(position);
+        const double mu = position - base;
+        const auto i = static_cast<std::size_t>(base);
+        const double c0 = -mu * (mu - 1) * (mu - 2) / 6;
+        const double c1 = (mu + 1) * (mu - 1) * (mu - 2) / 2;
+        const double c2 = -(mu + 1) * mu * (mu - 2) / 2;
+        const double c3 = (mu + 1) * mu * (mu - 1) / 6;
+        return c0 * _line[i - 1] + c1 * _line[i] + c2 * _line[i + 1] + c3 * _line[i + 2];
+    }
+
+    double _samples_per_symbol;
+    timing_detector _detector;
+    double _proportional{0.0};
+    double _integral{0.0};
+    std::vector<complex_signal_t> _line{};
+    // in _line, of the next strobe
+    double _position{0.0};
+    double _period_offset{0.0};
+    complex_signal_t _previous{};
+    complex_signal_t _previous_decision{};
+    // mean power of the strobes, which normalizes the timing error
+    double _power{0.0};
+    std::size_t _num_of_strobes{0};
+};
+
+}
+
+#endif // INCLUDE_SYNCHRONIZATION_HPP
@@ -0,0 +1,180 @@
+#ifndef INCLUDE_THREAD_POOL_HPP
+#define INCLUDE_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Fixed-size pool of worker threads running index-based parallel loops.
+ *
+ * The calling thread takes part in every parallel_for, so a pool of N threads
+ * spawns N - 1 workers and a pool of 1 thread runs everything serially. A task that
+ * calls parallel_for on its own pool runs that inner loop inline on its thread, since
+ * the other threads may all be busy with the outer one.
+ */
+class thread_pool {
+public:
+    static std::size_t default_num_of_threads() {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    explicit thread_pool(const std::size_t num_of_threads = default_num_of_threads()) {
+        for (std::size_t i = 1; i < num_of_threads; ++i) {
+            _workers.emplace_back([this]() { _worker_loop(); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return _workers.size() + 1;
+    }
+
+    /**
+     * @brief Call task(i) for every i in [0, n) and block until all calls return.
+     *
+     * Indices are handed out one at a time, so uneven tasks balance themselves.
+     * The first exception thrown by a task is rethrown here after the loop drains.
+     */
+    template<typename Task>
+    void parallel_for(const std::size_t n, Task&& task) {
+        if (_current() == this) {
+            _run_inline(n, task);
+            return;
+        }
+        std::lock_guard<std::mutex> submit_lock(_submit_mutex);
+        const current_pool_scope scope{this};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = [&task](const std::size_t i) { task(i); };
+            _num_of_tasks = n;
+            _next.store(0);
+            _error = nullptr;
+            _active = _workers.size();
+            ++_generation;
+        }
+        _wake.notify_all();
+        _run();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _active == 0; });
+        _task = nullptr;
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+private:
+    // The pool whose loop the calling thread is running tasks of, if any
+    static const thread_pool*& _current() {
+        thread_local const thread_pool* pool = nullptr;
+        return pool;
+    }
+
+    struct current_pool_scope {
+        explicit current_pool_scope(const thread_pool* pool) : previous(_current()) {
+            _current() = pool;
+        }
+
+        ~current_pool_scope() {
+            _current() = previous;
+        }
+
+        current_pool_scope(const current_pool_scope&) = delete;
+        current_pool_scope& operator=(const current_pool_scope&) = delete;
+
+        const thread_pool* previous;
+    };
+
+    template<typename Task>
+    static void _run_inline(const std::size_t n, Task& task) {
+        std::exception_ptr error{};
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                task(i);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void _worker_loop() {
+        _current() = this;
+        std::uint64_t seen_generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this, seen_generation]() { return _stop || _generation != seen_generation; });
+                if (_stop) {
+                    return;
+                }
+                seen_generation = _generation;
+            }
+            _run();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (--_active == 0) {
+                    _done.notify_one();
+                }
+            }
+        }
+    }
+
+    void _run() {
+        for (std::size_t i = _next.fetch_add(1); i < _num_of_tasks; i = _next.fetch_add(1)) {
+            try {
+                _task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_error) {
+                    _error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> _workers{};
+    std::mutex _submit_mutex{};
+    std::mutex _mutex{};
+    std::condition_variable _wake{};
+    std::condition_variable _done{};
+    std::function<void(std::size_t)> _task{};
+    std::size_t _num_of_tasks{0};
+    std::atomic<std::size_t> _next{0};
+    std::size_t _active{0};
+    std::uint64_t _generation{0};
+    std::exception_ptr _error{};
+    bool _stop{false};
+};
+
+}
+
+#endif // INCLUDE_THREAD_POOL_HPP
@@ -1,6 +1,9 @@
 #ifndef INCLUDE_UTILITIES_HPP
 #define INCLUDE_UTILITIES_HPP
 
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <cstdint>
 #include <iostream>
 #include <random>
@@ -8,28 +11,63 @@
 #include <cmath>
 #include <type_traits>
 #include <iterator>
+#include <limits>
 
 #include "definitions.h"
+#include "normal.hpp"
+#include "packed_bits.hpp"
+#include "random.hpp"
+#include "sample.hpp"
+#include "split_signal.hpp"
 
 namespace comm {
 namespace detail {
+    struct generator_state {
+        random_stream generator{};
+        std::normal_distribution<double> normal_distribution{0, 1};
+        uint64_t epoch{0};
+    };
+
+    struct global_seed {
+        std::atomic<uint64_t> seed{(static_cast<uint64_t>(std::random_device{}()) << 32U) | std::random_device{}()};
+        std::atomic<uint64_t> next_stream_id{0};
+        std::atomic<uint64_t> epoch{1};
+    };
+
+    inline
+    global_seed& get_global_seed() {
+        static global_seed global{};
+        return global;
+    }
+
+    // Each thread draws from its own stream of the global seed; reseeding hands out stream ids again.
+    inline
+    generator_state& get_generator_state() {
+        thread_local generator_state state{};
+        auto& global = get_global_seed();
+        const auto epoch = global.epoch.load(std::memory_order_acquire);
+        if (state.epoch != epoch) {
+            state.generator = random_stream(global.seed.load(), global.next_stream_id.fetch_add(1));
+            state.normal_distribution.reset();
+            state.epoch = epoch;
+        }
+        return state;
+    }
+
     inline
-    auto& get_generator() {
-        static std::random_device rd;
-        static std::mt19937 generator(rd());
-        return generator;
+    random_stream& get_generator() {
+        return get_generator_state().generator;
     }
 
     inline
     auto uniform_distribution_genarator() {
-        static std::uniform_int_distribution<uint8_t> distribution(0, 1);
-        return distribution(get_generator());
+        return static_cast<uint8_t>(get_generator()() & 1U);
     }
 
     template<int32_t Mean>
     auto gaussian_distribution_genarator() {
-        static std::normal_distribution<double> distribution(Mean, 1);
-        return distribution(get_generator());
+        auto& state = get_generator_state();
+        return Mean + state.normal_distribution(state.generator);
     }
 
     template<typename T, typename U>
@@ -49,6 +87,19 @@ namespace detail {
     }
 }
 
+/**
+ * @brief Reseed the generators behind the functions that take no generator.
+ *
+ * The calling thread restarts at stream 0 of the new seed, so a single-threaded
+ * program that calls this first gives the same output on every run.
+ */
+inline void set_seed(const uint64_t seed) {
+    auto& global = detail::get_global_seed();
+    global.seed.store(seed);
+    global.next_stream_id.store(0);
+    global.epoch.fetch_add(1, std::memory_order_release);
+}
+
 template<typename InputIterator>
 void generate_uniformly_distributed_bits(InputIterator begin, InputIterator end) {
     std::generate(begin, end, []() {
@@ -62,6 +113,45 @@ inline bit_seq_t generate_uniformly_distributed_bits(const std::size_t num_of_bi
     return bits;
 }
 
+// Same as above, but draws from the given generator instead of the shared one.
+template<typename InputIterator, typename Generator>
+void generate_uniformly_distributed_bits(InputIterator begin, InputIterator end, Generator& generator) {
+    std::generate(begin, end, [&generator]() {
+        return static_cast<bit_t>(generator() & 1U);
+    });
+}
+
+template<typename Generator>
+bit_seq_t generate_uniformly_distributed_bits(const std::size_t num_of_bits, Generator& generator) {
+    bit_seq_t bits(num_of_bits);
+    generate_uniformly_distributed_bits(std::begin(bits), std::end(bits), generator);
+    return bits;
+}
+
+// Packed version: every random word gives 64 bits.
+template<typename Generator>
+void generate_uniformly_distributed_bits(packed_bit_seq_t& bits, Generator& generator) {
+    auto* words = bits.data();
+    if constexpr(std::is_same_v<Generator, random_stream>) {
+        generator.generate(words, words + bits.num_of_words());
+    } else if constexpr(Generator::min() == 0 && Generator::max() == std::numeric_limits<uint64_t>::max()) {
+        std::generate(words, words + bits.num_of_words(), [&generator]() {
+            return static_cast<uint64_t>(generator());
+        });
+    } else {
+        static_assert(Generator::min() == 0 && Generator::max() == std::numeric_limits<uint32_t>::max(), "need 32 or 64 random bits per call");
+        std::generate(words, words + bits.num_of_words(), [&generator]() {
+            const auto high = static_cast<uint64_t>(generator()) << 32U;
+            return high | static_cast<uint64_t>(generator());
+        });
+    }
+    bits.clear_padding();
+}
+
+inline void generate_uniformly_distributed_bits(packed_bit_seq_t& bits) {
+    generate_uniformly_distributed_bits(bits, detail::get_generator());
+}
+
 template<typename T>
 double convert_eb_no_to_es_no(T ebno_db, const uint8_t modulation_order) {
     const double snr = std::pow(10, ebno_db/10.0) * modulation_order;
@@ -78,30 +168,92 @@ std::vector<double> convert_eb_no_to_es_no(const std::vector<T> eb_no, const uin
     return symbol_snr;
 }
 
-template<typename InputIterator, typename U>
-void generate_awgn_noise(InputIterator begin, InputIterator end, const U& snr_db) {
+// Block version: writes straight into a contiguous buffer with the batched normal generator.
+template<typename U>
+void generate_awgn_noise(complex_signal_t* begin, complex_signal_t* end, const U& snr_db, random_stream& generator) {
+    const auto snr = std::pow(10, -snr_db/20.0);
+    generate_normal(generator, begin, end, snr / std::sqrt(2));
+}
+
+/**
+ * @brief Block version for the other sample types, the noise of the double version rounded to Sample.
+ *
+ * The same stream gives the same noise whatever the sample type, so BER curves of
+ * different precisions differ only by the precision.
+ */
+template<typename Sample, typename U, std::enable_if_t<is_sample_v<Sample>, int> = 0>
+void generate_awgn_noise(Sample* begin, Sample* end, const U& snr_db, random_stream& generator) {
+    constexpr std::size_t chunk_size = 512;
+    std::array<complex_signal_t, chunk_size> chunk{};
+    for (; begin != end;) {
+        const auto n = std::min(chunk_size, static_cast<std::size_t>(end - begin));
+        generate_awgn_noise(chunk.data(), chunk.data() + n, snr_db, generator);
+        begin = std::transform(chunk.data(), chunk.data() + n, begin, to_sample<Sample>);
+    }
+}
+
+template<typename InputIterator, typename U, typename Generator>
+void generate_awgn_noise(InputIterator begin, InputIterator end, const U& snr_db, Generator& generator) {
     using input_value_type = typename InputIterator::value_type;
-    if constexpr(std::is_same_v<input_value_type, complex_signal_t>) {
+    if constexpr(std::is_same_v<Generator, random_stream> && std::is_same_v<InputIterator, complex_signal_seq_t::iterator>) {
+        if (begin != end) {
+            generate_awgn_noise(&*begin, &*begin + std::distance(begin, end), snr_db, generator);
+        }
+    } else if constexpr(std::is_same_v<Generator, random_stream> && is_sample_v<input_value_type> &&
+                        std::is_same_v<InputIterator, typename std::vector<input_value_type>::iterator>) {
+        if (begin != end) {
+            generate_awgn_noise(&*begin, &*begin + std::distance(begin, end), snr_db, generator);
+        }
+    } else if constexpr(std::is_same_v<Generator, random_stream> && std::is_same_v<InputIterator, std::vector<double>::iterator>) {
+        if (begin != end) {
+            generate_normal(generator, &*begin, &*begin + std::distance(begin, end));
+        }
+    } else if constexpr(std::is_same_v<input_value_type, complex_signal_t>) {
+        std::normal_distribution<double> distribution(0, 1);
         const auto snr = std::pow(10, -snr_db/20.0);
         const auto multipler = snr / std::sqrt(2);
-        std::generate(begin, end, [multipler]() {
-            return multipler * complex_signal_t(detail::gaussian_distribution_genarator<0>(), detail::gaussian_distribution_genarator<0>());
+        std::generate(begin, end, [multipler, &distribution, &generator]() {
+            const double real = distribution(generator);
+            return multipler * complex_signal_t(real, distribution(generator));
         });
     } else {
         // multiplier?
-        std::generate(begin, end, []() {
-            return detail::gaussian_distribution_genarator<0>();
+        std::normal_distribution<double> distribution(0, 1);
+        std::generate(begin, end, [&distribution, &generator]() {
+            return distribution(generator);
         });
     }
 }
 
-template<typename U>
-complex_signal_seq_t generate_awgn_noise(const std::size_t num_of_samples, const U& snr_db) {
+template<typename U, typename Generator>
+complex_signal_seq_t generate_awgn_noise(const std::size_t num_of_samples, const U& snr_db, Generator& generator) {
     complex_signal_seq_t noise(num_of_samples);
-    generate_awgn_noise(std::begin(noise), std::end(noise), snr_db);
+    generate_awgn_noise(std::begin(noise), std::end(noise), snr_db, generator);
     return noise;
 }
 
+template<typename InputIterator, typename U>
+void generate_awgn_noise(InputIterator begin, InputIterator end, const U& snr_db) {
+    generate_awgn_noise(begin, end, snr_db, detail::get_generator());
+}
+
+template<typename U>
+complex_signal_seq_t generate_awgn_noise(const std::size_t num_of_samples, const U& snr_db) {
+    return generate_awgn_noise(num_of_samples, snr_db, detail::get_generator());
+}
+
+/**
+ * @brief Split I/Q noise, the same samples the interleaved versions draw from the stream.
+ *
+ * The generator writes the two arrays directly, and the noise of a simulation does not
+ * depend on the signal layout it runs with.
+ */
+template<typename U>
+void generate_awgn_noise(split_signal_t& noise, const U& snr_db, random_stream& generator) {
+    const auto snr = std::pow(10, -snr_db/20.0);
+    generate_normal(generator, noise.real(), noise.imag(), noise.size(), snr / std::sqrt(2));
+}
+
 template<typename InputIterator, typename OutputIterator>
 void add(InputIterator first_begin, InputIterator first_end,
          InputIterator second_begin, OutputIterator result_begin) {
@@ -125,6 +277,35 @@ void add_in_place(InputIterator first_begin, InputIterator first_end, OutputIter
     }
 }
 
+inline split_signal_t add(const split_signal_t& first, const split_signal_t& second) {
+    assert(first.size() == second.size());
+    split_signal_t result(first.size());
+    const double* first_real = first.real();
+    const double* first_imag = first.imag();
+    const double* second_real = second.real();
+    const double* second_imag = second.imag();
+    double* result_real = result.real();
+    double* result_imag = result.imag();
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        result_real[i] = first_real[i] + second_real[i];
+        result_imag[i] = first_imag[i] + second_imag[i];
+    }
+    return result;
+}
+
+// result += first, e.g. noise onto a signal
+inline void add_in_place(const split_signal_t& first, split_signal_t& result) {
+    assert(first.size() == result.size());
+    const double* real = first.real();
+    const double* imag = first.imag();
+    double* result_real = result.real();
+    double* result_imag = result.imag();
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        result_real[i] += real[i];
+        result_imag[i] += imag[i];
+    }
+}
+
 template<typename Iterator>
 std::size_t count_error(Iterator first_begin, Iterator first_end, Iterator second_begin) {
     std::size_t error_num{0};
@@ -139,6 +320,18 @@ std::size_t count_error(const T& seq1, const T& seq2) {
     return count_error(std::cbegin(seq1), std::cend(seq1), std::cbegin(seq2));
 }
 
+// Packed version: XOR marks the differing bits of 64 bits at once, popcount counts them.
+inline std::size_t count_error(const packed_bit_seq_t& seq1, const packed_bit_seq_t& seq2) {
+    assert(seq1.size() == seq2.size());
+    const auto* words1 = seq1.data();
+    const auto* words2 = seq2.data();
+    std::size_t error_num{0};
+    for (std::size_t i = 0; i < seq1.num_of_words(); ++i) {
+        error_num += detail::popcount(words1[i] ^ words2[i]);
+    }
+    return error_num;
+}
+
 template<typename InputIterator>
 void print_container(InputIterator begin, InputIterator end) {
     using value_type = typename InputIterator::value_type;
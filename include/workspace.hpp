@@ -0,0 +1,164 @@
+#ifndef INCLUDE_WORKSPACE_HPP
+#define INCLUDE_WORKSPACE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Arena of cache line aligned scratch buffers, handed out and given back in stack order.
+ *
+ * allocate() bumps a pointer through blocks the workspace owns and never initializes the
+ * memory, so a buffer costs neither a heap allocation nor a page-faulting zero fill. A scope
+ * gives back everything taken after it was opened. Once the workspace is empty again its
+ * blocks are merged into one that fits the largest use so far: after the first iteration of
+ * a loop, the iterations run without touching the heap.
+ *
+ * A workspace belongs to one thread; thread_workspace() is the one of the calling thread.
+ */
+class workspace {
+public:
+    static constexpr std::size_t alignment = 64;
+
+    // Position of the bump pointer, see release()
+    struct marker {
+        std::size_t block{0};
+        std::size_t offset{0};
+    };
+
+    // Gives back, when it closes, the buffers taken since it opened.
+    class scope {
+    public:
+        explicit scope(workspace& owner) : _owner(&owner), _marker(owner.mark()) {
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+        ~scope() {
+            _owner->release(_marker);
+        }
+
+    private:
+        workspace* _owner;
+        marker _marker;
+    };
+
+    explicit workspace(const std::size_t initial_capacity = 0) {
+        if (initial_capacity != 0) {
+            _add_block(initial_capacity);
+        }
+    }
+
+    workspace(const workspace&) = delete;
+    workspace& operator=(const workspace&) = delete;
+
+    /**
+     * @brief n uninitialized objects of T, aligned to a cache line.
+     *
+     * T must be trivially copyable and destructible, which std::complex and the sample types
+     * are; the objects are never constructed or destroyed.
+     */
+    template<typename T>
+    T* allocate(const std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "workspace buffers are never constructed");
+        static_assert(alignof(T) <= alignment, "over-aligned type");
+        const std::size_t size = _round_up(n * sizeof(T));
+        while (_current < _blocks.size() && _offset + size > _blocks[_current].size) {
+            ++_current;
+            _offset = 0;
+        }
+        if (_current == _blocks.size()) {
+            _add_block(std::max(size, _capacity()));
+            _offset = 0;
+        }
+        auto* p = _blocks[_current].data.get() + _offset;
+        _offset += size;
+        _peak = std::max(_peak, used());
+        return reinterpret_cast<T*>(p);
+    }
+
+    marker mark() const noexcept {
+        return {_current, _offset};
+    }
+
+    // Gives back everything allocated after m was taken.
+    void release(const marker m) {
+        assert(m.block < _current || (m.block == _current && m.offset <= _offset));
+        _current = m.block;
+        _offset = m.offset;
+        if (used() == 0 && _blocks.size() > 1) {
+            // one block for the whole high-water mark from now on
+            _blocks.clear();
+            _add_block(_peak);
+            _current = 0;
+        }
+    }
+
+    // Bytes in use, counting the ends of blocks skipped for lack of room, and the most ever in use at once
+    std::size_t used() const noexcept {
+        std::size_t used{_offset};
+        for (std::size_t i = 0; i < _current && i < _blocks.size(); ++i) {
+            used += _blocks[i].size;
+        }
+        return used;
+    }
+
+    std::size_t peak() const noexcept {
+        return _peak;
+    }
+
+    std::size_t num_of_blocks() const noexcept {
+        return _blocks.size();
+    }
+
+private:
+    struct aligned_deleter {
+        void operator()(std::byte* p) const noexcept {
+            ::operator delete(p, std::align_val_t{alignment});
+        }
+    };
+
+    struct block {
+        std::unique_ptr<std::byte, aligned_deleter> data;
+        std::size_t size;
+    };
+
+    static constexpr std::size_t _round_up(const std::size_t size) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void _add_block(const std::size_t size) {
+        const std::size_t rounded = _round_up(std::max<std::size_t>(size, alignment));
+        _blocks.push_back({std::unique_ptr<std::byte, aligned_deleter>(static_cast<std::byte*>(::operator new(rounded, std::align_val_t{alignment}))), rounded});
+    }
+
+    std::size_t _capacity() const noexcept {
+        std::size_t capacity{0};
+        for (const auto& b : _blocks) {
+            capacity += b.size;
+        }
+        return capacity;
+    }
+
+    std::vector<block> _blocks{};
+    std::size_t _current{0};
+    std::size_t _offset{0};
+    std::size_t _peak{0};
+};
+
+// The calling thread's workspace
+inline workspace& thread_workspace() {
+    thread_local workspace instance{};
+    return instance;
+}
+
+}
+
+#endif // INCLUDE_WORKSPACE_HPP
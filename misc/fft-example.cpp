@@ -18,32 +18,28 @@
 #include <algorithm>
 #include <random>
 #include <fftw3.h>
+#include "fft.hpp"
 #include "gplot.h"
 #include "utilities.hpp"
 
 
+// Run with COMM_FFTW_WISDOM_DIR set to keep the measured plans for the next runs.
 int main () {
-    fftw_plan plan{};
-    int N = 4096;
-
-    auto* in = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * N));
-        
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    std::normal_distribution<double> distribution(0, 1);
-    for (int i = 0; i < N; ++i) {
-        in[i][0] = std::sin(i);
-        in[i][1] = std::cos(i);
+    constexpr std::size_t N = 4096;
+
+    auto& plans = comm::fft_plan_cache::instance();
+    plans.prewarm({N});
+
+    auto in = comm::make_fftw_buffer(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        in[i] = comm::complex_signal_t(std::sin(i), std::cos(i));
     }
 
-    auto* out = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * N));
-    plan = fftw_plan_dft_1d(N, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-    
-    fftw_execute(plan); /* repeat as needed */
-    
+    comm::fft_in_place(in.get(), N, 1, comm::fft_direction::forward);
+
     std::vector<double> out_d(N);
-    for (int i = 0; i < N; ++i) {
-        out_d[i] = out[i][1];
+    for (std::size_t i = 0; i < N; ++i) {
+        out_d[i] = in[i].imag();
     }
     std::copy(std::cbegin(out_d), std::cend(out_d), std::ostream_iterator<double>(std::cout, "\n"));
 
@@ -51,9 +47,6 @@ int main () {
     std::iota(std::begin(index), std::end(index), 0);
     const auto pair = comm::concatenate(std::begin(index), std::end(index), std::cbegin(out_d));
 
-    fftw_destroy_plan(plan);
-    fftw_free(in); fftw_free(out);
-
     gplot gp;
     gp.add_2D_data("FFT", pair);
     gp.plot();
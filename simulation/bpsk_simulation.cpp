@@ -8,41 +8,69 @@
 #include <cassert>
 #include <fstream>
 #include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
 
+#include "ber.hpp"
+#include "convolutional.hpp"
+#include "importance_sampling.hpp"
+#include "pipeline.hpp"
+#include "profile.hpp"
 #include "psk.hpp"
+#include "sample.hpp"
 #include "utilities.hpp"
 #include "gplot.h"
 
-std::vector<double> simulate(const std::vector<double>& snr_list, const std::size_t num_of_bits) {
-    std::vector<double> ber{};
-    ber.reserve(snr_list.size());
-    for (const auto snr : snr_list) {
-        // Generate random bits
-        comm::bit_seq_t bits = comm::generate_uniformly_distributed_bits(num_of_bits);
-        assert(static_cast<std::size_t>(std::count(std::cbegin(bits), std::cend(bits), 0) + std::count(std::cbegin(bits), std::cend(bits), 1)) == num_of_bits);
-
+std::vector<comm::ber_point> simulate(const std::vector<double>& snr_list, const comm::adaptive_ber_config& config, const comm::sample_type precision,
+                                      const bool sweep) {
+    // Each trial simulates its share of the bits of one SNR point with its own generator.
+    // Points keep getting trials until they have enough errors, so the high SNR tail gets the most bits.
+    return comm::visit_sample_type(precision, [&](auto tag) {
+        using sample_t = typename decltype(tag)::type;
         constexpr double pi = 3.14159265359;
-        // BPSK modulation
-        comm::complex_signal_seq_t symbols = comm::bpsk_modulation(bits, pi);
-        assert(symbols.size() == num_of_bits); // 1 BPSK symbol carries 1 bit
-
-        // Add AWGN noise
-        const auto noise = comm::generate_awgn_noise(symbols.size(), snr);
+        if (sweep) {
+            // Common random numbers: a trial draws its bits and unit noise once and scales the noise to every SNR still running
+            return comm::simulate_ber_adaptive_sweep(snr_list, config, [](const std::vector<double>& snr, const std::size_t num_of_bits, comm::ber_generator_t& generator,
+                                                                       std::size_t* errors) {
+                comm::ber_pipeline<comm::bpsk_modem, sample_t> pipeline{comm::bpsk_modem{pi}};
+                pipeline.run(num_of_bits, snr, generator, errors);
+            });
+        }
+        return comm::simulate_ber_adaptive(snr_list, config, [](const double snr, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+            // Bits -> BPSK modulation -> AWGN -> demodulation -> error count, one cache-sized block at a time
+            comm::ber_pipeline<comm::bpsk_modem, sample_t> pipeline{comm::bpsk_modem{pi}};
+            return pipeline.run(num_of_bits, snr, generator);
+        });
+    });
+}
 
-        // Receive noisy symbols
-        const auto received = comm::add(symbols, noise);
-        #if 0 // Using add_in_place does not matter for an optimized program.
-        comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(symbols));
-        const auto& received = symbols;
-        #endif
+// Importance sampling: biased noise and likelihood-ratio weights, points run until their 95% interval is 10% of the BER
+std::vector<comm::weighted_ber_point> simulate_importance(const std::vector<double>& snr_list, comm::adaptive_ber_config config) {
+    constexpr double pi = 3.14159265359;
+    config.target_relative_width = 0.1;
+    return comm::simulate_ber_importance(snr_list, config, [](const double snr, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        comm::importance_sampling_pipeline<comm::bpsk_modem> pipeline{comm::bpsk_modem{pi}};
+        return pipeline.run(num_of_bits, snr, generator);
+    });
+}
 
-        // Demodulate symbols
-        comm::bit_seq_t demodulated_bits = comm::bpsk_demodulation(received, pi);
-        assert(demodulated_bits.size() == num_of_bits);
+// Convolutionally coded and Viterbi decoded from quantized LLRs; the SNR is EbNo of the information bits
+std::vector<comm::ber_point> simulate_coded(const std::vector<double>& eb_no_list, const comm::adaptive_ber_config& config, const comm::code_rate rate) {
+    constexpr double pi = 3.14159265359;
+    return comm::simulate_ber_adaptive(eb_no_list, config, [rate](const double eb_no, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        comm::coded_ber_pipeline<comm::bpsk_modem> pipeline{rate, comm::bpsk_modem{pi}};
+        return pipeline.run(num_of_bits, eb_no, generator);
+    });
+}
 
-        const auto error_num = comm::count_error(bits, demodulated_bits);
-        ber.push_back(static_cast<double>(error_num) / static_cast<double>(num_of_bits));
-    }
+template<typename Point>
+std::vector<double> to_ber(const std::vector<Point>& points) {
+    std::vector<double> ber{};
+    ber.reserve(points.size());
+    std::transform(std::cbegin(points), std::cend(points), std::back_inserter(ber), [](const Point& point) {
+        return point.ber();
+    });
     return ber;
 }
 
@@ -54,15 +82,78 @@ std::vector<double> bpsk_theory(const std::vector<double>& snr_list) {
     return theory;
 }
 
-int main() {
-    constexpr std::size_t num_of_bits = 1'000'000;
+// The coding gain: rate 1/2 and 3/4 curves against the uncoded theory, points without errors left out of the plot
+void run_coded(comm::adaptive_ber_config config) {
+    config.max_bits = 100'000'000;
+    std::vector<double> eb_no(13);
+    std::generate(std::begin(eb_no), std::end(eb_no), [k = 0]() mutable {
+        return 0.5 * k++;
+    });
+    gplot gp{gplot::type::semilogy};
+    for (const auto rate : {comm::code_rate::rate_1_2, comm::code_rate::rate_3_4}) {
+        const auto points = simulate_coded(eb_no, config, rate);
+        std::cout << "Rate " << comm::to_string(rate) << " coded BER with 95% confidence intervals, SNR is EbNo\n";
+        comm::print_container(std::cbegin(points), std::cend(points));
+        std::vector<std::pair<double, double>> curve{};
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (points[i].num_of_errors > 0) {
+                curve.emplace_back(points[i].snr_db, points[i].ber());
+            }
+        }
+        gp.add_2D_data("BPSK rate " + std::string(comm::to_string(rate)) + " coded sim. with AWGN Channel", curve);
+    }
+    const auto uncoded = bpsk_theory(eb_no);
+    gp.add_2D_data("BPSK uncoded theory. with AWGN Channel", comm::concatenate(std::cbegin(eb_no), std::cend(eb_no), std::cbegin(uncoded)));
+
+    if constexpr (comm::profile::enabled) {
+        const auto profile = comm::profile::report();
+        std::cout << "Time per stage\n";
+        comm::profile::print(std::cout, profile);
+        comm::profile::write_json("bpsk_coded_profile.json", profile);
+    }
+    gp.plot();
+}
+
+int main(int argc, char* argv[]) {
+    comm::adaptive_ber_config config{};
+    config.target_errors = 100;
+    config.max_bits = 1'000'000'000;
+    // The same seed gives the same curve, whatever the number of threads.
+    config.seed = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2022;
+    // float64, float32 or int16 samples, the curves agree down to the precision
+    const auto precision = (argc > 2) ? comm::parse_sample_type(argv[2]) : comm::sample_type::float64;
+    std::cout << "Samples are " << comm::to_string(precision) << "\n";
+    // "sweep" evaluates all SNRs on the same bits and noise, one point's worth of random numbers;
+    // "importance" uses importance sampling, in double, and goes down to BER 1e-10;
+    // "coded" runs the convolutional code at rates 1/2 and 3/4, on double samples
+    const std::string mode = (argc > 3) ? argv[3] : "";
+    const bool sweep = mode == "sweep";
+    const bool importance = mode == "importance";
+    if (comm::profile::enabled && std::getenv("COMM_PROFILE_HARDWARE") != nullptr) {
+        comm::profile::enable_hardware_counters();
+    }
+    if (mode == "coded") {
+        run_coded(config);
+        return 0;
+    }
     std::vector<double> snr{};
     snr.resize(11);
     std::iota(std::begin(snr), std::end(snr), 0);
     snr.push_back(10.6);
-    const auto ber = simulate(snr, num_of_bits);
-    std::cout << "BER result\n";
-    comm::print_container(std::cbegin(ber), std::cend(ber));
+    std::vector<double> ber{};
+    if (importance) {
+        snr.push_back(12.0);
+        snr.push_back(13.0);
+        const auto points = simulate_importance(snr, config);
+        std::cout << "Importance sampling BER with 95% confidence intervals\n";
+        comm::print_container(std::cbegin(points), std::cend(points));
+        ber = to_ber(points);
+    } else {
+        const auto points = simulate(snr, config, precision, sweep);
+        std::cout << "BER result with 95% confidence intervals\n";
+        comm::print_container(std::cbegin(points), std::cend(points));
+        ber = to_ber(points);
+    }
 
     const auto sim = comm::concatenate(std::cbegin(snr), std::cend(snr), std::cbegin(ber));
     std::cout << "Simulation result\n";
@@ -73,6 +164,14 @@ int main() {
     std::cout << "BPSK Theory\n";
     comm::print_container(std::cbegin(theory), std::cend(theory));
 
+    if constexpr (comm::profile::enabled) {
+        // Built by "make profile": where the time of every SNR point went
+        const auto profile = comm::profile::report();
+        std::cout << "Time per stage\n";
+        comm::profile::print(std::cout, profile);
+        comm::profile::write_json("bpsk_profile.json", profile);
+    }
+
     gplot gp{gplot::type::semilogy};
     gp.add_2D_data("BPSK sim. with AWGN Channel", sim);
     gp.add_2D_data("BPSK theory. with AWGN Channel", theory);
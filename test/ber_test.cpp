@@ -0,0 +1,130 @@
+
+#include "doctest.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "ber.hpp"
+#include "pipeline.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("thread pool visits every index once") {
+    comm::thread_pool pool{4};
+    CHECK(pool.size() == 4);
+
+    std::vector<std::atomic<int32_t>> visits(1000);
+    pool.parallel_for(visits.size(), [&visits](const std::size_t i) {
+        ++visits[i];
+    });
+    for (const auto& visit : visits) {
+        CHECK(visit.load() == 1);
+    }
+
+    CHECK_THROWS(pool.parallel_for(10, [](const std::size_t i) {
+        if (i == 7) {
+            throw std::runtime_error("trial failed");
+        }
+    }));
+
+    // a task looping on its own pool runs the inner loop on its thread
+    std::vector<std::atomic<int32_t>> nested(40 * 25);
+    pool.parallel_for(40, [&pool, &nested](const std::size_t i) {
+        pool.parallel_for(25, [&nested, i](const std::size_t j) {
+            ++nested[i * 25 + j];
+        });
+    });
+    for (const auto& visit : nested) {
+        CHECK(visit.load() == 1);
+    }
+}
+
+TEST_CASE("BER engine is reproducible whatever the thread count") {
+    const std::vector<double> snr_list{0, 2, 4, 6};
+    comm::ber_config config{};
+    config.num_of_bits = 100'000;
+    config.bits_per_trial = 4'096;
+    config.seed = 42;
+
+    const auto trial = [](const double snr, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        const auto bits = comm::generate_uniformly_distributed_bits(num_of_bits, generator);
+        const auto symbols = comm::bpsk_modulation(bits);
+        const auto received = comm::add(symbols, comm::generate_awgn_noise(symbols.size(), snr, generator));
+        return comm::count_error(bits, comm::bpsk_demodulation(received));
+    };
+
+    comm::thread_pool serial{1};
+    comm::thread_pool parallel{4};
+    const auto expected = comm::simulate_ber(serial, snr_list, config, trial);
+    const auto result = comm::simulate_ber(parallel, snr_list, config, trial);
+
+    REQUIRE(result.size() == snr_list.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        CHECK(result[i].snr_db == snr_list[i]);
+        CHECK(result[i].num_of_bits == config.num_of_bits);
+        CHECK(result[i].num_of_errors == expected[i].num_of_errors);
+    }
+    // More noise, more errors
+    CHECK(result.front().num_of_errors > result.back().num_of_errors);
+
+    config.seed = 43;
+    const auto other_seed = comm::simulate_ber(parallel, snr_list, config, trial);
+    CHECK(other_seed.front().num_of_errors != result.front().num_of_errors);
+}
+
+TEST_CASE("BER sweeps share their random numbers across points") {
+    const std::vector<double> snr_list{0, 2, 4, 6, 10};
+    const auto trial = [](const std::vector<double>& snr, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        comm::ber_pipeline<comm::bpsk_modem> pipeline{};
+        return pipeline.run(num_of_bits, snr, generator);
+    };
+    comm::thread_pool serial{1};
+    comm::thread_pool parallel{4};
+
+    comm::ber_config config{};
+    config.num_of_bits = 300'000;
+    config.bits_per_trial = 8'192;
+    config.seed = 7;
+    const auto expected = comm::simulate_ber_sweep(serial, snr_list, config, trial);
+    const auto result = comm::simulate_ber_sweep(parallel, snr_list, config, trial);
+    REQUIRE(result.size() == snr_list.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        CHECK(result[i].snr_db == snr_list[i]);
+        CHECK(result[i].num_of_bits == config.num_of_bits);
+        CHECK(result[i].num_of_errors == expected[i].num_of_errors);
+        if (i > 0) {
+            CHECK(result[i].num_of_errors < result[i - 1].num_of_errors);
+        }
+        const double theory = 0.5 * std::erfc(std::sqrt(std::pow(10, snr_list[i] / 10)));
+        CHECK(std::abs(result[i].ber() - theory) < 5 * std::sqrt(theory / config.num_of_bits));
+    }
+
+    comm::adaptive_ber_config adaptive{};
+    adaptive.target_errors = 200;
+    adaptive.max_bits = 2'000'000;
+    adaptive.bits_per_trial = 8'192;
+    adaptive.seed = 7;
+    const auto adaptive_expected = comm::simulate_ber_adaptive_sweep(serial, snr_list, adaptive, trial);
+    // a trial that adds to the engine's counts instead of returning them gives the same points
+    const auto counting_trial = [](const std::vector<double>& snr, const std::size_t num_of_bits, comm::ber_generator_t& generator, std::size_t* errors) {
+        comm::ber_pipeline<comm::bpsk_modem> pipeline{};
+        pipeline.run(num_of_bits, snr, generator, errors);
+    };
+    const auto adaptive_result = comm::simulate_ber_adaptive_sweep(parallel, snr_list, adaptive, counting_trial);
+    REQUIRE(adaptive_result.size() == snr_list.size());
+    for (std::size_t i = 0; i < adaptive_result.size(); ++i) {
+        CAPTURE(snr_list[i]);
+        CHECK(adaptive_result[i].num_of_errors == adaptive_expected[i].num_of_errors);
+        CHECK(adaptive_result[i].num_of_bits == adaptive_expected[i].num_of_bits);
+        CHECK((adaptive_result[i].num_of_errors >= adaptive.target_errors || adaptive_result[i].num_of_bits >= adaptive.max_bits));
+        if (i > 0) {
+            // the harder points ran on a superset of the easier points' trials
+            CHECK(adaptive_result[i].num_of_bits >= adaptive_result[i - 1].num_of_bits);
+        }
+    }
+    CHECK(adaptive_result.front().num_of_bits < adaptive_result.back().num_of_bits);
+    CHECK(adaptive_result.back().num_of_bits == adaptive.max_bits);
+}
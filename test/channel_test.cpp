@@ -0,0 +1,204 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "channel.hpp"
+#include "utilities.hpp"
+
+
+namespace {
+    // Pushes signal through stage in chunks of irregular sizes
+    template<typename Stage>
+    void process_in_pieces(Stage& stage, comm::complex_signal_seq_t& signal, comm::random_stream& gen) {
+        const std::size_t sizes[] = {1, 37, 500, 3, 1024, 2049, 64};
+        std::size_t done = 0;
+        for (std::size_t i = 0; done < signal.size(); ++i) {
+            const std::size_t m = std::min(sizes[i % std::size(sizes)], signal.size() - done);
+            stage.process(signal.data() + done, m, gen);
+            done += m;
+        }
+    }
+
+    // Gains of a flat fading stage, seen through a signal of ones
+    template<typename Stage>
+    comm::complex_signal_seq_t gains(Stage& stage, const std::size_t n, comm::random_stream& gen) {
+        comm::complex_signal_seq_t signal(n, comm::complex_signal_t{1.0, 0.0});
+        stage.process(signal.data(), n, gen);
+        return signal;
+    }
+}
+
+TEST_CASE("multipath direct and overlap-save match the convolution across chunks") {
+    constexpr std::size_t n = 10000;
+    comm::random_stream gen{41, 0};
+    const auto input = comm::generate_awgn_noise(n, 0.0, gen);
+    for (const std::size_t num_of_taps : {1, 5, 33, 100}) {
+        CAPTURE(num_of_taps);
+        const auto taps = comm::generate_awgn_noise(num_of_taps, 10.0, gen);
+        const std::vector<comm::complex_signal_t> tap_list(std::cbegin(taps), std::cend(taps));
+
+        comm::complex_signal_seq_t expected(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = 0; k < num_of_taps && k <= i; ++k) {
+                expected[i] += tap_list[k] * input[i - k];
+            }
+        }
+
+        comm::multipath_stage direct{tap_list, num_of_taps};
+        comm::multipath_stage overlap_save{tap_list, 0};
+        CHECK(direct.fft_size() == 0);
+        CHECK(overlap_save.fft_size() >= 4 * num_of_taps);
+        for (auto* stage : {&direct, &overlap_save}) {
+            auto signal = input;
+            process_in_pieces(*stage, signal, gen);
+            double error = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                error = std::max(error, std::abs(signal[i] - expected[i]));
+            }
+            CHECK(error < 1e-9);
+
+            stage->reset();
+            signal = input;
+            stage->process(signal.data(), n, gen);
+            CHECK(std::abs(signal[n - 1] - expected[n - 1]) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE("frequency offset and phase noise rotate without changing magnitudes") {
+    constexpr std::size_t n = 100000;
+    comm::random_stream gen{42, 0};
+    const auto input = comm::generate_awgn_noise(n, 0.0, gen);
+
+    comm::cfo_stage cfo{0.0123, 0.5};
+    auto rotated = input;
+    process_in_pieces(cfo, rotated, gen);
+    double error = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double phase = 2 * M_PI * std::fmod(0.0123 * static_cast<double>(i), 1.0) + 0.5;
+        error = std::max(error, std::abs(rotated[i] - input[i] * std::polar(1.0, phase)));
+    }
+    CHECK(error < 1e-10);
+
+    // the phase steps are N(0, 2 pi linewidth)
+    constexpr double linewidth = 1e-4;
+    comm::phase_noise_stage phase_noise{linewidth};
+    const auto noisy = gains(phase_noise, n, gen);
+    double sum_of_squares = 0.0;
+    for (std::size_t i = 1; i < n; ++i) {
+        CHECK(std::abs(std::abs(noisy[i]) - 1.0) < 1e-12);
+        const double step = std::arg(noisy[i] * std::conj(noisy[i - 1]));
+        sum_of_squares += step * step;
+    }
+    CHECK(sum_of_squares / (n - 1) == doctest::Approx(2 * M_PI * linewidth).epsilon(0.02));
+}
+
+TEST_CASE("fading has unit power, the Jakes autocorrelation and the Rayleigh or Rician envelope") {
+    constexpr double doppler = 0.01;
+    constexpr std::size_t n = 1 << 18;
+    comm::random_stream gen{43, 0};
+    comm::sos_fading_stage rayleigh{doppler};
+    const auto h = gains(rayleigh, n, gen);
+
+    // a chunked run of the same realization gives the same gains
+    rayleigh.reset();
+    comm::random_stream same_gen{43, 0};
+    comm::complex_signal_seq_t pieces(n, comm::complex_signal_t{1.0, 0.0});
+    process_in_pieces(rayleigh, pieces, same_gen);
+    double error = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        error = std::max(error, std::abs(pieces[i] - h[i]));
+    }
+    CHECK(error < 1e-9);
+
+    double power = 0.0;
+    for (const auto& gain : h) {
+        power += std::norm(gain);
+    }
+    CHECK(power / n == doctest::Approx(1.0).epsilon(0.05));
+    for (const std::size_t lag : {10, 25, 50}) {
+        CAPTURE(lag);
+        comm::complex_signal_t correlation{};
+        for (std::size_t i = 0; i + lag < n; ++i) {
+            correlation += h[i + lag] * std::conj(h[i]);
+        }
+        correlation /= static_cast<double>(n - lag);
+        CHECK(std::abs(correlation.real() - std::cyl_bessel_j(0.0, 2 * M_PI * doppler * lag)) < 0.05);
+    }
+
+    // over many realizations |h|^2 is exponential for Rayleigh, and its spread gives K for Rician
+    for (const double rician_k : {0.0, 4.0}) {
+        CAPTURE(rician_k);
+        comm::sos_fading_stage fading{0.05, rician_k};
+        double sum = 0.0;
+        double sum_of_squares = 0.0;
+        std::size_t below_mean = 0;
+        constexpr std::size_t realizations = 400;
+        constexpr std::size_t length = 2000;
+        for (std::size_t r = 0; r < realizations; ++r) {
+            fading.reset();
+            for (const auto& gain : gains(fading, length, gen)) {
+                sum += std::norm(gain);
+                sum_of_squares += std::norm(gain) * std::norm(gain);
+                below_mean += std::norm(gain) < 1.0;
+            }
+        }
+        const double count = realizations * length;
+        const double mean = sum / count;
+        CHECK(mean == doctest::Approx(1.0).epsilon(0.05));
+        if (rician_k == 0.0) {
+            CHECK(below_mean / count == doctest::Approx(1 - std::exp(-1.0)).epsilon(0.03));
+        } else {
+            // E|h|^4 / E|h|^2^2 = (2 + 4K + K^2) / (1 + K)^2
+            const double expected = (2 + 4 * rician_k + rician_k * rician_k) / ((1 + rician_k) * (1 + rician_k));
+            CHECK(sum_of_squares / count / (mean * mean) == doctest::Approx(expected).epsilon(0.05));
+        }
+    }
+
+    comm::block_fading_stage block{100};
+    const auto block_gains = gains(block, 200000, gen);
+    double block_power = 0.0;
+    for (std::size_t i = 0; i < block_gains.size(); ++i) {
+        if (i % 100 != 0) {
+            CHECK(block_gains[i] == block_gains[i - 1]);
+        }
+        block_power += std::norm(block_gains[i]);
+    }
+    CHECK(block_power / block_gains.size() == doctest::Approx(1.0).epsilon(0.1));
+    CHECK(block.gain() == block_gains.back());
+}
+
+TEST_CASE("a channel runs its stages chunk by chunk with the result of whole-signal stages") {
+    constexpr std::size_t n = 5000;
+    comm::random_stream gen{44, 0};
+    const auto input = comm::generate_awgn_noise(n, 0.0, gen);
+    const std::vector<comm::complex_signal_t> taps{{0.8, 0.0}, {0.0, 0.5}, {0.3, -0.1}};
+
+    auto channel = comm::make_channel(comm::multipath_stage{taps}, comm::cfo_stage{1e-3}, comm::awgn_stage{6.0});
+    auto received = input;
+    comm::random_stream channel_gen{45, 0};
+    channel.process(received, channel_gen);
+
+    // only the noise is random, so whole-signal stages draw the same samples
+    auto expected = input;
+    comm::random_stream stage_gen{45, 0};
+    comm::multipath_stage{taps}.process(expected.data(), n, stage_gen);
+    comm::cfo_stage{1e-3}.process(expected.data(), n, stage_gen);
+    comm::awgn_stage{6.0}.process(expected.data(), n, stage_gen);
+    double error = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        error = std::max(error, std::abs(received[i] - expected[i]));
+    }
+    CHECK(error < 1e-12);
+    CHECK(channel_gen == stage_gen);
+
+    comm::random_stream noise_gen{45, 0};
+    const auto noise = comm::generate_awgn_noise(n, 6.0, noise_gen);
+    auto noisy = input;
+    comm::random_stream awgn_gen{45, 0};
+    comm::awgn_stage{6.0}.process(noisy.data(), n, awgn_gen);
+    CHECK(noisy == comm::add(input, noise));
+}
@@ -0,0 +1,106 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "constellation.hpp"
+#include "pipeline.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+namespace {
+    template<typename Constellation>
+    void check_constellation() {
+        constexpr auto& points = Constellation::points;
+        CAPTURE(Constellation::order);
+
+        double energy = 0;
+        double min_distance = std::numeric_limits<double>::max();
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            energy += std::norm(points[i]);
+            for (std::size_t j = i + 1; j < points.size(); ++j) {
+                min_distance = std::min(min_distance, std::abs(points[i] - points[j]));
+            }
+        }
+        CHECK(energy / points.size() == doctest::Approx(1.0).epsilon(1e-12));
+
+        // Gray: nearest neighbours differ in a single bit
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            CHECK(Constellation::decide(points[i]) == i);
+            for (std::size_t j = i + 1; j < points.size(); ++j) {
+                if (std::abs(points[i] - points[j]) < min_distance * (1 + 1e-9)) {
+                    CHECK(comm::detail::popcount(i ^ j) == 1);
+                }
+            }
+        }
+
+        // Slicing agrees with the nearest point
+        comm::random_stream gen{8, Constellation::order};
+        const auto noise = comm::generate_awgn_noise(10000, 3.0, gen);
+        for (std::size_t n = 0; n < noise.size(); ++n) {
+            const auto received = points[n % points.size()] + noise[n];
+            std::size_t nearest = 0;
+            for (std::size_t i = 1; i < points.size(); ++i) {
+                nearest = (std::abs(received - points[i]) < std::abs(received - points[nearest])) ? i : nearest;
+            }
+            CHECK(Constellation::decide(received) == nearest);
+        }
+
+        // Round trip, byte and packed versions
+        const auto bits = comm::generate_uniformly_distributed_bits(Constellation::bits_per_symbol * 333, gen);
+        const auto symbols = comm::modulate<Constellation>(bits);
+        CHECK(comm::demodulate<Constellation>(symbols) == bits);
+
+        const comm::packed_bit_seq_t packed{bits};
+        comm::complex_signal_seq_t packed_symbols(symbols.size());
+        comm::modulate<Constellation>(packed.data(), packed.size(), packed_symbols.data());
+        CHECK(packed_symbols == symbols);
+        comm::packed_bit_seq_t demodulated(bits.size());
+        comm::demodulate<Constellation>(symbols.data(), symbols.size(), demodulated.data());
+        CHECK(demodulated == packed);
+    }
+}
+
+TEST_CASE("constellations are Gray labelled with unit energy") {
+    check_constellation<comm::psk_constellation<2>>();
+    check_constellation<comm::psk_constellation<4>>();
+    check_constellation<comm::psk_constellation<8>>();
+    check_constellation<comm::psk_constellation<16>>();
+    check_constellation<comm::qam_constellation<4>>();
+    check_constellation<comm::qam_constellation<16>>();
+    check_constellation<comm::qam_constellation<64>>();
+    check_constellation<comm::qam_constellation<256>>();
+}
+
+TEST_CASE("constellations reproduce BPSK and QPSK") {
+    static_assert(comm::psk_constellation<8>::bits_per_symbol == 3);
+    static_assert(comm::qam_constellation<64>::points.size() == 64);
+
+    const auto bits = comm::generate_uniformly_distributed_bits(200);
+    const auto bpsk = comm::bpsk_modulation(bits);
+    const auto psk2 = comm::modulate<comm::psk_constellation<2>>(bits);
+    const auto qpsk = comm::qpsk_modulation(bits);
+    const auto psk4 = comm::modulate<comm::psk_constellation<4>>(bits);
+    const auto qam4 = comm::modulate<comm::qam_constellation<4>>(bits);
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        CHECK(std::abs(psk2[i] - bpsk[i]) < 1e-15);
+    }
+    for (std::size_t i = 0; i < qpsk.size(); ++i) {
+        CHECK(std::abs(psk4[i] - qpsk[i]) < 1e-15);
+        CHECK(std::abs(qam4[i] - qpsk[i]) < 1e-15);
+    }
+}
+
+TEST_CASE("16-QAM pipeline follows the theory") {
+    // Gray 16-QAM, P_b ~ 3/8 erfc(sqrt(Es/No / 10)) at high SNR
+    constexpr std::size_t num_of_bits = 400'000;
+    constexpr double snr_db = 14.0;
+    const double theory = 0.375 * std::erfc(std::sqrt(std::pow(10, snr_db / 10) / 10));
+
+    comm::ber_pipeline<comm::constellation_modem<comm::qam_constellation<16>>> pipeline{};
+    comm::random_stream stream{21, 0};
+    const double ber = static_cast<double>(pipeline.run(num_of_bits, snr_db, stream)) / num_of_bits;
+    CHECK(std::abs(ber - theory) < 5 * std::sqrt(theory / num_of_bits) + 0.05 * theory);
+}
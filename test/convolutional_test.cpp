@@ -0,0 +1,169 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "convolutional.hpp"
+#include "llr.hpp"
+#include "packed_bits.hpp"
+#include "pipeline.hpp"
+#include "psk.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+#include "simd_test_utilities.hpp"
+
+
+namespace {
+    constexpr comm::code_rate all_rates[] = {comm::code_rate::rate_1_2, comm::code_rate::rate_2_3, comm::code_rate::rate_3_4};
+
+    // The shift register, one bit at a time, and the 802.11 puncturing
+    comm::bit_seq_t reference_encode(comm::bit_seq_t bits, const comm::code_rate rate) {
+        static const std::vector<std::vector<bool>> patterns{{true, true}, {true, true, true, false}, {true, true, true, false, false, true}};
+        const auto& keep = patterns[static_cast<std::size_t>(rate)];
+        bits.resize(bits.size() + 6, 0);
+        comm::bit_seq_t coded{};
+        unsigned state = 0;
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            const unsigned reg = (static_cast<unsigned>(bits[i]) << 6U) | state;
+            const std::size_t step = i % (keep.size() / 2);
+            if (keep[2 * step]) {
+                coded.push_back(static_cast<comm::bit_t>(__builtin_parity(reg & 0171U)));
+            }
+            if (keep[2 * step + 1]) {
+                coded.push_back(static_cast<comm::bit_t>(__builtin_parity(reg & 0133U)));
+            }
+            state = reg >> 1U;
+        }
+        return coded;
+    }
+
+    std::vector<int8_t> to_soft(const comm::bit_seq_t& coded, const int8_t magnitude) {
+        std::vector<int8_t> soft(coded.size());
+        for (std::size_t i = 0; i < coded.size(); ++i) {
+            soft[i] = coded[i] ? static_cast<int8_t>(-magnitude) : magnitude;
+        }
+        return soft;
+    }
+}
+
+TEST_CASE("the packed encoder matches the shift register, in chunks and punctured") {
+    comm::random_stream gen{81, 0};
+    const std::size_t n = 64 * 37 + 23;
+    const auto bits = comm::generate_uniformly_distributed_bits(n, gen);
+    const comm::packed_bit_seq_t packed{bits};
+    for (const auto rate : all_rates) {
+        CAPTURE(comm::to_string(rate));
+        const auto expected = reference_encode(bits, rate);
+        REQUIRE(comm::coded_length(n, rate) == expected.size());
+        CHECK(comm::convolutional_encode(bits, rate) == expected);
+
+        // whole words per call but the last, written one after the other from odd offsets
+        comm::convolutional_encoder encoder{rate};
+        std::vector<uint64_t> words(expected.size() / 64 + 2, ~uint64_t{0});
+        std::size_t length = 0;
+        for (std::size_t done = 0, chunk = 64; done < n; done += chunk, chunk = chunk % 320 + 64) {
+            chunk = std::min(chunk, n - done);
+            length += encoder.encode(packed.data() + done / 64, chunk, words.data(), length);
+        }
+        length += encoder.terminate(words.data(), length);
+        REQUIRE(length == expected.size());
+        for (std::size_t i = 0; i < length; ++i) {
+            CHECK(((words[i / 64] >> (i % 64)) & 1U) == expected[i]);
+        }
+    }
+}
+
+TEST_CASE("Viterbi decoding corrects errors the same on every instruction set and in chunks") {
+    comm::random_stream gen{82, 0};
+    const std::size_t n = 10000;
+    const auto bits = comm::generate_uniformly_distributed_bits(n, gen);
+    const simd_test::isa_guard guard{};
+    for (const auto rate : all_rates) {
+        CAPTURE(comm::to_string(rate));
+        const auto coded = comm::convolutional_encode(bits, rate);
+        // one hard error in 50 coded bits
+        auto corrupted = coded;
+        for (std::size_t i = 17; i < corrupted.size(); i += 50) {
+            corrupted[i] ^= 1U;
+        }
+        auto soft = to_soft(coded, 16);
+        for (auto& value : soft) {
+            value = static_cast<int8_t>(value + static_cast<int>(gen() % 41) - 20);
+        }
+        const auto clean = to_soft(coded, 20);
+
+        for (const auto metric : {comm::viterbi_metric::int8, comm::viterbi_metric::int16}) {
+            CAPTURE(static_cast<int>(metric));
+            CHECK(comm::viterbi_decode(clean, rate, metric) == bits);
+
+            // a soft value per call, the metrics renormalized all the same
+            comm::viterbi_decoder streaming{rate, comm::viterbi_decoder::default_traceback_depth, metric};
+            comm::bit_seq_t streamed(n + streaming.traceback_depth());
+            std::size_t num_of_streamed = 0;
+            for (std::size_t i = 0; i < clean.size(); ++i) {
+                num_of_streamed += streaming.decode(clean.data() + i, 1, streamed.data() + num_of_streamed);
+            }
+            num_of_streamed += streaming.finish(streamed.data() + num_of_streamed);
+            streamed.resize(num_of_streamed);
+            CHECK(streamed == bits);
+
+            // isolated hard errors
+            comm::viterbi_decoder hard{rate, comm::viterbi_decoder::default_traceback_depth, metric};
+            comm::bit_seq_t decoded(n + hard.traceback_depth());
+            std::size_t num_of_bits = hard.decode_hard(corrupted.data(), corrupted.size(), decoded.data());
+            num_of_bits += hard.finish(decoded.data() + num_of_bits);
+            REQUIRE(num_of_bits == n);
+            decoded.resize(n);
+            CHECK(decoded == bits);
+
+            // noisy soft values: every kernel and every chunking gives the same bits
+            comm::set_simd_isa(comm::simd_isa::scalar);
+            const auto reference = comm::viterbi_decode(soft, rate, metric);
+            REQUIRE(reference.size() == n);
+            for (const auto isa : simd_test::supported_isa_list()) {
+                CAPTURE(isa);
+                comm::set_simd_isa(isa);
+                CHECK(comm::viterbi_decode(soft, rate, metric) == reference);
+
+                comm::viterbi_decoder decoder{rate, comm::viterbi_decoder::default_traceback_depth, metric};
+                comm::bit_seq_t chunked(soft.size() + decoder.traceback_depth());
+                std::size_t num_of_chunked = 0;
+                for (std::size_t done = 0, chunk = 1; done < soft.size(); done += chunk, chunk = chunk * 5 % 3001 + 1) {
+                    chunk = std::min(chunk, soft.size() - done);
+                    num_of_chunked += decoder.decode(soft.data() + done, chunk, chunked.data() + num_of_chunked);
+                }
+                num_of_chunked += decoder.finish(chunked.data() + num_of_chunked);
+                chunked.resize(num_of_chunked);
+                CHECK(chunked == reference);
+            }
+        }
+    }
+    CHECK_THROWS_AS(comm::viterbi_decoder(comm::code_rate::rate_1_2, 5), std::invalid_argument);
+    CHECK_THROWS_AS(comm::viterbi_decoder(comm::code_rate::rate_1_2, comm::viterbi_decoder::max_traceback_depth + 1), std::invalid_argument);
+}
+
+TEST_CASE("coded BER pipeline: the code gains several dB over uncoded transmission") {
+    constexpr std::size_t num_of_bits = 200000;
+    constexpr double eb_n0_db = 4.0;
+    // uncoded BPSK at 4 dB is 1.25e-2
+    const double uncoded = 0.5 * std::erfc(std::sqrt(std::pow(10, eb_n0_db / 10)));
+    {
+        comm::random_stream gen{83, 0};
+        comm::coded_ber_pipeline<comm::bpsk_modem> pipeline{comm::code_rate::rate_1_2};
+        CHECK(static_cast<double>(pipeline.run(num_of_bits, eb_n0_db, gen)) / num_of_bits < uncoded / 100);
+    }
+    {
+        comm::random_stream gen{84, 0};
+        comm::coded_ber_pipeline<comm::qpsk_modem> pipeline{comm::code_rate::rate_3_4};
+        CHECK(static_cast<double>(pipeline.run(num_of_bits, eb_n0_db + 1, gen)) / num_of_bits < uncoded / 10);
+    }
+    {
+        // a short codeword in one partial block, and the same bits again give the same errors
+        comm::random_stream gen{85, 0};
+        comm::random_stream same{85, 0};
+        comm::coded_ber_pipeline<comm::qpsk_modem> pipeline{comm::code_rate::rate_2_3};
+        const auto errors = pipeline.run(1001, 1.0, gen);
+        CHECK(pipeline.run(1001, 1.0, same) == errors);
+    }
+}
@@ -0,0 +1,103 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "fft.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("FFT plans are cached and match the DFT") {
+    constexpr std::size_t n = 16;
+    constexpr std::size_t batch = 3;
+    auto buffer = comm::make_fftw_buffer(n * batch);
+    comm::random_stream gen{1, 2};
+    const auto input = comm::generate_awgn_noise(n * batch, 0.0, gen);
+    std::copy(std::cbegin(input), std::cend(input), buffer.get());
+
+    comm::fft_in_place(buffer.get(), n, batch, comm::fft_direction::forward);
+    const auto num_of_plans = comm::fft_plan_cache::instance().size();
+    CHECK(comm::fft_plan_cache::instance().get(n, batch, comm::fft_direction::forward) ==
+          comm::fft_plan_cache::instance().get(n, batch, comm::fft_direction::forward));
+    CHECK(comm::fft_plan_cache::instance().size() == num_of_plans);
+
+    for (std::size_t b = 0; b < batch; ++b) {
+        for (std::size_t k = 0; k < n; ++k) {
+            std::complex<double> expected{};
+            for (std::size_t j = 0; j < n; ++j) {
+                expected += input[b * n + j] * std::polar(1.0, -2 * M_PI * static_cast<double>(j * k) / n);
+            }
+            CHECK(std::abs(buffer[b * n + k] - expected) < 1e-12);
+        }
+    }
+}
+
+TEST_CASE("FFT wisdom files and shared plans") {
+    auto& cache = comm::fft_plan_cache::instance();
+    const auto previous = cache.config();
+    const auto directory = std::filesystem::temp_directory_path() / "comm-fft-wisdom-test";
+    std::filesystem::remove_all(directory);
+
+    comm::fft_plan_config config{};
+    config.wisdom_directory = directory.string();
+    cache.configure(config);
+    const auto path = comm::fft_plan_cache::wisdom_path(config);
+    CHECK(path.find(comm::detail::cpu_signature()) != std::string::npos);
+
+    // the plans of every size share the one file
+    cache.prewarm({24, 40});
+    CHECK(std::filesystem::exists(path));
+    CHECK(std::distance(std::filesystem::directory_iterator{directory}, std::filesystem::directory_iterator{}) == 1);
+
+    // every thread gets the one plan of a key
+    std::vector<fftw_plan> plans(4);
+    std::vector<std::thread> threads{};
+    for (std::size_t i = 0; i < plans.size(); ++i) {
+        threads.emplace_back([&plans, i]() {
+            plans[i] = comm::fft_plan_cache::instance().get(48, 2, comm::fft_direction::forward);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto plan : plans) {
+        CHECK(plan == plans.front());
+    }
+
+    cache.configure(previous);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("signal sequences go through PSK, noise and FFT in place") {
+    constexpr std::size_t n = 64;
+    constexpr std::size_t batch = 4;
+    comm::random_stream gen{3, 4};
+    const auto bits = comm::generate_uniformly_distributed_bits(2 * n * batch, gen);
+    auto signal = comm::qpsk_modulation(bits);
+    const auto noise = comm::generate_awgn_noise(signal.size(), 10.0, gen);
+    comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(signal));
+#ifdef FFTW_COMPLEX_TYPE
+    CHECK(fftw_alignment_of(reinterpret_cast<double*>(signal.data())) == 0);
+#endif
+
+    auto reference = comm::make_fftw_buffer(signal.size());
+    std::copy(std::cbegin(signal), std::cend(signal), reference.get());
+    comm::fft_in_place(reference.get(), n, batch, comm::fft_direction::forward);
+
+    // Without FFTW_COMPLEX_TYPE the vector may be misaligned for the cached plan
+    auto* data = signal.data();
+#ifndef FFTW_COMPLEX_TYPE
+    auto aligned = comm::make_fftw_buffer(signal.size());
+    std::copy(std::cbegin(signal), std::cend(signal), aligned.get());
+    data = aligned.get();
+#endif
+    comm::fft_in_place(data, n, batch, comm::fft_direction::forward);
+    for (std::size_t i = 0; i < signal.size(); ++i) {
+        CHECK(data[i] == reference[i]);
+    }
+}
@@ -0,0 +1,80 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "importance_sampling.hpp"
+#include "pipeline.hpp"
+
+
+namespace {
+    // Both BPSK and QPSK, Es/N0 for QPSK
+    double theory(const double snr_db, const std::size_t bits_per_symbol) {
+        return 0.5 * std::erfc(std::sqrt(std::pow(10, snr_db / 10) / static_cast<double>(bits_per_symbol)));
+    }
+}
+
+TEST_CASE("importance sampling without bias is plain Monte Carlo") {
+    constexpr std::size_t num_of_bits = 100'000;
+    comm::importance_sampling_pipeline<comm::qpsk_modem> unbiased{comm::qpsk_modem{}, comm::importance_sampling_config{0.0, 1.0}};
+    comm::ber_pipeline<comm::qpsk_modem> plain{};
+    comm::random_stream unbiased_stream{3, 1};
+    comm::random_stream plain_stream{3, 1};
+    const auto errors = unbiased.run(num_of_bits, 3.0, unbiased_stream);
+    CHECK(errors.weight_sum == doctest::Approx(static_cast<double>(errors.num_of_errors)));
+    CHECK(errors.weight_square_sum == doctest::Approx(static_cast<double>(errors.num_of_errors)));
+    CHECK(errors.num_of_errors == plain.run(num_of_bits, 3.0, plain_stream));
+    CHECK(unbiased_stream == plain_stream);
+}
+
+TEST_CASE("importance sampling reaches the deep tail with few bits") {
+    constexpr std::size_t num_of_bits = 200'000;
+    for (const double snr_db : {4.0, 9.0, 12.5}) {
+        CAPTURE(snr_db);
+        comm::random_stream stream{21, 0};
+        comm::importance_sampling_pipeline<comm::bpsk_modem> bpsk{comm::bpsk_modem{0.3}};
+        const comm::weighted_ber_point bpsk_point{snr_db, num_of_bits, bpsk.run(num_of_bits, snr_db, stream)};
+        CHECK(std::abs(bpsk_point.ber() - theory(snr_db, 1)) < 5 * bpsk_point.standard_error());
+        CHECK(bpsk_point.relative_error() < 0.02);
+
+        comm::importance_sampling_pipeline<comm::qpsk_modem> qpsk{};
+        const comm::weighted_ber_point qpsk_point{snr_db, num_of_bits, qpsk.run(num_of_bits, snr_db, stream)};
+        CHECK(std::abs(qpsk_point.ber() - theory(snr_db, 2)) < 5 * qpsk_point.standard_error());
+        CHECK(qpsk_point.relative_error() < 0.02);
+    }
+
+    // a wider biased noise is unbiased as well
+    comm::random_stream stream{22, 0};
+    comm::importance_sampling_pipeline<comm::bpsk_modem> wide{comm::bpsk_modem{}, comm::importance_sampling_config{1.0, 1.3}};
+    const comm::weighted_ber_point point{10.0, num_of_bits, wide.run(num_of_bits, 10.0, stream)};
+    CHECK(std::abs(point.ber() - theory(10.0, 1)) < 5 * point.standard_error());
+}
+
+TEST_CASE("importance sampling BER engine stops on the interval width and is reproducible") {
+    const std::vector<double> snr_list{6.0, 10.0, 13.0};
+    comm::adaptive_ber_config config{};
+    config.target_errors = 100;
+    config.target_relative_width = 0.05;
+    config.max_bits = 100'000'000;
+    config.bits_per_trial = 4'096;
+    config.seed = 5;
+    const auto trial = [](const double snr_db, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        comm::importance_sampling_pipeline<comm::bpsk_modem> pipeline{};
+        return pipeline.run(num_of_bits, snr_db, generator);
+    };
+
+    comm::thread_pool serial{1};
+    comm::thread_pool parallel{4};
+    const auto expected = comm::simulate_ber_importance(serial, snr_list, config, trial);
+    const auto result = comm::simulate_ber_importance(parallel, snr_list, config, trial);
+    REQUIRE(result.size() == snr_list.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        CAPTURE(snr_list[i]);
+        CHECK(result[i].num_of_bits == expected[i].num_of_bits);
+        CHECK(result[i].ber() == expected[i].ber());
+        CHECK(result[i].interval().width() <= config.target_relative_width * result[i].ber());
+        // BER 1e-10 at 13 dB in about a million bits, where plain Monte Carlo would need 1e12
+        CHECK(result[i].num_of_bits < 2'000'000);
+        CHECK(std::abs(result[i].ber() - theory(snr_list[i], 1)) < 5 * result[i].standard_error());
+    }
+}
@@ -0,0 +1,107 @@
+#include "doctest.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "iq_file.hpp"
+#include "packed_bits.hpp"
+#include "psk.hpp"
+#include "random.hpp"
+#include "utilities.hpp"
+
+
+namespace {
+    void remove_capture(const std::string& base) {
+        std::remove(comm::sigmf_data_path(base).c_str());
+        std::remove(comm::sigmf_meta_path(base).c_str());
+    }
+}
+
+TEST_CASE("a capture is modulated into and demodulated from the mapped files") {
+    const std::string base = "iq_file_test";
+    // several times the first mapping, so the file grows and is remapped
+    constexpr std::size_t block_size = 1 << 16;
+    constexpr std::size_t num_of_blocks = 10;
+    comm::random_stream gen{51, 0};
+    std::vector<uint64_t> bits(comm::packed_bit_seq_t::num_of_words(block_size * num_of_blocks));
+    gen.generate(bits.data(), bits.data() + bits.size());
+    {
+        comm::iq_writer<comm::complex_signal_t> writer{base, {2e6, 915e6, "BPSK \"test\" capture"}};
+        for (std::size_t block = 0; block < num_of_blocks; ++block) {
+            auto* symbols = writer.extend(block_size);
+            comm::bpsk_modulation(bits.data() + block * block_size / 64, block_size, symbols);
+            const auto noise = comm::generate_awgn_noise(block_size, 8.0, gen);
+            comm::add_in_place(std::cbegin(noise), std::cend(noise), symbols);
+        }
+        CHECK(writer.size() == block_size * num_of_blocks);
+    }
+
+    const comm::iq_reader<comm::complex_signal_t> reader{base};
+    REQUIRE(reader.size() == block_size * num_of_blocks);
+    CHECK(reader.metadata().sample_rate == 2e6);
+    CHECK(reader.metadata().frequency == 915e6);
+    CHECK(reader.metadata().description == "BPSK \"test\" capture");
+
+    std::vector<uint64_t> demodulated(bits.size());
+    comm::bpsk_demodulation(reader.data(), reader.size(), demodulated.data());
+    std::size_t errors = 0;
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        errors += comm::detail::popcount(bits[i] ^ demodulated[i]);
+    }
+    // BER at 8 dB is about 2e-4
+    CHECK(errors > 0);
+    CHECK(errors < block_size * num_of_blocks / 1000);
+
+    CHECK_THROWS_AS(comm::iq_reader<comm::complex_float_t>{base}, std::invalid_argument);
+    remove_capture(base);
+    CHECK_THROWS_AS(comm::iq_reader<comm::complex_signal_t>{base}, std::system_error);
+}
+
+TEST_CASE("fixed-point and empty captures round trip") {
+    const std::string base = "iq_file_int16_test";
+    const std::vector<comm::complex_int16_t> samples{{1, -2}, {32767, -32768}, {0, 7}};
+    {
+        comm::iq_writer<comm::complex_int16_t> writer{base};
+        writer.append(std::cbegin(samples), std::cend(samples));
+        writer.append(std::cbegin(samples), std::cbegin(samples) + 1);
+        writer.close();
+        CHECK_THROWS_AS(writer.extend(1), std::logic_error);
+    }
+    {
+        const comm::iq_reader<comm::complex_int16_t> reader{base};
+        REQUIRE(reader.size() == 4);
+        CHECK(std::equal(std::cbegin(samples), std::cend(samples), reader.begin()));
+        CHECK(reader[3] == samples[0]);
+        CHECK(reader.metadata().sample_rate == 1.0);
+    }
+    { comm::iq_writer<comm::complex_float_t> empty{base}; }
+    const comm::iq_reader<comm::complex_float_t> reader{base};
+    CHECK(reader.size() == 0);
+    CHECK(reader.begin() == reader.end());
+    remove_capture(base);
+}
+
+TEST_CASE("malformed metadata keys read as absent") {
+    const std::string base = "iq_file_malformed_test";
+    const std::vector<comm::complex_int16_t> samples{{1, -2}, {3, 4}};
+    {
+        comm::iq_writer<comm::complex_int16_t> writer{base};
+        writer.append(std::cbegin(samples), std::cend(samples));
+    }
+    {
+        // the sample rate lost its colon; the frequency's must not be taken for it
+        std::ofstream meta{comm::sigmf_meta_path(base), std::ios::trunc};
+        meta << "{\"global\": {\"core:datatype\": \"" << comm::detail::sigmf_datatype<comm::complex_int16_t>()
+             << "\", \"core:sample_rate\" 2000000, \"core:frequency\": 915000000, \"core:description\"}}\n";
+    }
+    const comm::iq_reader<comm::complex_int16_t> reader{base};
+    CHECK(reader.size() == samples.size());
+    CHECK(reader.metadata().sample_rate == 1.0);
+    CHECK(reader.metadata().frequency == 915e6);
+    CHECK(reader.metadata().description.empty());
+    remove_capture(base);
+}
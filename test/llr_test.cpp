@@ -0,0 +1,103 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "constellation.hpp"
+#include "llr.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+#include "simd_test_utilities.hpp"
+
+
+namespace {
+    // ln sum exp(-d^2 / N0) over the points of each bit value, with std::exp
+    template<typename Constellation>
+    std::vector<double> reference_llr(const comm::complex_signal_seq_t& symbols, const double noise_variance) {
+        std::vector<double> llrs{};
+        for (const auto& symbol : symbols) {
+            for (std::size_t j = 0; j < Constellation::bits_per_symbol; ++j) {
+                double sum[2] = {0, 0};
+                for (std::size_t label = 0; label < Constellation::order; ++label) {
+                    sum[(label >> j) & 1U] += std::exp(-std::norm(symbol - Constellation::points[label]) / noise_variance);
+                }
+                llrs.push_back(std::log(sum[0]) - std::log(sum[1]));
+            }
+        }
+        return llrs;
+    }
+
+    template<typename Constellation>
+    void check_llr(const double snr_db) {
+        CAPTURE(Constellation::order);
+        comm::random_stream gen{4, Constellation::order};
+        const auto bits = comm::generate_uniformly_distributed_bits(Constellation::bits_per_symbol * 500, gen);
+        const auto symbols = comm::add(comm::modulate<Constellation>(bits), comm::generate_awgn_noise(bits.size() / Constellation::bits_per_symbol, snr_db, gen));
+        const double noise_variance = comm::noise_variance_of(snr_db);
+
+        const auto reference = reference_llr<Constellation>(symbols, noise_variance);
+        const auto exact = comm::llr_demodulation<Constellation>(symbols, noise_variance, comm::llr_mode::exact);
+        const auto max_log = comm::llr_demodulation<Constellation>(symbols, noise_variance, comm::llr_mode::max_log);
+        const auto hard = comm::demodulate<Constellation>(symbols);
+        REQUIRE(exact.size() == reference.size());
+        for (std::size_t i = 0; i < reference.size(); ++i) {
+            CHECK(std::abs(exact[i] - reference[i]) <= 1e-9 * (1 + std::abs(reference[i])));
+            // max-log keeps the sign of the hard decision
+            CHECK((max_log[i] < 0) == (hard[i] == 1));
+        }
+    }
+}
+
+TEST_CASE("fast exp matches std::exp") {
+    const simd_test::isa_guard guard{};
+    std::vector<double> x{};
+    for (int32_t i = 0; i <= 20000; ++i) {
+        x.push_back(-720.0 * i / 20000);
+    }
+    for (const auto isa : simd_test::supported_isa_list()) {
+        comm::set_simd_isa(isa);
+        CAPTURE(comm::to_string(isa));
+        std::vector<double> y(x.size());
+        comm::detail::fast_exp::exp(x.data(), x.size(), y.data());
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            if (x[i] >= -708.0) {
+                CHECK(y[i] == doctest::Approx(std::exp(x[i])).epsilon(1e-15));
+            } else {
+                CHECK(y[i] == 0.0);
+            }
+        }
+    }
+}
+
+TEST_CASE("exact LLRs match the log-sum-exp definition") {
+    check_llr<comm::psk_constellation<2>>(0.0);
+    check_llr<comm::psk_constellation<8>>(8.0);
+    check_llr<comm::qam_constellation<16>>(10.0);
+    check_llr<comm::qam_constellation<64>>(16.0);
+}
+
+TEST_CASE("BPSK and QPSK LLRs are the closed forms of the generic ones") {
+    comm::random_stream gen{6, 0};
+    const auto symbols = comm::generate_awgn_noise(300, 0.0, gen);
+    const double noise_variance = comm::noise_variance_of(3.0);
+
+    const auto bpsk = comm::bpsk_llr(symbols, noise_variance);
+    const auto psk2 = comm::llr_demodulation<comm::psk_constellation<2>>(symbols, noise_variance, comm::llr_mode::exact);
+    const auto qpsk = comm::qpsk_llr(symbols, noise_variance);
+    const auto qam4 = comm::llr_demodulation<comm::qam_constellation<4>>(symbols, noise_variance, comm::llr_mode::max_log);
+    for (std::size_t i = 0; i < bpsk.size(); ++i) {
+        CHECK(std::abs(bpsk[i] - psk2[i]) <= 1e-12 * (1 + std::abs(psk2[i])));
+    }
+    for (std::size_t i = 0; i < qpsk.size(); ++i) {
+        CHECK(std::abs(qpsk[i] - qam4[i]) <= 1e-12 * (1 + std::abs(qam4[i])));
+    }
+}
+
+TEST_CASE("LLR quantization rounds and saturates") {
+    const std::vector<double> llrs{0.0, 0.24, -0.26, 1.5, -1.5, 100.0, -100.0, std::nan("")};
+    CHECK(comm::quantize_llr<int8_t>(llrs, 2.0) == std::vector<int8_t>{0, 0, -1, 3, -3, 127, -127, 0});
+    CHECK(comm::quantize_llr<int16_t>(llrs, 1000.0) == std::vector<int16_t>{0, 240, -260, 1500, -1500, 32767, -32767, 0});
+    CHECK(comm::quantize_llr<int32_t>(llrs, 1e9) == std::vector<int32_t>{0, 240'000'000, -260'000'000, 1'500'000'000, -1'500'000'000, 2147483647, -2147483647, 0});
+}
@@ -0,0 +1,125 @@
+
+#include "doctest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "normal.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+#include "simd_test_utilities.hpp"
+
+
+TEST_CASE("Box-Muller polynomials match the standard library") {
+    for (int32_t i = 1; i <= 4096; ++i) {
+        const double u = static_cast<double>(i) / 4096.0;
+        CHECK(std::abs(comm::detail::box_muller::log(u) - std::log(u)) <= 1e-15 * (1.0 + std::abs(std::log(u))));
+        double s{};
+        double c{};
+        comm::detail::box_muller::sincos(u - 1.0 / 4096.0, s, c);
+        CHECK(std::abs(s - std::sin(2 * M_PI * (u - 1.0 / 4096.0))) <= 1e-15);
+        CHECK(std::abs(c - std::cos(2 * M_PI * (u - 1.0 / 4096.0))) <= 1e-15);
+    }
+    CHECK(comm::detail::box_muller::log(0x1.0p-52) == doctest::Approx(std::log(0x1.0p-52)).epsilon(1e-15));
+}
+
+TEST_CASE("normal kernels agree with the scalar kernel") {
+    const simd_test::isa_guard guard{};
+    comm::random_stream reference_stream{11, 5};
+    std::vector<double> reference(2 * 1003 + 1);
+    comm::set_simd_isa(comm::simd_isa::scalar);
+    comm::generate_normal(reference_stream, reference.data(), reference.data() + reference.size(), 0.5);
+
+    for (const auto isa : simd_test::supported_isa_list()) {
+        comm::set_simd_isa(isa);
+        comm::random_stream stream{11, 5};
+        std::vector<double> samples(reference.size());
+        comm::generate_normal(stream, samples.data(), samples.data() + samples.size(), 0.5);
+        CHECK(stream == reference_stream);
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            CHECK(std::abs(samples[i] - reference[i]) <= 1e-13 * (1.0 + std::abs(reference[i])));
+        }
+    }
+
+    // A block range can be generated on its own
+    comm::random_stream stream{11, 5};
+    stream.seek(2 * 700);
+    std::vector<comm::complex_signal_t> tail(303);
+    comm::generate_normal(stream, tail.data(), tail.data() + tail.size(), 0.5);
+    for (std::size_t i = 0; i < tail.size(); ++i) {
+        CHECK(std::abs(tail[i].real() - reference[2 * (700 + i)]) <= 1e-13 * (1.0 + std::abs(tail[i].real())));
+        CHECK(std::abs(tail[i].imag() - reference[2 * (700 + i) + 1]) <= 1e-13 * (1.0 + std::abs(tail[i].imag())));
+    }
+}
+
+TEST_CASE("normal samples pass statistical checks") {
+    const simd_test::isa_guard guard{};
+    constexpr std::size_t num_of_samples = 1U << 20U;
+    for (const auto isa : simd_test::supported_isa_list()) {
+        comm::set_simd_isa(isa);
+        comm::random_stream stream{2022, 0};
+        std::vector<comm::complex_signal_t> samples(num_of_samples / 2);
+        comm::generate_normal(stream, samples.data(), samples.data() + samples.size());
+
+        // Moments of N(0, 1), each checked to about 5 standard errors
+        double sum = 0;
+        double sum2 = 0;
+        double sum3 = 0;
+        double sum4 = 0;
+        double cross = 0;
+        double lag = 0;
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            for (const double x : {samples[i].real(), samples[i].imag()}) {
+                sum += x;
+                sum2 += x * x;
+                sum3 += x * x * x;
+                sum4 += x * x * x * x;
+            }
+            cross += samples[i].real() * samples[i].imag();
+            if (i > 0) {
+                lag += samples[i].real() * samples[i - 1].real();
+            }
+        }
+        const double n = num_of_samples;
+        CHECK(std::abs(sum / n) < 5.0 / std::sqrt(n));
+        CHECK(std::abs(sum2 / n - 1.0) < 5.0 * std::sqrt(2.0 / n));
+        CHECK(std::abs(sum3 / n) < 5.0 * std::sqrt(15.0 / n));
+        CHECK(std::abs(sum4 / n - 3.0) < 5.0 * std::sqrt(96.0 / n));
+        CHECK(std::abs(cross / (n / 2)) < 5.0 / std::sqrt(n / 2));
+        CHECK(std::abs(lag / (n / 2)) < 5.0 / std::sqrt(n / 2));
+
+        // Chi-squared goodness of fit on 0.25 wide bins over [-4, 4] and the two tails
+        constexpr int32_t num_of_bins = 34;
+        std::vector<double> observed(num_of_bins, 0);
+        const auto bin_of = [](const double x) {
+            return std::clamp(static_cast<int32_t>(std::floor(x / 0.25)) + 17, 0, num_of_bins - 1);
+        };
+        for (const auto& sample : samples) {
+            ++observed[bin_of(sample.real())];
+            ++observed[bin_of(sample.imag())];
+        }
+        const auto cdf = [](const double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+        double chi2 = 0;
+        for (int32_t bin = 0; bin < num_of_bins; ++bin) {
+            const double lower = (bin == 0) ? -INFINITY : (bin - 17) * 0.25;
+            const double upper = (bin == num_of_bins - 1) ? INFINITY : (bin - 16) * 0.25;
+            const double expected = n * (cdf(upper) - cdf(lower));
+            chi2 += (observed[bin] - expected) * (observed[bin] - expected) / expected;
+        }
+        // 33 degrees of freedom, p = 0.001 at 63.9
+        CHECK(chi2 < 63.9);
+    }
+}
+
+TEST_CASE("AWGN noise has the requested power") {
+    comm::random_stream stream{3, 1};
+    const double snr_db = 6.0;
+    const auto noise = comm::generate_awgn_noise(1U << 18U, snr_db, stream);
+    double power = 0;
+    for (const auto& sample : noise) {
+        power += std::norm(sample);
+    }
+    power /= static_cast<double>(noise.size());
+    CHECK(power == doctest::Approx(std::pow(10, -snr_db / 10)).epsilon(0.01));
+}
@@ -0,0 +1,43 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "ofdm.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("OFDM round trip with cyclic prefix") {
+    comm::ofdm_modem ofdm{64, 16, 4};
+    CHECK(ofdm.symbol_length() == 80);
+
+    // 10 OFDM symbols, two full batches and a partial one
+    const auto bits = comm::generate_uniformly_distributed_bits(2 * 64 * 10);
+    const auto data = comm::qpsk_modulation(bits);
+    const auto samples = ofdm.modulate(data);
+    REQUIRE(samples.size() == 10 * 80);
+
+    double data_energy = 0;
+    double sample_energy = 0;
+    for (const auto& x : data) {
+        data_energy += std::norm(x);
+    }
+    for (std::size_t s = 0; s < 10; ++s) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            CHECK(samples[s * 80 + i] == samples[s * 80 + 64 + i]);
+        }
+        for (std::size_t i = 16; i < 80; ++i) {
+            sample_energy += std::norm(samples[s * 80 + i]);
+        }
+    }
+    CHECK(sample_energy == doctest::Approx(data_energy));
+
+    const auto received = ofdm.demodulate(samples);
+    REQUIRE(received.size() == data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        CHECK(std::abs(received[i] - data[i]) < 1e-12);
+    }
+    CHECK(comm::qpsk_demodulation(received) == bits);
+}
@@ -0,0 +1,79 @@
+
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include "packed_bits.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("packed bits round trip") {
+    comm::random_stream stream{1, 2};
+    for (const std::size_t size : {0, 1, 63, 64, 65, 130}) {
+        const auto bits = comm::generate_uniformly_distributed_bits(size, stream);
+        const comm::packed_bit_seq_t packed{bits};
+        CHECK(packed.size() == size);
+        CHECK(packed.num_of_words() == (size + 63) / 64);
+        CHECK(packed.unpack() == bits);
+        for (std::size_t i = 0; i < size; ++i) {
+            CHECK(packed[i] == bits[i]);
+        }
+    }
+
+    comm::packed_bit_seq_t packed(70);
+    packed.set(69, 1);
+    packed.set(3, 1);
+    packed.set(3, 0);
+    CHECK(packed.data()[1] == (uint64_t{1} << 5U));
+    CHECK(packed.data()[0] == 0);
+}
+
+TEST_CASE("packed bit generation keeps the padding zero") {
+    comm::random_stream stream{5, 0};
+    comm::packed_bit_seq_t bits(1000);
+    comm::generate_uniformly_distributed_bits(bits, stream);
+    CHECK((bits.data()[bits.num_of_words() - 1] >> (1000 % 64)) == 0);
+    // one stream word per 64 bits
+    CHECK(stream.position() == bits.num_of_words());
+    CHECK(bits.data()[0] == comm::random_stream::block(5, 0, 0)[0]);
+
+    std::mt19937 generator(7);
+    comm::generate_uniformly_distributed_bits(bits, generator);
+    const auto ones = comm::count_error(bits, comm::packed_bit_seq_t(bits.size()));
+    CHECK(ones > 400);
+    CHECK(ones < 600);
+}
+
+TEST_CASE("packed count_error matches the byte version") {
+    comm::random_stream stream{9, 9};
+    const auto first = comm::generate_uniformly_distributed_bits(777, stream);
+    auto second = first;
+    for (std::size_t i = 0; i < second.size(); i += 7) {
+        second[i] ^= 1U;
+    }
+    CHECK(comm::count_error(comm::packed_bit_seq_t(first), comm::packed_bit_seq_t(second)) == comm::count_error(first, second));
+    CHECK(comm::count_error(comm::packed_bit_seq_t(first), comm::packed_bit_seq_t(first)) == 0);
+}
+
+TEST_CASE("packed modulators match the byte versions") {
+    constexpr double pi = 3.14159265359;
+    comm::random_stream stream{4, 4};
+    const auto bits = comm::generate_uniformly_distributed_bits(258, stream);
+    const comm::packed_bit_seq_t packed{bits};
+
+    const auto bpsk_symbols = comm::bpsk_modulation(packed, pi / 3);
+    CHECK(bpsk_symbols == comm::bpsk_modulation(bits, pi / 3));
+    const auto noisy_bpsk = comm::add(bpsk_symbols, comm::generate_awgn_noise(bpsk_symbols.size(), 0.0, stream));
+    comm::packed_bit_seq_t bpsk_bits{};
+    comm::bpsk_demodulation(noisy_bpsk, bpsk_bits, pi / 3);
+    CHECK(bpsk_bits.unpack() == comm::bpsk_demodulation(noisy_bpsk, pi / 3));
+
+    const auto qpsk_symbols = comm::qpsk_modulation(packed);
+    CHECK(qpsk_symbols == comm::qpsk_modulation(bits));
+    const auto noisy_qpsk = comm::add(qpsk_symbols, comm::generate_awgn_noise(qpsk_symbols.size(), 0.0, stream));
+    comm::packed_bit_seq_t qpsk_bits{};
+    comm::qpsk_demodulation(noisy_qpsk, qpsk_bits);
+    CHECK(qpsk_bits.unpack() == comm::qpsk_demodulation(noisy_qpsk));
+}
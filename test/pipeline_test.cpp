@@ -0,0 +1,75 @@
+
+#include "doctest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "psk.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("pipeline matches the unfused chain in a single block") {
+    constexpr std::size_t num_of_bits = 1000;
+    constexpr double snr_db = 2.0;
+
+    comm::random_stream stream{77, 1};
+    comm::packed_bit_seq_t bits(num_of_bits);
+    comm::generate_uniformly_distributed_bits(bits, stream);
+    const auto symbols = comm::qpsk_modulation(bits);
+    const auto received = comm::add(symbols, comm::generate_awgn_noise(symbols.size(), snr_db, stream));
+    comm::packed_bit_seq_t demodulated_bits{};
+    comm::qpsk_demodulation(received, demodulated_bits);
+    const auto expected = comm::count_error(bits, demodulated_bits);
+    REQUIRE(expected > 0);
+
+    comm::random_stream pipeline_stream{77, 1};
+    comm::ber_pipeline<comm::qpsk_modem> pipeline{comm::qpsk_modem{}, 1024};
+    CHECK(pipeline.run(num_of_bits, snr_db, pipeline_stream) == expected);
+    CHECK(pipeline_stream == stream);
+}
+
+TEST_CASE("pipeline BER follows the theory over many blocks") {
+    constexpr std::size_t num_of_bits = 1'000'002;
+    constexpr double snr_db = 4.0;
+    const double theory = 0.5 * std::erfc(std::sqrt(std::pow(10, snr_db / 10)));
+
+    comm::ber_pipeline<comm::bpsk_modem> bpsk{comm::bpsk_modem{0.3}, 300};
+    CHECK(bpsk.block_size() == 256);
+    comm::random_stream stream{5, 0};
+    const double ber = static_cast<double>(bpsk.run(num_of_bits, snr_db, stream)) / num_of_bits;
+    // about 5 standard deviations
+    CHECK(std::abs(ber - theory) < 5 * std::sqrt(theory / num_of_bits));
+
+    // No errors without noise, including the partial last block
+    comm::ber_pipeline<comm::qpsk_modem> qpsk{};
+    CHECK(qpsk.run(5000, 200.0, stream) == 0);
+}
+
+TEST_CASE("pipeline sweep evaluates every SNR on the same bits and noise") {
+    constexpr std::size_t num_of_bits = 200'000;
+    const std::vector<double> snr_list{0.0, 2.0, 4.0, 6.0};
+
+    comm::ber_pipeline<comm::qpsk_modem> pipeline{comm::qpsk_modem{}, 1024};
+    comm::random_stream sweep_stream{12, 3};
+    const auto errors = pipeline.run(num_of_bits, snr_list, sweep_stream);
+    REQUIRE(errors.size() == snr_list.size());
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        CAPTURE(snr_list[point]);
+        // each point sees the noise of its own run, so only a rounding at a decision boundary could tell them apart
+        comm::random_stream stream{12, 3};
+        CHECK(pipeline.run(num_of_bits, snr_list[point], stream) == errors[point]);
+        CHECK(stream == sweep_stream);
+        if (point > 0) {
+            // scaling the same noise down never adds an error
+            CHECK(errors[point] < errors[point - 1]);
+        }
+    }
+
+    comm::ber_pipeline<comm::qpsk_modem, comm::complex_float_t> float_pipeline{comm::qpsk_modem{}, 1024};
+    comm::random_stream float_stream{12, 3};
+    const auto float_errors = float_pipeline.run(num_of_bits, snr_list, float_stream);
+    for (std::size_t point = 0; point < snr_list.size(); ++point) {
+        CHECK(std::abs(static_cast<double>(float_errors[point]) - static_cast<double>(errors[point])) <= 1e-3 * errors[point] + 2);
+    }
+}
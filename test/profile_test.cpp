@@ -0,0 +1,105 @@
+#include "doctest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Only this test is built with the timers; it includes no header that uses them
+#define COMM_PROFILE
+#include "profile.hpp"
+
+
+namespace {
+    double busy_work(const std::size_t n) {
+        volatile double sum = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum = sum + static_cast<double>(i);
+        }
+        return sum;
+    }
+
+    const comm::profile::stage_counters& counters_of(const comm::profile::point_table& table, const double point, const comm::profile::stage s) {
+        return table.at(point)[static_cast<std::size_t>(s)];
+    }
+}
+
+TEST_CASE("stage timers add up per thread and SNR point") {
+    static_assert(comm::profile::enabled);
+    comm::profile::reset();
+
+    const auto work = [](const double point) {
+        COMM_PROFILE_POINT(point);
+        for (int i = 0; i < 3; ++i) {
+            {
+                COMM_PROFILE_STAGE(noise, 100);
+                busy_work(10000);
+            }
+            COMM_PROFILE_STAGE(demodulation, 50);
+            busy_work(1000);
+        }
+    };
+    work(1.0);
+    // the counters of threads that have exited are kept
+    std::thread other{work, 2.0};
+    other.join();
+    std::thread again{work, 1.0};
+    again.join();
+    std::thread unnamed{[] {
+        COMM_PROFILE_STAGE(bits, 64);
+    }};
+    unnamed.join();
+
+    const auto table = comm::profile::report();
+    REQUIRE(table.size() == 3);
+    const auto& noise = counters_of(table, 1.0, comm::profile::stage::noise);
+    CHECK(noise.calls == 6);
+    CHECK(noise.items == 600);
+    CHECK(noise.nanoseconds > 0);
+    CHECK(counters_of(table, 1.0, comm::profile::stage::demodulation).items == 300);
+    CHECK(counters_of(table, 2.0, comm::profile::stage::noise).calls == 3);
+    CHECK(counters_of(table, 2.0, comm::profile::stage::modulation).calls == 0);
+    // work outside any point is the shared work of a sweep
+    CHECK(counters_of(table, comm::profile::shared_point, comm::profile::stage::bits).items == 64);
+
+    std::ostringstream os{};
+    comm::profile::print(os, table);
+    CHECK(os.str().find("demodulation") != std::string::npos);
+    CHECK(os.str().find("shared") != std::string::npos);
+
+    const std::string path = "profile_test.json";
+    REQUIRE(comm::profile::write_json(path, table));
+    std::ifstream file{path};
+    const std::string json{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    CHECK(json.find("\"snr_db\": null") != std::string::npos);
+    CHECK(json.find("\"snr_db\": 2,") != std::string::npos);
+    CHECK(json.find("{\"name\": \"noise\", \"calls\": 6,") != std::string::npos);
+    std::remove(path.c_str());
+
+    comm::profile::reset();
+    CHECK(comm::profile::report().empty());
+}
+
+TEST_CASE("hardware counters are counted where perf events can be opened") {
+    comm::profile::reset();
+    comm::profile::enable_hardware_counters();
+    std::thread worker{[] {
+        COMM_PROFILE_POINT(0.0);
+        COMM_PROFILE_STAGE(channel, 1000);
+        busy_work(100000);
+    }};
+    worker.join();
+    comm::profile::enable_hardware_counters(false);
+
+    const auto table = comm::profile::report();
+    const auto& channel = counters_of(table, 0.0, comm::profile::stage::channel);
+    CHECK(channel.calls == 1);
+    if (comm::profile::hardware_counters_used()) {
+        CHECK(channel.cycles > 0);
+    } else {
+        CHECK(channel.cycles == 0);
+    }
+    comm::profile::reset();
+}
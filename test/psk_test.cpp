@@ -3,10 +3,15 @@
 #include <vector>
 #include <iostream>
 #include  <algorithm>
+#include <cmath>
+#include <list>
 
 #include "psk.hpp"
+#include "simd.hpp"
 #include "utilities.hpp"
 
+#include "simd_test_utilities.hpp"
+
 
 TEST_CASE("BPSK") {
     constexpr double pi = 3.14159265359;
@@ -47,3 +52,98 @@ TEST_CASE("QPSK") {
 
     CHECK(demodulated_bits == bits);
 }
+
+namespace {
+    // Noisy symbols with exact zeros, negative zeros and NaNs on the decision boundaries
+    comm::complex_signal_seq_t boundary_symbols(const std::size_t n) {
+        comm::random_stream gen{3, 1};
+        comm::complex_signal_seq_t symbols(n);
+        comm::generate_awgn_noise(std::begin(symbols), std::end(symbols), 0.0, gen);
+        for (std::size_t i = 0; i < n; i += 7) {
+            symbols[i] = {0.0, -0.0};
+        }
+        for (std::size_t i = 3; i < n; i += 11) {
+            symbols[i] = {-0.0, std::nan("")};
+        }
+        for (std::size_t i = 5; i < n; i += 13) {
+            symbols[i] = {std::nan(""), 0.0};
+        }
+        return symbols;
+    }
+}
+
+TEST_CASE("PSK kernels are bit-exact with the scalar kernels") {
+    const simd_test::isa_guard guard{};
+    const auto isa_list = simd_test::supported_isa_list();
+    for (const std::size_t n : {0, 1, 3, 7, 8, 63, 64, 65, 130, 1001}) {
+        comm::random_stream gen{5, n};
+        const auto bits = comm::generate_uniformly_distributed_bits(2 * n, gen);
+        const comm::packed_bit_seq_t packed{bits};
+        const auto symbols = boundary_symbols(n);
+
+        for (const double offset : {0.0, 0.3, -2.0}) {
+            const auto c = std::cos(offset);
+            const auto s = std::sin(offset);
+            comm::complex_signal_seq_t bpsk_reference(n);
+            comm::detail::bpsk_modulation_scalar(bits.data(), n, bpsk_reference.data(), c, s);
+            comm::bit_seq_t bpsk_bits_reference(n);
+            comm::detail::bpsk_demodulation_scalar(symbols.data(), n, bpsk_bits_reference.data(), c, s);
+
+            for (const auto isa : isa_list) {
+                CAPTURE(comm::to_string(isa));
+                CAPTURE(n);
+                comm::set_simd_isa(isa);
+
+                comm::complex_signal_seq_t modulated(n);
+                comm::bpsk_modulation(std::cbegin(bits), std::cbegin(bits) + static_cast<std::ptrdiff_t>(n), std::begin(modulated), offset);
+                CHECK(simd_test::same_bits(modulated, bpsk_reference));
+                comm::bpsk_modulation(packed.data(), n, modulated.data(), offset);
+                CHECK(simd_test::same_bits(modulated, bpsk_reference));
+
+                comm::bit_seq_t demodulated(n);
+                comm::bpsk_demodulation(symbols.data(), symbols.data() + n, demodulated.data(), offset);
+                CHECK(demodulated == bpsk_bits_reference);
+                comm::packed_bit_seq_t packed_demodulated{};
+                comm::bpsk_demodulation(symbols, packed_demodulated, offset);
+                CHECK(packed_demodulated == comm::packed_bit_seq_t{bpsk_bits_reference});
+            }
+        }
+
+        comm::complex_signal_seq_t qpsk_reference(n);
+        comm::detail::qpsk_modulation_scalar(bits.data(), 2 * n, qpsk_reference.data());
+        comm::bit_seq_t qpsk_bits_reference(2 * n);
+        comm::detail::qpsk_demodulation_scalar(symbols.data(), n, qpsk_bits_reference.data());
+
+        for (const auto isa : isa_list) {
+            CAPTURE(comm::to_string(isa));
+            CAPTURE(n);
+            comm::set_simd_isa(isa);
+
+            comm::complex_signal_seq_t modulated(n);
+            comm::qpsk_modulation(std::cbegin(bits), std::cend(bits), std::begin(modulated));
+            CHECK(simd_test::same_bits(modulated, qpsk_reference));
+            comm::qpsk_modulation(packed.data(), 2 * n, modulated.data());
+            CHECK(simd_test::same_bits(modulated, qpsk_reference));
+
+            comm::bit_seq_t demodulated(2 * n);
+            comm::qpsk_demodulation(std::cbegin(symbols), std::cend(symbols), std::begin(demodulated), std::end(demodulated));
+            CHECK(demodulated == qpsk_bits_reference);
+            comm::packed_bit_seq_t packed_demodulated{};
+            comm::qpsk_demodulation(symbols, packed_demodulated);
+            CHECK(packed_demodulated == comm::packed_bit_seq_t{qpsk_bits_reference});
+        }
+    }
+}
+
+TEST_CASE("PSK iterator versions match the contiguous versions") {
+    const auto bits = comm::generate_uniformly_distributed_bits(100);
+    const std::list<comm::bit_t> bit_list(std::cbegin(bits), std::cend(bits));
+    std::list<comm::complex_signal_t> symbol_list(bits.size());
+    comm::bpsk_modulation(std::cbegin(bit_list), std::cend(bit_list), std::begin(symbol_list), 0.5);
+    const auto symbols = comm::bpsk_modulation(bits, 0.5);
+    CHECK(comm::complex_signal_seq_t(std::cbegin(symbol_list), std::cend(symbol_list)) == symbols);
+
+    std::list<comm::bit_t> demodulated_list(bits.size() * 2);
+    comm::qpsk_demodulation(std::cbegin(symbols), std::cend(symbols), std::begin(demodulated_list), std::end(demodulated_list));
+    CHECK(comm::bit_seq_t(std::cbegin(demodulated_list), std::cend(demodulated_list)) == comm::qpsk_demodulation(symbols));
+}
@@ -0,0 +1,181 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "fir.hpp"
+#include "psk.hpp"
+#include "pulse_shaping.hpp"
+#include "simd.hpp"
+#include "utilities.hpp"
+
+
+namespace {
+    std::vector<comm::complex_signal_t> convolve(const std::vector<double>& taps, const comm::complex_signal_seq_t& input) {
+        std::vector<comm::complex_signal_t> output(input.size());
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            for (std::size_t k = 0; k < taps.size() && k <= i; ++k) {
+                output[i] += taps[k] * input[i - k];
+            }
+        }
+        return output;
+    }
+
+    comm::complex_signal_seq_t random_symbols(const std::size_t n, comm::random_stream& gen) {
+        return comm::qpsk_modulation(comm::generate_uniformly_distributed_bits(2 * n, gen));
+    }
+}
+
+TEST_CASE("polyphase interpolation and decimation match the upsampled convolution on every instruction set") {
+    comm::random_stream gen{61, 0};
+    const auto input = comm::generate_awgn_noise(3001, 0.0, gen);
+    const auto supported = comm::active_simd_isa();
+    for (const auto isa : {comm::simd_isa::scalar, comm::simd_isa::avx2, comm::simd_isa::avx512}) {
+        comm::set_simd_isa(isa);
+        for (const std::size_t num_of_taps : {1, 7, 33, 64}) {
+            for (const std::size_t factor : {1, 3, 4}) {
+                CAPTURE(isa);
+                CAPTURE(num_of_taps);
+                CAPTURE(factor);
+                std::vector<double> taps(num_of_taps);
+                for (std::size_t k = 0; k < num_of_taps; ++k) {
+                    taps[k] = std::cos(0.3 * static_cast<double>(k)) / static_cast<double>(k + 1);
+                }
+
+                comm::complex_signal_seq_t upsampled(input.size() * factor);
+                for (std::size_t i = 0; i < input.size(); ++i) {
+                    upsampled[i * factor] = input[i];
+                }
+                const auto expected_up = convolve(taps, upsampled);
+                comm::polyphase_interpolator interpolator{taps, factor};
+                std::vector<comm::complex_signal_t> up(upsampled.size());
+                for (std::size_t done = 0, chunk = 1; done < input.size(); done += chunk, chunk = chunk * 3 % 997 + 1) {
+                    chunk = std::min(chunk, input.size() - done);
+                    interpolator.process(input.data() + done, chunk, up.data() + done * factor);
+                }
+                double error = 0.0;
+                for (std::size_t i = 0; i < up.size(); ++i) {
+                    error = std::max(error, std::abs(up[i] - expected_up[i]));
+                }
+                CHECK(error < 1e-12);
+
+                const auto expected_down = convolve(taps, input);
+                comm::polyphase_decimator decimator{taps, factor, 5};
+                std::vector<comm::complex_signal_t> down(input.size() / factor + 2);
+                std::size_t num_of_outputs = 0;
+                for (std::size_t done = 0, chunk = 1; done < input.size(); done += chunk, chunk = chunk * 5 % 601 + 1) {
+                    chunk = std::min(chunk, input.size() - done);
+                    num_of_outputs += decimator.process(input.data() + done, chunk, down.data() + num_of_outputs);
+                }
+                REQUIRE(num_of_outputs == (input.size() - 5 + factor - 1) / factor);
+                error = 0.0;
+                for (std::size_t j = 0; j < num_of_outputs; ++j) {
+                    error = std::max(error, std::abs(down[j] - expected_down[5 + j * factor]));
+                }
+                CHECK(error < 1e-12);
+            }
+        }
+    }
+    comm::set_simd_isa(supported);
+}
+
+TEST_CASE("root-raised-cosine taps have unit energy and a Nyquist matched response") {
+    for (const double rolloff : {0.0, 0.25, 0.5, 1.0}) {
+        CAPTURE(rolloff);
+        constexpr std::size_t samples_per_symbol = 8;
+        constexpr std::size_t span = 32;
+        const auto taps = comm::rrc_taps(rolloff, samples_per_symbol, span);
+        REQUIRE(taps.size() == span * samples_per_symbol + 1);
+        double energy = 0.0;
+        for (std::size_t k = 0; k < taps.size(); ++k) {
+            CHECK(taps[k] == doctest::Approx(taps[taps.size() - 1 - k]));
+            energy += taps[k] * taps[k];
+        }
+        CHECK(energy == doctest::Approx(1.0));
+
+        // the autocorrelation at whole symbol lags
+        for (std::size_t lag = samples_per_symbol; lag < 4 * samples_per_symbol; lag += samples_per_symbol) {
+            double correlation = 0.0;
+            for (std::size_t k = 0; k + lag < taps.size(); ++k) {
+                correlation += taps[k] * taps[k + lag];
+            }
+            CHECK(std::abs(correlation) < (rolloff == 0.0 ? 2e-2 : 2e-3));
+        }
+    }
+}
+
+TEST_CASE("pulse shaping and matched filtering give back the symbols, by polyphase and by FFT") {
+    constexpr double rolloff = 0.35;
+    constexpr std::size_t samples_per_symbol = 4;
+    constexpr std::size_t span = 12;
+    constexpr std::size_t n = 5000;
+    comm::random_stream gen{62, 0};
+    // zeros after the signal to end the last pulses
+    auto symbols = random_symbols(n, gen);
+    symbols.resize(n + span / 2 + 1);
+
+    std::vector<std::vector<comm::complex_signal_t>> results{};
+    for (const std::size_t fft_threshold : {1000, 0}) {
+        comm::pulse_shaper shaper{rolloff, samples_per_symbol, span, fft_threshold};
+        comm::matched_filter filter{rolloff, samples_per_symbol, span, fft_threshold};
+        CHECK(shaper.uses_fft() == (fft_threshold == 0));
+        CHECK(filter.uses_fft() == (fft_threshold == 0));
+        std::vector<comm::complex_signal_t> samples(symbols.size() * samples_per_symbol);
+        std::vector<comm::complex_signal_t> received(symbols.size() + 1);
+        std::size_t num_of_received = 0;
+        for (std::size_t done = 0, chunk = 1; done < symbols.size(); done += chunk, chunk = chunk * 7 % 1013 + 1) {
+            chunk = std::min(chunk, symbols.size() - done);
+            comm::complex_signal_t* shaped = samples.data() + done * samples_per_symbol;
+            shaper.process(symbols.data() + done, chunk, shaped);
+            num_of_received += filter.process(shaped, chunk * samples_per_symbol, received.data() + num_of_received);
+        }
+        CHECK(num_of_received == symbols.size() - span);
+        num_of_received += filter.flush(received.data() + num_of_received);
+        REQUIRE(num_of_received == symbols.size());
+
+        double error = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            error = std::max(error, std::abs(received[i] - symbols[i]));
+        }
+        // intersymbol interference of the truncated pulse
+        CHECK(error < 2e-2);
+        received.resize(n);
+        results.push_back(received);
+    }
+    double difference = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        difference = std::max(difference, std::abs(results[0][i] - results[1][i]));
+    }
+    CHECK(difference < 1e-9);
+}
+
+TEST_CASE("noise on the shaped samples at Es/N0 gives the BER of Es/N0") {
+    constexpr std::size_t samples_per_symbol = 8;
+    constexpr std::size_t n = 200000;
+    constexpr double snr_db = 6.0;
+    comm::random_stream gen{63, 0};
+    const auto bits = comm::generate_uniformly_distributed_bits(n, gen);
+    const auto symbols = comm::bpsk_modulation(bits);
+    comm::pulse_shaper shaper{0.25, samples_per_symbol};
+    comm::matched_filter filter{0.25, samples_per_symbol};
+
+    comm::complex_signal_seq_t samples(n * samples_per_symbol);
+    shaper.process(symbols.data(), n, samples.data());
+    const auto noise = comm::generate_awgn_noise(samples.size(), snr_db, gen);
+    comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(samples));
+    comm::complex_signal_seq_t received(n + 1);
+    std::size_t num_of_received = filter.process(samples.data(), samples.size(), received.data());
+    num_of_received += filter.flush(received.data() + num_of_received);
+    REQUIRE(num_of_received == n);
+    received.resize(n);
+
+    const auto demodulated = comm::bpsk_demodulation(received);
+    std::size_t errors = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        errors += bits[i] != demodulated[i];
+    }
+    const double theory = 0.5 * std::erfc(std::sqrt(std::pow(10, snr_db / 10)));
+    CHECK(static_cast<double>(errors) / n == doctest::Approx(theory).epsilon(0.1));
+}
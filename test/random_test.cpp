@@ -0,0 +1,75 @@
+
+#include "doctest.h"
+
+#include <array>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "random.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("Philox4x32-10 known answers") {
+    // Known-answer vectors of the Random123 distribution
+    using counter = comm::philox4x32::counter_type;
+    using key = comm::philox4x32::key_type;
+    CHECK(comm::philox4x32::block(counter{0, 0, 0, 0}, key{0, 0}) == counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(comm::philox4x32::block(counter{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, key{0xffffffff, 0xffffffff}) ==
+          counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(comm::philox4x32::block(counter{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, key{0xa4093822, 0x299f31d0}) ==
+          counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("random stream blocks are addressable") {
+    comm::random_stream stream{7, 3};
+    std::vector<uint64_t> sequential(101);
+    for (auto& word : sequential) {
+        word = stream();
+    }
+    CHECK(stream.position() == sequential.size());
+
+    // Any block can be computed directly
+    for (uint64_t word = 0; word < sequential.size(); ++word) {
+        CHECK(comm::random_stream::block(7, 3, word / 2)[word % 2] == sequential[word]);
+    }
+
+    // seek, discard and generate land on the same words
+    comm::random_stream other{7, 3};
+    other.seek(41);
+    CHECK(other() == sequential[41]);
+    other.discard(10);
+    CHECK(other() == sequential[52]);
+
+    std::vector<uint64_t> filled(48);
+    other.generate(std::begin(filled), std::end(filled));
+    CHECK(std::equal(std::cbegin(filled), std::cend(filled), std::next(std::cbegin(sequential), 53)));
+    CHECK(other() == comm::random_stream::block(7, 3, 101 / 2)[101 % 2]);
+
+    // Other streams and seeds differ
+    CHECK(comm::random_stream(7, 4)() != sequential[0]);
+    CHECK(comm::random_stream(8, 3)() != sequential[0]);
+}
+
+TEST_CASE("global generator is per thread and reseedable") {
+    comm::set_seed(1234);
+    const auto first = comm::generate_uniformly_distributed_bits(256);
+    const auto noise = comm::generate_awgn_noise(16, 3.0);
+    comm::set_seed(1234);
+    CHECK(comm::generate_uniformly_distributed_bits(256) == first);
+    CHECK(comm::generate_awgn_noise(16, 3.0) == noise);
+
+    std::array<uint64_t, 4> stream_ids{};
+    std::vector<std::thread> threads{};
+    for (std::size_t i = 0; i < stream_ids.size(); ++i) {
+        threads.emplace_back([&stream_ids, i]() {
+            stream_ids[i] = comm::detail::get_generator().stream_id();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::set<uint64_t> unique(std::cbegin(stream_ids), std::cend(stream_ids));
+    CHECK(unique.size() == stream_ids.size());
+    CHECK(unique.count(comm::detail::get_generator().stream_id()) == 0);
+}
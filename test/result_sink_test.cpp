@@ -0,0 +1,110 @@
+#include "doctest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gplot.h"
+#include "result_sink.hpp"
+
+
+namespace {
+    std::string read_file(const std::string& path) {
+        std::ifstream file{path, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+}
+
+TEST_CASE("series sinks stream mixed-type points as float64, CSV and NPY") {
+    // more than the pending chunks of the background writer can hold
+    constexpr std::size_t n = 100000;
+    for (const auto format : {comm::sink_format::binary, comm::sink_format::csv, comm::sink_format::npy}) {
+        const std::string path = (std::filesystem::temp_directory_path() / (std::string("result_sink_test") + comm::file_extension(format))).string();
+        {
+            comm::series_sink sink{path, format};
+            REQUIRE(sink.good());
+            for (std::size_t i = 0; i < n; ++i) {
+                sink.append(static_cast<int>(i) - 7, 0.1 * static_cast<double>(i));
+            }
+            CHECK(sink.size() == n);
+            CHECK(sink.close());
+        }
+        const auto content = read_file(path);
+        std::remove(path.c_str());
+
+        if (format == comm::sink_format::csv) {
+            CHECK(content.compare(0, 27, "-7,0\n-6,0.10000000000000001") == 0);
+            CHECK(std::count(std::cbegin(content), std::cend(content), '\n') == static_cast<long>(n));
+            continue;
+        }
+        std::size_t header_size = 0;
+        if (format == comm::sink_format::npy) {
+            header_size = 128;
+            REQUIRE(content.size() > header_size);
+            CHECK(content.compare(0, 6, "\x93NUMPY") == 0);
+            CHECK(content[header_size - 1] == '\n');
+            CHECK(content.find("'shape': (100000, 2)") != std::string::npos);
+        }
+        REQUIRE(content.size() == header_size + n * 2 * sizeof(double));
+        std::vector<double> values(2 * n);
+        std::memcpy(values.data(), content.data() + header_size, values.size() * sizeof(double));
+        for (std::size_t i = 0; i < n; i += 997) {
+            CHECK(values[2 * i] == static_cast<double>(static_cast<int>(i) - 7));
+            CHECK(values[2 * i + 1] == 0.1 * static_cast<double>(i));
+        }
+    }
+}
+
+TEST_CASE("without gnuplot the plot goes to CSV files") {
+    const auto directory = std::filesystem::temp_directory_path() / "comm-plot-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    setenv("COMM_HEADLESS", "1", 1);
+    setenv("COMM_PLOT_DIR", directory.c_str(), 1);
+    {
+        gplot gp{gplot::type::semilogy};
+        CHECK(gp.headless());
+        const std::vector<std::pair<int, double>> data{{1, 0.5}, {2, 0.25}};
+        CHECK(gp.add_2D_data("BER sim/theory", data));
+        auto& streamed = gp.add_series("streamed");
+        streamed.append(0.5, 3);
+        CHECK(gp.plot());
+        CHECK_FALSE(gp.plot());
+    }
+    unsetenv("COMM_HEADLESS");
+    unsetenv("COMM_PLOT_DIR");
+
+    CHECK(read_file((directory / "BER_sim_theory.csv").string()) == "1,0.5\n2,0.25\n");
+    CHECK(read_file((directory / "streamed.csv").string()) == "0.5,3\n");
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("series titles are escaped in the gnuplot command") {
+    // a stand-in gnuplot that records the commands it is sent
+    const auto directory = std::filesystem::temp_directory_path() / "comm-gnuplot-test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto script = directory / "gnuplot";
+    std::ofstream{script} << "#!/bin/sh\ncat > '" << (directory / "commands").string() << "'\n";
+    std::filesystem::permissions(script, std::filesystem::perms::owner_all);
+    const std::string path = std::getenv("PATH");
+    setenv("PATH", (directory.string() + ":" + path).c_str(), 1);
+    {
+        gplot gp{};
+        REQUIRE_FALSE(gp.headless());
+        gp.add_series("say \"hi\" \\ bye").append(1, 2);
+        CHECK(gp.plot());
+    }
+    setenv("PATH", path.c_str(), 1);
+
+    const auto commands = read_file((directory / "commands").string());
+    CHECK(commands.find("title \"say \\\"hi\\\" \\\\ bye\"\n") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,86 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "psk.hpp"
+#include "sample.hpp"
+#include "utilities.hpp"
+
+
+TEST_CASE("fixed-point samples round and saturate") {
+    CHECK(comm::to_sample<comm::complex_int16_t>({0.5, -0.25}) == comm::complex_int16_t{2048, -1024});
+    CHECK(comm::to_sample<comm::complex_int16_t>({1.0 / 8192, -1.0 / 8192}) == comm::complex_int16_t{1, -1});
+    CHECK(comm::to_sample<comm::complex_int16_t>({100.0, -100.0}) == comm::complex_int16_t{32767, -32768});
+    CHECK(comm::to_sample<comm::complex_int16_t>({std::nan(""), 0.0}) == comm::complex_int16_t{0, 0});
+    CHECK(comm::to_complex(comm::complex_int16_t{-4096, 2048}) == comm::complex_signal_t(-1.0, 0.5));
+
+    comm::complex_int16_t sum{30000, -30000};
+    sum += comm::complex_int16_t{10000, -10000};
+    CHECK(sum == comm::complex_int16_t{32767, -32768});
+    CHECK(comm::complex_int16_t{1, 2} + comm::complex_int16_t{3, -4} == comm::complex_int16_t{4, -2});
+
+    CHECK(comm::parse_sample_type("float") == comm::sample_type::float32);
+    CHECK(comm::parse_sample_type(comm::to_string(comm::sample_type::int16)) == comm::sample_type::int16);
+    CHECK_THROWS_AS(comm::parse_sample_type("int8"), std::invalid_argument);
+}
+
+TEST_CASE("modulators and noise agree across sample types") {
+    constexpr std::size_t n = 1000;
+    comm::random_stream gen{6, 0};
+    comm::packed_bit_seq_t bits(2 * n);
+    comm::generate_uniformly_distributed_bits(bits, gen);
+    const auto qpsk = comm::qpsk_modulation(bits);
+
+    std::vector<comm::complex_float_t> qpsk_float(n);
+    std::vector<comm::complex_int16_t> qpsk_int16(n);
+    comm::qpsk_modulation(bits.data(), bits.size(), qpsk_float.data());
+    comm::qpsk_modulation(bits.data(), bits.size(), qpsk_int16.data());
+    for (std::size_t i = 0; i < n; ++i) {
+        CHECK(std::abs(comm::to_complex(qpsk_float[i]) - qpsk[i]) < 1e-7);
+        CHECK(std::abs(comm::to_complex(qpsk_int16[i]) - qpsk[i]) < 1.0 / 4096);
+    }
+    comm::packed_bit_seq_t demodulated(bits.size());
+    comm::qpsk_demodulation(qpsk_int16.data(), n, demodulated.data());
+    CHECK(demodulated == bits);
+
+    comm::random_stream double_gen{7, 0};
+    comm::random_stream float_gen{7, 0};
+    const auto noise = comm::generate_awgn_noise(n, 5.0, double_gen);
+    std::vector<comm::complex_float_t> float_noise(n);
+    comm::generate_awgn_noise(std::begin(float_noise), std::end(float_noise), 5.0, float_gen);
+    for (std::size_t i = 0; i < n; ++i) {
+        CHECK(comm::complex_signal_t(float_noise[i]) == comm::complex_signal_t(comm::complex_float_t(noise[i])));
+    }
+}
+
+TEST_CASE("BER agrees across sample types") {
+    constexpr std::size_t num_of_bits = 1'000'000;
+    for (const double snr_db : {0.0, 4.0, 7.0}) {
+        CAPTURE(snr_db);
+        const auto run = [snr_db](auto tag) {
+            using sample_t = typename decltype(tag)::type;
+            comm::ber_pipeline<comm::qpsk_modem, sample_t> pipeline{};
+            comm::random_stream stream{31, 0};
+            return static_cast<double>(pipeline.run(num_of_bits, snr_db, stream));
+        };
+        // the same noise for every type: the errors only differ where rounding moves a sample across a decision boundary
+        const double errors = comm::visit_sample_type(comm::sample_type::float64, run);
+        CHECK(std::abs(comm::visit_sample_type(comm::sample_type::float32, run) - errors) <= 1e-3 * errors + 2);
+        CHECK(std::abs(comm::visit_sample_type(comm::sample_type::int16, run) - errors) <= 1e-2 * errors + 5);
+
+        const double theory = 0.5 * std::erfc(std::sqrt(std::pow(10, snr_db / 10) / 2));
+        CHECK(std::abs(errors / num_of_bits - theory) < 5 * std::sqrt(theory / num_of_bits));
+    }
+
+    comm::ber_pipeline<comm::bpsk_modem, comm::complex_int16_t> bpsk{comm::bpsk_modem{0.3}};
+    comm::ber_pipeline<comm::bpsk_modem> bpsk_double{comm::bpsk_modem{0.3}};
+    comm::random_stream int16_stream{32, 0};
+    comm::random_stream double_stream{32, 0};
+    const auto errors = static_cast<double>(bpsk_double.run(num_of_bits, 3.0, double_stream));
+    CHECK(std::abs(static_cast<double>(bpsk.run(num_of_bits, 3.0, int16_stream)) - errors) <= 1e-2 * errors + 5);
+}
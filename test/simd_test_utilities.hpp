@@ -0,0 +1,53 @@
+#ifndef TEST_SIMD_TEST_UTILITIES_HPP
+#define TEST_SIMD_TEST_UTILITIES_HPP
+
+#include <cstring>
+#include <vector>
+
+#include "definitions.h"
+#include "simd.hpp"
+#include "split_signal.hpp"
+
+// Helpers of the tests that run the kernels of every instruction set against each other
+namespace simd_test {
+    // Restores, when it goes out of scope, the instruction set that was active when it was made
+    class isa_guard {
+    public:
+        isa_guard() : _previous(comm::active_simd_isa()) {
+        }
+
+        isa_guard(const isa_guard&) = delete;
+        isa_guard& operator=(const isa_guard&) = delete;
+
+        ~isa_guard() {
+            comm::set_simd_isa(_previous);
+        }
+
+    private:
+        comm::simd_isa _previous;
+    };
+
+    // scalar and the vector instruction sets this CPU runs
+    inline std::vector<comm::simd_isa> supported_isa_list() {
+        const isa_guard guard{};
+        std::vector<comm::simd_isa> list{comm::simd_isa::scalar};
+        for (const auto isa : {comm::simd_isa::avx2, comm::simd_isa::avx512}) {
+            if (comm::set_simd_isa(isa) == isa) {
+                list.push_back(isa);
+            }
+        }
+        return list;
+    }
+
+    // memcmp is undefined on the null buffers of empty sequences
+    inline bool same_bits(const comm::complex_signal_seq_t& a, const comm::complex_signal_seq_t& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(comm::complex_signal_t)) == 0);
+    }
+
+    inline bool same_bits(const comm::split_signal_t& a, const comm::split_signal_t& b) {
+        return a.size() == b.size() && (a.empty() || (std::memcmp(a.real(), b.real(), a.size() * sizeof(double)) == 0 &&
+                                                     std::memcmp(a.imag(), b.imag(), a.size() * sizeof(double)) == 0));
+    }
+}
+
+#endif // TEST_SIMD_TEST_UTILITIES_HPP
@@ -0,0 +1,122 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "packed_bits.hpp"
+#include "psk.hpp"
+#include "simd.hpp"
+#include "split_signal.hpp"
+#include "utilities.hpp"
+
+#include "simd_test_utilities.hpp"
+
+
+TEST_CASE("split I/Q buffers convert both ways") {
+    const simd_test::isa_guard guard{};
+    for (const std::size_t n : {0, 1, 5, 8, 17, 1000}) {
+        comm::random_stream gen{9, n};
+        const auto signal = comm::generate_awgn_noise(n, 0.0, gen);
+        for (const auto isa : simd_test::supported_isa_list()) {
+            CAPTURE(comm::to_string(isa));
+            CAPTURE(n);
+            comm::set_simd_isa(isa);
+            const comm::split_signal_t split{signal};
+            CHECK(reinterpret_cast<std::uintptr_t>(split.real()) % 64 == 0);
+            CHECK(reinterpret_cast<std::uintptr_t>(split.imag()) % 64 == 0);
+            for (std::size_t i = 0; i < n; ++i) {
+                CHECK(split[i] == signal[i]);
+            }
+            CHECK(split.interleave() == signal);
+        }
+    }
+}
+
+TEST_CASE("split I/Q PSK matches the interleaved PSK") {
+    const simd_test::isa_guard guard{};
+    const auto isa_list = simd_test::supported_isa_list();
+    for (const std::size_t n : {0, 1, 3, 7, 8, 31, 63, 64, 65, 130, 1001}) {
+        comm::random_stream gen{5, n};
+        const auto bits = comm::generate_uniformly_distributed_bits(2 * n, gen);
+        const comm::bit_seq_t bpsk_bits(std::cbegin(bits), std::cbegin(bits) + static_cast<std::ptrdiff_t>(n));
+        const comm::packed_bit_seq_t packed{bits};
+        const comm::packed_bit_seq_t bpsk_packed{bpsk_bits};
+
+        // noisy symbols with zeros and NaNs on the decision boundaries
+        auto received = comm::generate_awgn_noise(n, 0.0, gen);
+        for (std::size_t i = 0; i < n; i += 7) {
+            received[i] = {0.0, -0.0};
+        }
+        for (std::size_t i = 3; i < n; i += 11) {
+            received[i] = {-0.0, std::nan("")};
+        }
+        const comm::split_signal_t split_received{received};
+
+        comm::set_simd_isa(comm::simd_isa::scalar);
+        const comm::split_signal_t bpsk_reference{comm::bpsk_modulation(bpsk_bits, 0.3)};
+        const comm::split_signal_t qpsk_reference{comm::qpsk_modulation(bits)};
+        const auto bpsk_demodulated_reference = comm::bpsk_demodulation(received, 0.3);
+        const auto qpsk_demodulated_reference = comm::qpsk_demodulation(received);
+
+        for (const auto isa : isa_list) {
+            CAPTURE(comm::to_string(isa));
+            CAPTURE(n);
+            comm::set_simd_isa(isa);
+
+            comm::split_signal_t symbols{};
+            comm::bpsk_modulation(bpsk_bits, symbols, 0.3);
+            CHECK(simd_test::same_bits(symbols, bpsk_reference));
+            comm::bpsk_modulation(bpsk_packed, symbols, 0.3);
+            CHECK(simd_test::same_bits(symbols, bpsk_reference));
+            comm::qpsk_modulation(bits, symbols);
+            CHECK(simd_test::same_bits(symbols, qpsk_reference));
+            comm::qpsk_modulation(packed, symbols);
+            CHECK(simd_test::same_bits(symbols, qpsk_reference));
+
+            CHECK(comm::bpsk_demodulation(split_received, 0.3) == bpsk_demodulated_reference);
+            CHECK(comm::qpsk_demodulation(split_received) == qpsk_demodulated_reference);
+            comm::packed_bit_seq_t demodulated{};
+            comm::bpsk_demodulation(split_received, demodulated, 0.3);
+            CHECK(demodulated == comm::packed_bit_seq_t{bpsk_demodulated_reference});
+            comm::qpsk_demodulation(split_received, demodulated);
+            CHECK(demodulated == comm::packed_bit_seq_t{qpsk_demodulated_reference});
+        }
+    }
+}
+
+TEST_CASE("split I/Q noise and addition match the interleaved versions") {
+    const simd_test::isa_guard guard{};
+    for (const auto isa : simd_test::supported_isa_list()) {
+        comm::set_simd_isa(isa);
+        // lengths with and without a vector tail, from a stream that is already under way
+        for (const std::size_t length : {0, 1, 7, 1003}) {
+            CAPTURE(comm::to_string(isa));
+            CAPTURE(length);
+            comm::random_stream interleaved_gen{11, 3};
+            comm::random_stream split_gen{11, 3};
+            comm::generate_awgn_noise(3, 0.0, interleaved_gen);
+            comm::generate_awgn_noise(3, 0.0, split_gen);
+            const auto noise = comm::generate_awgn_noise(length, 3.0, interleaved_gen);
+            comm::split_signal_t split_noise(length);
+            comm::generate_awgn_noise(split_noise, 3.0, split_gen);
+            CHECK(split_noise == comm::split_signal_t{noise});
+            CHECK(split_gen.position() == interleaved_gen.position());
+        }
+    }
+
+    constexpr std::size_t n = 1500;
+    comm::random_stream interleaved_gen{11, 2};
+    comm::random_stream split_gen{11, 2};
+    const auto noise = comm::generate_awgn_noise(n, 3.0, interleaved_gen);
+    comm::split_signal_t split_noise(n);
+    comm::generate_awgn_noise(split_noise, 3.0, split_gen);
+    CHECK(split_noise == comm::split_signal_t{noise});
+    CHECK(split_gen.position() == interleaved_gen.position());
+
+    const auto symbols = comm::bpsk_modulation(comm::generate_uniformly_distributed_bits(n, split_gen));
+    comm::split_signal_t received{symbols};
+    comm::add_in_place(split_noise, received);
+    CHECK(received.interleave() == comm::add(symbols, noise));
+    CHECK(comm::add(comm::split_signal_t{symbols}, split_noise) == received);
+}
@@ -0,0 +1,63 @@
+
+#include "doctest.h"
+
+#include <cmath>
+
+#include "ber.hpp"
+#include "pipeline.hpp"
+#include "statistics.hpp"
+
+
+TEST_CASE("binomial confidence intervals") {
+    CHECK(comm::normal_quantile(0.975) == doctest::Approx(1.959963984540054).epsilon(1e-12));
+    CHECK(comm::incomplete_beta(2, 3, 0.4) == doctest::Approx(0.5248).epsilon(1e-12));
+
+    // Reference values of R's binom.test and prop.test(correct = FALSE)
+    const auto exact = comm::clopper_pearson_interval(10, 100);
+    CHECK(exact.lower == doctest::Approx(0.04900469).epsilon(1e-6));
+    CHECK(exact.upper == doctest::Approx(0.17622260).epsilon(1e-6));
+    const auto wilson = comm::wilson_interval(10, 100);
+    CHECK(wilson.lower == doctest::Approx(0.05522914).epsilon(1e-6));
+    CHECK(wilson.upper == doctest::Approx(0.17436566).epsilon(1e-6));
+
+    // No errors still bounds the BER: rule of three
+    const auto none = comm::clopper_pearson_interval(0, 1'000'000);
+    CHECK(none.lower == 0.0);
+    CHECK(none.upper == doctest::Approx(3.688879e-06).epsilon(1e-5));
+    CHECK(comm::clopper_pearson_interval(5, 5).upper == 1.0);
+}
+
+TEST_CASE("adaptive BER spends bits where errors are rare") {
+    const std::vector<double> snr_list{0, 6};
+    comm::adaptive_ber_config config{};
+    config.target_errors = 200;
+    config.max_bits = 20'000'000;
+    config.bits_per_trial = 8'192;
+    config.seed = 3;
+
+    const auto trial = [](const double snr, const std::size_t num_of_bits, comm::ber_generator_t& generator) {
+        comm::ber_pipeline<comm::bpsk_modem> pipeline{};
+        return pipeline.run(num_of_bits, snr, generator);
+    };
+    comm::thread_pool serial{1};
+    comm::thread_pool parallel{3};
+    const auto points = comm::simulate_ber_adaptive(parallel, snr_list, config, trial);
+    const auto serial_points = comm::simulate_ber_adaptive(serial, snr_list, config, trial);
+
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        CHECK(points[i].num_of_errors >= config.target_errors);
+        CHECK(points[i].num_of_bits < config.max_bits);
+        CHECK(points[i].num_of_bits == serial_points[i].num_of_bits);
+        CHECK(points[i].num_of_errors == serial_points[i].num_of_errors);
+        const double theory = 0.5 * std::erfc(std::sqrt(std::pow(10, snr_list[i] / 10)));
+        const auto interval = points[i].clopper_pearson(0.999);
+        CHECK(interval.lower < theory);
+        CHECK(theory < interval.upper);
+    }
+    CHECK(points[1].num_of_bits > 10 * points[0].num_of_bits);
+
+    // The bit cap wins over the error target
+    config.max_bits = 100'000;
+    const auto capped = comm::simulate_ber_adaptive(parallel, {12.0}, config, trial);
+    CHECK(capped[0].num_of_bits == config.max_bits);
+}
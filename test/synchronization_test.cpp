@@ -0,0 +1,196 @@
+#include "doctest.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "channel.hpp"
+#include "fir.hpp"
+#include "psk.hpp"
+#include "pulse_shaping.hpp"
+#include "synchronization.hpp"
+#include "utilities.hpp"
+
+
+namespace {
+    template<typename Process>
+    void in_chunks(const std::size_t n, Process process) {
+        for (std::size_t done = 0, chunk = 1; done < n; done += chunk, chunk = chunk * 7 % 1999 + 1) {
+            chunk = std::min(chunk, n - done);
+            process(done, chunk);
+        }
+    }
+
+    // The largest distance of the symbols from the reference after skip, under the best of order rotations
+    double rotated_error(const comm::complex_signal_seq_t& symbols, const comm::complex_signal_seq_t& reference, const std::size_t order, const std::size_t skip) {
+        double best = 1e300;
+        for (std::size_t k = 0; k < order; ++k) {
+            const auto rotation = std::polar(1.0, 2 * 3.14159265358979323846 * static_cast<double>(k) / static_cast<double>(order));
+            double error = 0.0;
+            for (std::size_t i = skip; i < symbols.size(); ++i) {
+                error = std::max(error, std::abs(symbols[i] * rotation - reference[i]));
+            }
+            best = std::min(best, error);
+        }
+        return best;
+    }
+
+    constexpr double timing_rolloff = 0.35;
+    constexpr std::size_t timing_span = 10;
+    constexpr std::size_t timing_samples_per_symbol = 4;
+
+    // The symbols through the RRC filters, shaped at five times the rate and taken from the third sample: 0.15 symbols late
+    comm::complex_signal_seq_t matched_filter_output(const comm::complex_signal_seq_t& symbols) {
+        constexpr std::size_t oversampling = 5;
+        constexpr std::size_t delay = 3;
+        comm::pulse_shaper shaper{timing_rolloff, timing_samples_per_symbol * oversampling, timing_span};
+        comm::complex_signal_seq_t fine(symbols.size() * timing_samples_per_symbol * oversampling);
+        shaper.process(symbols.data(), symbols.size(), fine.data());
+        comm::complex_signal_seq_t samples{};
+        for (std::size_t i = delay; i < fine.size(); i += oversampling) {
+            samples.push_back(fine[i] * std::sqrt(static_cast<double>(oversampling)));
+        }
+        const auto taps = comm::rrc_taps(timing_rolloff, timing_samples_per_symbol, timing_span);
+        comm::overlap_save_filter filter{std::vector<comm::complex_signal_t>(std::cbegin(taps), std::cend(taps))};
+        filter.process(samples.data(), samples.size());
+        return samples;
+    }
+
+    // The largest distance of the strobes from the symbols once settled, at the best lag; they lag by about the filters' span
+    double strobe_error(const comm::complex_signal_seq_t& strobes, const comm::complex_signal_seq_t& symbols) {
+        double best = 1e300;
+        for (std::size_t lag = 0; lag <= timing_span + 4; ++lag) {
+            double error = 0.0;
+            for (std::size_t i = 2000; i + timing_span + 4 < strobes.size(); ++i) {
+                error = std::max(error, std::abs(strobes[i + lag] - symbols[i]));
+            }
+            best = std::min(best, error);
+        }
+        return best;
+    }
+}
+
+TEST_CASE("coarse CFO estimation finds the offset through the modulation, in chunks as at once") {
+    constexpr std::size_t n = 1 << 15;
+    for (const std::size_t order : {2, 4}) {
+        for (const double offset : {0.0123, -0.031}) {
+            CAPTURE(order);
+            CAPTURE(offset);
+            comm::random_stream gen{71, 0};
+            const auto bits = comm::generate_uniformly_distributed_bits(n * (order / 2), gen);
+            auto samples = (order == 2) ? comm::bpsk_modulation(bits) : comm::qpsk_modulation(bits);
+            comm::cfo_stage{offset, 0.4}.process(samples.data(), n, gen);
+            const auto noise = comm::generate_awgn_noise(n, 10.0, gen);
+            comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(samples));
+
+            comm::coarse_cfo_estimator whole{order, 1024};
+            CHECK(whole.estimate() == 0.0);
+            whole.process(samples.data(), n);
+            CHECK(whole.num_of_blocks() == n / 1024);
+            CHECK(whole.estimate() == doctest::Approx(offset).epsilon(0.005));
+
+            comm::coarse_cfo_estimator chunked{order, 1024};
+            in_chunks(n, [&](const std::size_t done, const std::size_t chunk) { chunked.process(samples.data() + done, chunk); });
+            CHECK(chunked.estimate() == whole.estimate());
+            chunked.reset();
+            CHECK(chunked.num_of_blocks() == 0);
+        }
+    }
+    CHECK_THROWS_AS(comm::coarse_cfo_estimator(4, 2), std::invalid_argument);
+}
+
+TEST_CASE("the Costas loop locks to the carrier up to the constellation's rotations") {
+    constexpr std::size_t n = 20000;
+    constexpr double offset = 0.002;
+    for (const std::size_t order : {2, 4}) {
+        CAPTURE(order);
+        comm::random_stream gen{72, 0};
+        const auto bits = comm::generate_uniformly_distributed_bits(n * (order / 2), gen);
+        const auto symbols = (order == 2) ? comm::bpsk_modulation(bits) : comm::qpsk_modulation(bits);
+        auto received = symbols;
+        comm::cfo_stage{offset, 2.0}.process(received.data(), n, gen);
+        const auto noise = comm::generate_awgn_noise(n, 25.0, gen);
+        comm::add_in_place(std::cbegin(noise), std::cend(noise), std::begin(received));
+
+        auto whole = received;
+        comm::costas_loop loop{order, 0.02};
+        loop.process(whole.data(), n);
+        CHECK(loop.frequency() == doctest::Approx(offset).epsilon(0.1));
+        // the noise alone at 25 dB
+        CHECK(rotated_error(whole, symbols, order, 2000) < 0.3);
+
+        auto chunked = received;
+        comm::costas_loop chunked_loop{order, 0.02};
+        in_chunks(n, [&](const std::size_t done, const std::size_t chunk) { chunked_loop.process(chunked.data() + done, chunk); });
+        CHECK(chunked == whole);
+
+        // a coarse estimate to start from leaves only the phase to find
+        chunked_loop.reset();
+        auto started = received;
+        comm::costas_loop started_loop{order, 0.02, offset};
+        started_loop.process(started.data(), 200);
+        CHECK(rotated_error(comm::complex_signal_seq_t(started.cbegin(), started.cbegin() + 200), symbols, order, 100) < 0.3);
+    }
+    CHECK_THROWS_AS(comm::costas_loop(8, 0.01), std::invalid_argument);
+}
+
+TEST_CASE("timing recovery strobes the matched filter output at the symbols, with either detector") {
+    constexpr std::size_t n = 6000;
+    comm::random_stream gen{73, 0};
+    const auto symbols = comm::qpsk_modulation(comm::generate_uniformly_distributed_bits(2 * n, gen));
+    const auto samples = matched_filter_output(symbols);
+
+    for (const auto detector : {comm::timing_detector::gardner, comm::timing_detector::mueller_muller}) {
+        CAPTURE(static_cast<int>(detector));
+        comm::timing_recovery whole{timing_samples_per_symbol, detector};
+        comm::complex_signal_seq_t strobes(n + 1);
+        strobes.resize(whole.process(samples.data(), samples.size(), strobes.data()));
+        CHECK(strobes.size() == doctest::Approx(n).epsilon(0.01));
+        CHECK(whole.period() == doctest::Approx(timing_samples_per_symbol).epsilon(0.01));
+        // intersymbol interference of the truncated pulses and the interpolation
+        CHECK(strobe_error(strobes, symbols) < 0.1);
+
+        comm::timing_recovery chunked{timing_samples_per_symbol, detector};
+        comm::complex_signal_seq_t chunked_strobes(n + 1);
+        std::size_t num_of_strobes = 0;
+        in_chunks(samples.size(), [&](const std::size_t done, const std::size_t chunk) {
+            num_of_strobes += chunked.process(samples.data() + done, chunk, chunked_strobes.data() + num_of_strobes);
+        });
+        REQUIRE(num_of_strobes == strobes.size());
+        double difference = 0.0;
+        for (std::size_t i = 0; i < num_of_strobes; ++i) {
+            difference = std::max(difference, std::abs(chunked_strobes[i] - strobes[i]));
+        }
+        CHECK(difference < 1e-9);
+    }
+    CHECK_THROWS_AS(comm::timing_recovery(1.5), std::invalid_argument);
+}
+
+TEST_CASE("timing recovery holds its loop at any signal level") {
+    constexpr std::size_t n = 6000;
+    comm::random_stream gen{74, 0};
+    const auto symbols = comm::qpsk_modulation(comm::generate_uniformly_distributed_bits(2 * n, gen));
+    const auto samples = matched_filter_output(symbols);
+    // above and below unit power, and at int16 full scale
+    for (const double amplitude : {10.0, 0.01, 23170.0}) {
+        CAPTURE(amplitude);
+        auto scaled = samples;
+        for (auto& x : scaled) {
+            x *= amplitude;
+        }
+        auto reference = symbols;
+        for (auto& x : reference) {
+            x *= amplitude;
+        }
+        for (const auto detector : {comm::timing_detector::gardner, comm::timing_detector::mueller_muller}) {
+            CAPTURE(static_cast<int>(detector));
+            comm::timing_recovery recovery{timing_samples_per_symbol, detector};
+            comm::complex_signal_seq_t strobes(n + 1);
+            strobes.resize(recovery.process(scaled.data(), scaled.size(), strobes.data()));
+            CHECK(strobes.size() == doctest::Approx(n).epsilon(0.01));
+            CHECK(recovery.period() == doctest::Approx(timing_samples_per_symbol).epsilon(0.01));
+            CHECK(strobe_error(strobes, reference) < 0.1 * amplitude);
+        }
+    }
+}
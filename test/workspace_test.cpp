@@ -0,0 +1,136 @@
+#include "doctest.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "constellation.hpp"
+#include "importance_sampling.hpp"
+#include "pipeline.hpp"
+#include "sample.hpp"
+#include "workspace.hpp"
+
+
+// Counting global allocator: every heap allocation of the test program goes through here.
+namespace {
+    std::atomic<std::size_t> num_of_allocations{0};
+
+    void* counted_allocation(const std::size_t size, const std::size_t alignment) {
+        ++num_of_allocations;
+        const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        void* p = (alignment <= alignof(std::max_align_t)) ? std::malloc(rounded) : std::aligned_alloc(alignment, rounded);
+        if (p == nullptr) {
+            throw std::bad_alloc{};
+        }
+        return p;
+    }
+}
+
+void* operator new(const std::size_t size) {
+    return counted_allocation(size, alignof(std::max_align_t));
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return counted_allocation(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+TEST_CASE("workspace hands out aligned buffers in stack order and settles in one block") {
+    comm::workspace buffers{};
+    for (int round = 0; round < 3; ++round) {
+        CAPTURE(round);
+        {
+            const comm::workspace::scope outer{buffers};
+            auto* bytes = buffers.allocate<uint8_t>(3);
+            auto* words = buffers.allocate<uint64_t>(1000);
+            CHECK(reinterpret_cast<std::uintptr_t>(bytes) % comm::workspace::alignment == 0);
+            CHECK(reinterpret_cast<std::uintptr_t>(words) % comm::workspace::alignment == 0);
+            {
+                const comm::workspace::scope inner{buffers};
+                auto* samples = buffers.allocate<comm::complex_signal_t>(5000);
+                CHECK(reinterpret_cast<std::uintptr_t>(samples) % comm::workspace::alignment == 0);
+                samples[4999] = {1.0, 2.0};
+            }
+            const auto mark = buffers.mark();
+            auto* first = buffers.allocate<uint64_t>(1);
+            buffers.release(mark);
+            CHECK(buffers.allocate<uint64_t>(1) == first);
+        }
+        CHECK(buffers.used() == 0);
+        CHECK(buffers.peak() >= 8000 + 80000);
+        // the first round overflows into more blocks, which are then merged
+        if (round > 0) {
+            CHECK(buffers.num_of_blocks() == 1);
+        }
+    }
+}
+
+TEST_CASE("simulation trials allocate nothing once warm") {
+    const auto before_vector = num_of_allocations.load();
+    const std::vector<int> probe(10);
+    CHECK(num_of_allocations.load() == before_vector + 1);
+
+    comm::random_stream stream{1, 2};
+    const std::vector<double> snr_list{2.0, 4.0, 6.0};
+    const auto trials = [&stream, &snr_list]() {
+        std::size_t errors{0};
+        {
+            // the sweep writes into the caller's counts
+            comm::ber_pipeline<comm::bpsk_modem> sweep{};
+            std::array<std::size_t, 3> sweep_errors{};
+            sweep.run(10'048, snr_list, stream, sweep_errors.data());
+            errors += sweep_errors[0] + sweep_errors[1] + sweep_errors[2];
+        }
+        {
+            comm::ber_pipeline<comm::bpsk_modem> bpsk{};
+            errors += bpsk.run(10'000, 4.0, stream);
+        }
+        {
+            comm::ber_pipeline<comm::qpsk_modem, comm::complex_int16_t> qpsk{};
+            comm::importance_sampling_pipeline<comm::qpsk_modem> importance{};
+            errors += qpsk.run(10'000, 4.0, stream);
+            errors += importance.run(10'000, 9.0, stream).num_of_errors;
+        }
+        {
+            comm::coded_ber_pipeline<comm::bpsk_modem> bpsk{comm::code_rate::rate_1_2};
+            comm::coded_ber_pipeline<comm::qpsk_modem> qpsk{comm::code_rate::rate_3_4};
+            errors += bpsk.run(10'000, 2.0, stream);
+            errors += qpsk.run(10'000, 3.0, stream);
+        }
+        {
+            // soft demodulation of a constellation in blocks on the stack
+            comm::coded_ber_pipeline<comm::constellation_modem<comm::qam_constellation<16>>> qam{comm::code_rate::rate_1_2};
+            errors += qam.run(10'000, 3.0, stream);
+        }
+        return errors;
+    };
+    // the first trials grow the thread's workspace
+    trials();
+    trials();
+
+    const auto before = num_of_allocations.load();
+    std::size_t errors{0};
+    for (int i = 0; i < 50; ++i) {
+        errors += trials();
+    }
+    CHECK(num_of_allocations.load() == before);
+    CHECK(errors > 0);
+}